@@ -0,0 +1,227 @@
+#include "AssetCooker.hpp"
+#include "Cookers.hpp"
+#include "SimpleEngineCore/Jobs/JobSystem.hpp"
+#include "SimpleEngineCore/Resources/FileUtils.hpp"
+#include "SimpleEngineCore/Resources/Hash.hpp"
+#include "SimpleEngineCore/Resources/MappedFile.hpp"
+#include "SimpleEngineCore/Resources/PackArchive.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace SimpleEngine {
+
+	namespace {
+
+		struct CookJob {
+			std::filesystem::path source;
+			std::filesystem::path destination;
+			std::string manifest_key; // source path relative to the source directory, '/' separated
+			const Cooker* cooker = nullptr;
+
+			uint64_t hash = 0;
+			enum class EResult { Cooked, Skipped, Failed } result = EResult::Failed;
+		};
+
+		// content of the source and the cooker version, so a new cooker recooks its assets
+		bool hash_source(const CookJob& job, uint64_t& hash) {
+			hash = hash_fnv1a(&job.cooker->version, sizeof(job.cooker->version));
+			hash = hash_fnv1a(job.cooker->cooked_extension, std::char_traits<char>::length(job.cooker->cooked_extension), hash);
+
+			std::error_code error;
+			if (std::filesystem::file_size(job.source, error) == 0)
+				return !error;
+
+			MappedFile file;
+			if (!file.open(job.source.string()))
+				return false;
+			hash = hash_fnv1a(file.get_data(), file.get_size(), hash);
+			return true;
+		}
+
+		std::unordered_map<std::string, uint64_t> read_manifest(const std::filesystem::path& path) {
+			std::unordered_map<std::string, uint64_t> manifest;
+			std::ifstream file(path);
+			std::string line;
+			while (std::getline(file, line)) {
+				// "<16 hex digits> <relative path>"
+				if (line.size() < 18 || line[16] != ' ')
+					continue;
+				uint64_t hash = 0;
+				if (std::sscanf(line.c_str(), "%16" SCNx64, &hash) != 1)
+					continue;
+				manifest[line.substr(17)] = hash;
+			}
+			return manifest;
+		}
+
+		bool write_manifest(const std::filesystem::path& path, const std::vector<CookJob>& jobs) {
+			return write_file_atomically(path, [&jobs](std::ostream& file) {
+				char hash[17];
+				for (const CookJob& job : jobs) {
+					// failed assets are left out, so they are retried next time
+					if (job.result == CookJob::EResult::Failed)
+						continue;
+					std::snprintf(hash, sizeof(hash), "%016" PRIx64, job.hash);
+					file << hash << ' ' << job.manifest_key << '\n';
+				}
+			});
+		}
+
+		// e.g. foo.ppm and foo.pgm both cook to foo.tex, their jobs would race to write it
+		bool find_duplicate_destinations(const std::vector<CookJob>& jobs) {
+			std::unordered_map<std::string, const CookJob*> destinations;
+			bool has_duplicates = false;
+			for (const CookJob& job : jobs) {
+				const auto [it, inserted] = destinations.emplace(job.destination.generic_string(), &job);
+				if (!inserted) {
+					std::cerr << job.manifest_key << " and " << it->second->manifest_key << " both cook to " << it->first << std::endl;
+					has_duplicates = true;
+				}
+			}
+			return has_duplicates;
+		}
+
+		void run_job(CookJob& job, const std::unordered_map<std::string, uint64_t>& manifest, const bool force, std::mutex& output_mutex) {
+			std::string error;
+			if (!hash_source(job, job.hash)) {
+				error = "can't read the file";
+			}
+			else {
+				const auto it = manifest.find(job.manifest_key);
+				if (!force && it != manifest.end() && it->second == job.hash && std::filesystem::exists(job.destination)) {
+					job.result = CookJob::EResult::Skipped;
+					return;
+				}
+
+				std::error_code directory_error;
+				std::filesystem::create_directories(job.destination.parent_path(), directory_error);
+				if (directory_error)
+					error = "can't create the output directory: " + directory_error.message();
+				else if (job.cooker->cook(job.source, job.destination, error))
+					job.result = CookJob::EResult::Cooked;
+			}
+
+			const std::lock_guard<std::mutex> lock(output_mutex);
+			if (job.result == CookJob::EResult::Cooked)
+				std::cout << "cooked  " << job.manifest_key << std::endl;
+			else
+				std::cerr << "FAILED  " << job.manifest_key << ": " << error << std::endl;
+		}
+
+		// every cooked asset, including the ones skipped as up to date, under its path relative to the output
+		bool pack_cooked_assets(const CookSettings& settings, const std::vector<CookJob>& jobs) {
+			std::vector<PackArchiveSource> sources;
+			for (const CookJob& job : jobs) {
+				if (job.result == CookJob::EResult::Failed)
+					continue;
+				PackArchiveSource source;
+				source.path = job.destination.lexically_relative(settings.output_directory).generic_string();
+				source.file_path = job.destination.string();
+				source.compress = settings.compress_archive;
+				sources.push_back(std::move(source));
+			}
+
+			const size_t entries_count = sources.size();
+			if (!PackArchive::write(settings.archive_path.string(), std::move(sources))) {
+				std::cerr << "can't write the archive " << settings.archive_path.string() << std::endl;
+				return false;
+			}
+			std::cout << "packed " << entries_count << " assets into " << settings.archive_path.string() << std::endl;
+			return true;
+		}
+
+	}
+
+	bool AssetCooker::cook(const CookSettings& settings, CookStats& stats) {
+		stats = {};
+
+		std::error_code error;
+		if (!std::filesystem::is_directory(settings.source_directory, error)) {
+			std::cerr << "source directory " << settings.source_directory.string() << " does not exist" << std::endl;
+			return false;
+		}
+
+		std::vector<CookJob> jobs;
+		for (const auto& entry : std::filesystem::recursive_directory_iterator(settings.source_directory, error)) {
+			if (!entry.is_regular_file())
+				continue;
+
+			std::string extension = entry.path().extension().string();
+			std::transform(extension.begin(), extension.end(), extension.begin(), [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+			const Cooker* cooker = find_cooker(extension);
+			if (!cooker)
+				continue;
+
+			const std::filesystem::path relative_path = entry.path().lexically_relative(settings.source_directory);
+			CookJob job;
+			job.source = entry.path();
+			job.destination = settings.output_directory / relative_path;
+			job.destination.replace_extension(cooker->cooked_extension);
+			job.manifest_key = relative_path.generic_string();
+			job.cooker = cooker;
+			jobs.push_back(std::move(job));
+		}
+		// stable manifest order, so it diffs well
+		std::sort(jobs.begin(), jobs.end(), [](const CookJob& a, const CookJob& b) { return a.manifest_key < b.manifest_key; });
+		if (find_duplicate_destinations(jobs))
+			return false;
+
+		const std::filesystem::path manifest_path = settings.output_directory / s_manifest_file_name;
+		const std::unordered_map<std::string, uint64_t> manifest = read_manifest(manifest_path);
+
+		// the largest files tend to be the slowest, so they are started first
+		std::vector<size_t> order(jobs.size());
+		std::vector<uintmax_t> sizes(jobs.size());
+		for (size_t i = 0; i < jobs.size(); ++i) {
+			order[i] = i;
+			sizes[i] = std::filesystem::file_size(jobs[i].source, error);
+		}
+		std::sort(order.begin(), order.end(), [&sizes](const size_t a, const size_t b) { return sizes[a] > sizes[b]; });
+
+		const unsigned int hardware_threads = std::max(std::thread::hardware_concurrency(), 1u);
+		const unsigned int threads_count = static_cast<unsigned int>(std::min<size_t>(
+			settings.jobs_count ? settings.jobs_count : hardware_threads, std::max<size_t>(jobs.size(), 1)));
+
+		// this thread is one of the threads_count
+		const bool owns_job_system = threads_count > 1 && !JobSystem::is_initialized();
+		if (owns_job_system)
+			JobSystem::initialize(threads_count - 1);
+
+		std::mutex output_mutex;
+		JobSystem::parallel_for(order.size(), 1, [&](const size_t first, const size_t last) {
+			for (size_t i = first; i < last; ++i)
+				run_job(jobs[order[i]], manifest, settings.force, output_mutex);
+		});
+
+		if (owns_job_system)
+			JobSystem::shutdown();
+
+		for (const CookJob& job : jobs) {
+			switch (job.result) {
+			case CookJob::EResult::Cooked:	++stats.cooked; break;
+			case CookJob::EResult::Skipped:	++stats.skipped; break;
+			case CookJob::EResult::Failed:	++stats.failed; break;
+			}
+		}
+
+		std::filesystem::create_directories(settings.output_directory, error);
+		if (!write_manifest(manifest_path, jobs)) {
+			std::cerr << "can't write the manifest " << manifest_path.string() << std::endl;
+			return false;
+		}
+		if (!settings.archive_path.empty() && !pack_cooked_assets(settings, jobs))
+			return false;
+		return stats.failed == 0;
+	}
+
+}
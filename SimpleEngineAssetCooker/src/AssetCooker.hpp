@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <filesystem>
+
+namespace SimpleEngine {
+
+	struct CookSettings {
+		std::filesystem::path source_directory;
+		std::filesystem::path output_directory;
+		unsigned int jobs_count = 0; // threads cooking at once, 0 - all hardware threads
+		bool force = false;			 // ignore the manifest and cook everything
+		std::filesystem::path archive_path; // if set, the cooked assets are also packed into this archive
+		bool compress_archive = true;
+	};
+
+	struct CookStats {
+		size_t cooked = 0;
+		size_t skipped = 0;
+		size_t failed = 0;
+	};
+
+	// Cooks every known asset of source_directory into the same relative path of output_directory.
+	// The content hash of each cooked source is kept in a manifest next to the output,
+	// a source whose hash and output are unchanged is skipped.
+	class AssetCooker {
+	public:
+		static constexpr const char* s_manifest_file_name = ".cook_manifest";
+
+		// false if any asset failed
+		static bool cook(const CookSettings& settings, CookStats& stats);
+	};
+
+}
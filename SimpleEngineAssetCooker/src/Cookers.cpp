@@ -0,0 +1,201 @@
+#include "Cookers.hpp"
+#include "SimpleEngineCore/Resources/FileUtils.hpp"
+#include "SimpleEngineCore/Resources/MappedFile.hpp"
+#include "SimpleEngineCore/Resources/MeshFile.hpp"
+#include "SimpleEngineCore/Resources/ObjImporter.hpp"
+#include "SimpleEngineCore/Resources/TextureFile.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <limits>
+
+namespace SimpleEngine {
+
+	// bump a version when its cooker output changes
+	const Cooker s_cookers[] = {
+		{ ".ppm",	".tex",		1, cook_texture },
+		{ ".pgm",	".tex",		1, cook_texture },
+		{ ".obj",	".mesh",	2, cook_mesh },
+		{ ".vert",	".vert",	1, cook_shader },
+		{ ".frag",	".frag",	1, cook_shader },
+		{ ".glsl",	".glsl",	1, cook_shader }
+	};
+
+	const Cooker* find_cooker(const std::string& extension) {
+		for (const Cooker& cooker : s_cookers) {
+			if (extension == cooker.source_extension)
+				return &cooker;
+		}
+		return nullptr;
+	}
+
+	namespace {
+
+		// netpbm header field, skipping whitespace and comments
+		bool read_netpbm_value(const unsigned char*& cursor, const unsigned char* end, unsigned int& value) {
+			while (cursor < end && (std::isspace(*cursor) || *cursor == '#')) {
+				if (*cursor == '#') {
+					while (cursor < end && *cursor != '\n')
+						++cursor;
+				}
+				else {
+					++cursor;
+				}
+			}
+			if (cursor == end || !std::isdigit(*cursor))
+				return false;
+			value = 0;
+			while (cursor < end && std::isdigit(*cursor)) {
+				const unsigned int digit = *cursor++ - '0';
+				if (value > (std::numeric_limits<unsigned int>::max() - digit) / 10)
+					return false;
+				value = value * 10 + digit;
+			}
+			return true;
+		}
+
+		// 2x2 box filter, the last row/column is repeated for odd sizes
+		std::vector<unsigned char> downsample(const std::vector<unsigned char>& source, const unsigned int width, const unsigned int height,
+											  const unsigned int channels) {
+			const unsigned int level_width = std::max(width / 2, 1u);
+			const unsigned int level_height = std::max(height / 2, 1u);
+			std::vector<unsigned char> level(static_cast<size_t>(level_width) * level_height * channels);
+			for (unsigned int y = 0; y < level_height; ++y) {
+				const unsigned int y0 = std::min(y * 2, height - 1);
+				const unsigned int y1 = std::min(y * 2 + 1, height - 1);
+				for (unsigned int x = 0; x < level_width; ++x) {
+					const unsigned int x0 = std::min(x * 2, width - 1);
+					const unsigned int x1 = std::min(x * 2 + 1, width - 1);
+					for (unsigned int c = 0; c < channels; ++c) {
+						const unsigned int sum = source[(static_cast<size_t>(y0) * width + x0) * channels + c]
+							+ source[(static_cast<size_t>(y0) * width + x1) * channels + c]
+							+ source[(static_cast<size_t>(y1) * width + x0) * channels + c]
+							+ source[(static_cast<size_t>(y1) * width + x1) * channels + c];
+						level[(static_cast<size_t>(y) * level_width + x) * channels + c] = static_cast<unsigned char>((sum + 2) / 4);
+					}
+				}
+			}
+			return level;
+		}
+
+	}
+
+	bool cook_texture(const std::filesystem::path& source, const std::filesystem::path& destination, std::string& error) {
+		MappedFile file;
+		if (!file.open(source.string())) {
+			error = "can't read the file";
+			return false;
+		}
+
+		const unsigned char* cursor = file.get_data();
+		const unsigned char* end = cursor + file.get_size();
+		if (file.get_size() < 2 || cursor[0] != 'P' || (cursor[1] != '6' && cursor[1] != '5')) {
+			error = "only binary PPM (P6) and PGM (P5) images are supported";
+			return false;
+		}
+		const bool is_gray = cursor[1] == '5';
+		cursor += 2;
+
+		unsigned int width = 0;
+		unsigned int height = 0;
+		unsigned int max_value = 0;
+		if (!read_netpbm_value(cursor, end, width) || !read_netpbm_value(cursor, end, height)
+			|| !read_netpbm_value(cursor, end, max_value) || cursor == end) {
+			error = "broken header";
+			return false;
+		}
+		// exactly one whitespace separates the header from the pixels
+		++cursor;
+
+		if (width == 0 || height == 0 || width > s_texture_max_size || height > s_texture_max_size) {
+			error = "the image is " + std::to_string(width) + "x" + std::to_string(height)
+				+ ", textures are at most " + std::to_string(s_texture_max_size) + " texels wide and high";
+			return false;
+		}
+		if (max_value == 0 || max_value > 255) {
+			error = "only 8-bit images are supported";
+			return false;
+		}
+		const unsigned int source_channels = is_gray ? 1 : 3;
+		const size_t pixels_count = static_cast<size_t>(width) * height;
+		if (static_cast<size_t>(end - cursor) < pixels_count * source_channels) {
+			error = "pixel data is truncated";
+			return false;
+		}
+
+		// RGB is expanded to RGBA: 3-byte texels are converted by the driver on every upload
+		TextureData texture;
+		texture.width = width;
+		texture.height = height;
+		texture.format = is_gray ? ETextureFormat::R8 : ETextureFormat::RGBA8;
+		const unsigned int channels = is_gray ? 1 : 4;
+
+		std::vector<unsigned char> base(pixels_count * channels);
+		for (size_t i = 0; i < pixels_count; ++i) {
+			for (unsigned int c = 0; c < source_channels; ++c)
+				base[i * channels + c] = static_cast<unsigned char>(cursor[i * source_channels + c] * 255u / max_value);
+			if (!is_gray)
+				base[i * channels + 3] = 255;
+		}
+
+		const unsigned int mip_levels = std::min<unsigned int>(calculate_mip_levels(width, height), static_cast<unsigned int>(s_texture_max_mip_levels));
+		texture.levels.push_back(std::move(base));
+		for (unsigned int level = 1; level < mip_levels; ++level) {
+			const unsigned int level_width = std::max(width >> (level - 1), 1u);
+			const unsigned int level_height = std::max(height >> (level - 1), 1u);
+			texture.levels.push_back(downsample(texture.levels.back(), level_width, level_height, channels));
+		}
+
+		if (!TextureFile::write(destination.string(), texture)) {
+			error = "can't write the texture";
+			return false;
+		}
+		return true;
+	}
+
+	bool cook_mesh(const std::filesystem::path& source, const std::filesystem::path& destination, std::string& error) {
+		MeshData mesh;
+		if (!ObjImporter::import(source.string(), mesh)) {
+			error = "no triangles imported";
+			return false;
+		}
+		if (!MeshFile::write(destination.string(), mesh)) {
+			error = "can't write the mesh";
+			return false;
+		}
+		return true;
+	}
+
+	bool cook_shader(const std::filesystem::path& source, const std::filesystem::path& destination, std::string& error) {
+		std::ifstream input(source, std::ios::binary);
+		if (!input) {
+			error = "can't read the file";
+			return false;
+		}
+
+		std::string cooked;
+		std::string line;
+		bool has_version = false;
+		while (std::getline(input, line)) {
+			while (!line.empty() && std::isspace(static_cast<unsigned char>(line.back())))
+				line.pop_back();
+			const size_t first = line.find_first_not_of(" \t");
+			if (first != std::string::npos && line.compare(first, 8, "#version") == 0)
+				has_version = true;
+			cooked += line;
+			cooked += '\n';
+		}
+		if (!has_version) {
+			error = "#version directive is missing";
+			return false;
+		}
+
+		if (!write_file_atomically(destination, [&cooked](std::ostream& file) { file.write(cooked.data(), cooked.size()); })) {
+			error = "can't write the shader";
+			return false;
+		}
+		return true;
+	}
+
+}
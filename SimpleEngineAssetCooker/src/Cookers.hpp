@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace SimpleEngine {
+
+	// converts one source file into its runtime format, error is set on failure
+	using CookFunction = bool(*)(const std::filesystem::path& source, const std::filesystem::path& destination, std::string& error);
+
+	struct Cooker {
+		const char* source_extension;	// lower case, with the dot
+		const char* cooked_extension;
+		uint32_t version;				// part of the content hash: bumping it recooks every asset of the type
+		CookFunction cook;
+	};
+
+	// nullptr if the extension is not an asset
+	const Cooker* find_cooker(const std::string& extension);
+
+	// binary PPM (P6) to RGBA8, binary PGM (P5) to R8, full mip chain
+	bool cook_texture(const std::filesystem::path& source, const std::filesystem::path& destination, std::string& error);
+	// OBJ to .mesh: deduplicated, optimized, with LODs
+	bool cook_mesh(const std::filesystem::path& source, const std::filesystem::path& destination, std::string& error);
+	// GLSL: checked for #version, line endings normalized and trailing spaces removed.
+	// Program binaries depend on the driver, they are cached at runtime by ShaderCache
+	bool cook_shader(const std::filesystem::path& source, const std::filesystem::path& destination, std::string& error);
+
+}
@@ -0,0 +1,45 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include "AssetCooker.hpp"
+
+
+void print_usage() {
+	std::cerr << "usage: SimpleEngineAssetCooker <source directory> <output directory> [--force] [--jobs N] [--pack <archive> [--store]]" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	SimpleEngine::CookSettings settings;
+	int positional_count = 0;
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--force") == 0) {
+			settings.force = true;
+		}
+		else if (std::strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+			settings.jobs_count = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else if (std::strcmp(argv[i], "--pack") == 0 && i + 1 < argc) {
+			settings.archive_path = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--store") == 0) {
+			settings.compress_archive = false;
+		}
+		else if (argv[i][0] != '-' && positional_count < 2) {
+			(positional_count++ == 0 ? settings.source_directory : settings.output_directory) = argv[i];
+		}
+		else {
+			print_usage();
+			return 2;
+		}
+	}
+	if (positional_count != 2) {
+		print_usage();
+		return 2;
+	}
+
+	SimpleEngine::CookStats stats;
+	const bool succeeded = SimpleEngine::AssetCooker::cook(settings, stats);
+	std::cout << stats.cooked << " cooked, " << stats.skipped << " up to date, " << stats.failed << " failed" << std::endl;
+	return succeeded ? 0 : 1;
+}
@@ -0,0 +1,321 @@
+#include "MathBenchmark.hpp"
+#include "SimpleEngineCore/Camera.hpp"
+#include "SimpleEngineCore/Math/MathKernels.hpp"
+#include "SimpleEngineCore/Rendering/FrustumCulling.hpp"
+
+#include "glm/mat3x3.hpp"
+#include "glm/mat4x4.hpp"
+#include "glm/common.hpp"
+#include "glm/geometric.hpp"
+#include "glm/trigonometric.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#include "glm/gtc/quaternion.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace SimpleEngine {
+
+	namespace {
+
+		// results further apart than this, relative to the glm ones, fail the run
+		constexpr float s_max_allowed_difference = 1e-3f;
+
+		struct KernelBenchmark {
+			const char* name;
+			std::function<void()> run_glm;
+			std::function<void()> run_kernels;
+			// largest difference of the last kernel results from the glm ones
+			std::function<float()> compare;
+		};
+
+		// the fastest of the repetitions, per element
+		double measure_nanoseconds(const MathBenchmarkSettings& settings, const std::function<void()>& function) {
+			double best = std::numeric_limits<double>::max();
+			for (unsigned int repetition = 0; repetition < settings.repetitions; ++repetition) {
+				const auto start = std::chrono::steady_clock::now();
+				function();
+				best = std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+			}
+			return best / static_cast<double>(settings.count);
+		}
+
+		float max_relative_difference(const float* values, const float* expected, const size_t count) {
+			float difference = 0.f;
+			for (size_t i = 0; i < count; ++i)
+				difference = std::max(difference, std::abs(values[i] - expected[i]) / std::max(1.f, std::abs(expected[i])));
+			return difference;
+		}
+
+		template<typename T>
+		float max_relative_difference(const std::vector<T>& values, const std::vector<T>& expected) {
+			constexpr size_t floats_count = sizeof(T) / sizeof(float);
+			return max_relative_difference(reinterpret_cast<const float*>(values.data()), reinterpret_cast<const float*>(expected.data()),
+				values.size() * floats_count);
+		}
+
+		// Camera::update_view_matrix as it was: three Euler matrices, their product and lookAt
+		glm::mat4 glm_view_matrix(const glm::vec3& position, const glm::vec3& rotation) {
+			const float roll_in_radians  = glm::radians(rotation.x);
+			const float pitch_in_radians = glm::radians(rotation.y);
+			const float yaw_in_radians   = glm::radians(rotation.z);
+
+			const glm::mat3 rotate_matrix_x(1, 0, 0,
+				0, cos(roll_in_radians), sin(roll_in_radians),
+				0, -sin(roll_in_radians), cos(roll_in_radians));
+			const glm::mat3 rotate_matrix_y(cos(pitch_in_radians), 0, -sin(pitch_in_radians),
+				0, 1, 0,
+				sin(pitch_in_radians), 0, cos(pitch_in_radians));
+			const glm::mat3 rotate_matrix_z(cos(yaw_in_radians), sin(yaw_in_radians), 0,
+				-sin(yaw_in_radians), cos(yaw_in_radians), 0,
+				0, 0, 1);
+			const glm::mat3 euler_rotate_matrix = rotate_matrix_z * rotate_matrix_y * rotate_matrix_x;
+
+			const glm::vec3 direction = glm::normalize(euler_rotate_matrix * glm::vec3(1.f, 0.f, 0.f));
+			const glm::vec3 right = glm::normalize(euler_rotate_matrix * glm::vec3(0.f, -1.f, 0.f));
+			const glm::vec3 up = glm::cross(right, direction);
+			return glm::lookAt(position, position + direction, up);
+		}
+
+	}
+
+	bool MathBenchmark::run(const MathBenchmarkSettings& settings) {
+		const size_t count = settings.count;
+		std::mt19937 random(42);
+		std::uniform_real_distribution<float> distribution(-1.f, 1.f);
+		const auto next = [&random, &distribution]() { return distribution(random); };
+
+		// inputs
+		std::vector<glm::mat4> left_matrices(count);
+		std::vector<glm::mat4> right_matrices(count);
+		for (size_t i = 0; i < count; ++i) {
+			for (int column = 0; column < 4; ++column) {
+				left_matrices[i][column] = glm::vec4(next(), next(), next(), column == 3 ? 1.f : 0.f);
+				right_matrices[i][column] = glm::vec4(next(), next(), next(), column == 3 ? 1.f : 0.f);
+			}
+		}
+		std::vector<glm::vec4> vectors(count);
+		for (glm::vec4& vector : vectors)
+			vector = glm::vec4(next(), next(), next(), 1.f);
+
+		std::vector<float> transform_values[10];
+		for (std::vector<float>& values : transform_values) {
+			values.resize(count);
+			std::generate(values.begin(), values.end(), next);
+		}
+		for (size_t i = 0; i < count; ++i) {
+			glm::quat rotation(transform_values[6][i], transform_values[3][i], transform_values[4][i], transform_values[5][i]);
+			rotation = glm::normalize(rotation);
+			transform_values[3][i] = rotation.x;
+			transform_values[4][i] = rotation.y;
+			transform_values[5][i] = rotation.z;
+			transform_values[6][i] = rotation.w;
+		}
+		const TransformArrays transforms{
+			transform_values[0].data(), transform_values[1].data(), transform_values[2].data(),
+			transform_values[3].data(), transform_values[4].data(), transform_values[5].data(), transform_values[6].data(),
+			transform_values[7].data(), transform_values[8].data(), transform_values[9].data(),
+		};
+
+		AABBBoundsSoA boxes;
+		SphereBoundsSoA spheres;
+		boxes.reserve(count);
+		spheres.reserve(count);
+		for (size_t i = 0; i < count; ++i) {
+			const glm::vec3 center(next() * 20.f, next() * 20.f, next() * 20.f);
+			const glm::vec3 extent(std::abs(next()) + 0.1f, std::abs(next()) + 0.1f, std::abs(next()) + 0.1f);
+			boxes.push(center - extent, center + extent);
+			spheres.push(center, glm::length(extent));
+		}
+		const AABBArrays box_arrays{
+			boxes.center_x.data(), boxes.center_y.data(), boxes.center_z.data(),
+			boxes.extent_x.data(), boxes.extent_y.data(), boxes.extent_z.data(),
+		};
+		const SphereArrays sphere_arrays{ spheres.center_x.data(), spheres.center_y.data(), spheres.center_z.data(), spheres.radius.data() };
+
+		const glm::mat4 view_projection = glm::perspective(glm::radians(60.f), 16.f / 9.f, 0.1f, 100.f)
+			* glm_view_matrix(glm::vec3(-20.f, 0.f, 0.f), glm::vec3(0.f, 0.f, 0.f));
+		const Frustum frustum = Frustum::from_view_projection(view_projection);
+
+		// outputs
+		std::vector<glm::mat4> glm_matrices(count);
+		std::vector<glm::mat4> kernel_matrices(count);
+		std::vector<glm::vec4> glm_vectors(count);
+		std::vector<glm::vec4> kernel_vectors(count);
+		std::vector<float> glm_boxes[6];
+		std::vector<float> kernel_boxes[6];
+		for (int array = 0; array < 6; ++array) {
+			glm_boxes[array].resize(count);
+			kernel_boxes[array].resize(count);
+		}
+		const AABBOutputArrays kernel_box_arrays{
+			kernel_boxes[0].data(), kernel_boxes[1].data(), kernel_boxes[2].data(),
+			kernel_boxes[3].data(), kernel_boxes[4].data(), kernel_boxes[5].data(),
+		};
+		std::vector<uint32_t> glm_visible;
+		std::vector<uint32_t> kernel_visible(count);
+		size_t kernel_visible_count = 0;
+
+		const auto compare_visible = [&]() {
+			const bool same = kernel_visible_count == glm_visible.size()
+				&& std::equal(glm_visible.begin(), glm_visible.end(), kernel_visible.begin());
+			return same ? 0.f : 1.f;
+		};
+
+		const std::vector<KernelBenchmark> benchmarks = {
+			{
+				"mat4 * mat4",
+				[&]() {
+					for (size_t i = 0; i < count; ++i)
+						glm_matrices[i] = left_matrices[i] * right_matrices[i];
+				},
+				[&]() { MathKernels::multiply_matrices(left_matrices.data(), right_matrices.data(), kernel_matrices.data(), count); },
+				[&]() { return max_relative_difference(kernel_matrices, glm_matrices); },
+			},
+			{
+				"view projection * model",
+				[&]() {
+					for (size_t i = 0; i < count; ++i)
+						glm_matrices[i] = view_projection * right_matrices[i];
+				},
+				[&]() { MathKernels::multiply_matrices(view_projection, right_matrices.data(), kernel_matrices.data(), count); },
+				[&]() { return max_relative_difference(kernel_matrices, glm_matrices); },
+			},
+			{
+				"mat4 * vec4",
+				[&]() {
+					for (size_t i = 0; i < count; ++i)
+						glm_vectors[i] = view_projection * vectors[i];
+				},
+				[&]() { MathKernels::transform_vectors(view_projection, vectors.data(), kernel_vectors.data(), count); },
+				[&]() { return max_relative_difference(kernel_vectors, glm_vectors); },
+			},
+			{
+				"translation, quat, scale to mat4",
+				[&]() {
+					for (size_t i = 0; i < count; ++i) {
+						const glm::vec3 translation(transforms.translation_x[i], transforms.translation_y[i], transforms.translation_z[i]);
+						const glm::quat rotation(transforms.rotation_w[i], transforms.rotation_x[i], transforms.rotation_y[i], transforms.rotation_z[i]);
+						const glm::vec3 scale(transforms.scale_x[i], transforms.scale_y[i], transforms.scale_z[i]);
+						glm_matrices[i] = glm::translate(glm::mat4(1.f), translation) * glm::mat4_cast(rotation) * glm::scale(glm::mat4(1.f), scale);
+					}
+				},
+				[&]() { MathKernels::compose_transforms(transforms, kernel_matrices.data(), count); },
+				[&]() { return max_relative_difference(kernel_matrices, glm_matrices); },
+			},
+			{
+				"AABB transform",
+				[&]() {
+					for (size_t i = 0; i < count; ++i) {
+						const glm::mat4& matrix = left_matrices[i];
+						const glm::vec3 center(boxes.center_x[i], boxes.center_y[i], boxes.center_z[i]);
+						const glm::vec3 extent(boxes.extent_x[i], boxes.extent_y[i], boxes.extent_z[i]);
+						const glm::vec3 transformed_center = glm::vec3(matrix * glm::vec4(center, 1.f));
+						const glm::vec3 transformed_extent = glm::abs(glm::vec3(matrix[0])) * extent.x
+							+ glm::abs(glm::vec3(matrix[1])) * extent.y + glm::abs(glm::vec3(matrix[2])) * extent.z;
+						for (int axis = 0; axis < 3; ++axis) {
+							glm_boxes[axis][i] = transformed_center[axis];
+							glm_boxes[3 + axis][i] = transformed_extent[axis];
+						}
+					}
+				},
+				[&]() { MathKernels::transform_aabbs(left_matrices.data(), box_arrays, kernel_box_arrays, count); },
+				[&]() {
+					float difference = 0.f;
+					for (int array = 0; array < 6; ++array)
+						difference = std::max(difference, max_relative_difference(kernel_boxes[array], glm_boxes[array]));
+					return difference;
+				},
+			},
+			{
+				"sphere plane tests",
+				[&]() {
+					glm_visible.clear();
+					for (size_t i = 0; i < count; ++i) {
+						if (FrustumCulling::is_sphere_visible(frustum, { spheres.center_x[i], spheres.center_y[i], spheres.center_z[i] }, spheres.radius[i]))
+							glm_visible.push_back(static_cast<uint32_t>(i));
+					}
+				},
+				[&]() { kernel_visible_count = MathKernels::cull_spheres(frustum.planes, Frustum::PlanesCount, sphere_arrays, 0, count, kernel_visible.data()); },
+				compare_visible,
+			},
+			{
+				"AABB plane tests",
+				[&]() {
+					glm_visible.clear();
+					for (size_t i = 0; i < count; ++i) {
+						const glm::vec3 center(boxes.center_x[i], boxes.center_y[i], boxes.center_z[i]);
+						const glm::vec3 extent(boxes.extent_x[i], boxes.extent_y[i], boxes.extent_z[i]);
+						if (FrustumCulling::is_aabb_visible(frustum, center - extent, center + extent))
+							glm_visible.push_back(static_cast<uint32_t>(i));
+					}
+				},
+				[&]() { kernel_visible_count = MathKernels::cull_aabbs(frustum.planes, Frustum::PlanesCount, box_arrays, 0, count, kernel_visible.data()); },
+				compare_visible,
+			},
+		};
+
+		std::vector<EMathKernelSet> kernel_sets;
+		for (const EMathKernelSet kernel_set : { EMathKernelSet::SSE2, EMathKernelSet::AVX2 }) {
+			if (MathKernels::is_supported(kernel_set))
+				kernel_sets.push_back(kernel_set);
+		}
+		const EMathKernelSet selected_kernel_set = MathKernels::get_kernel_set();
+		std::printf("%zu elements, fastest of %u runs, runtime dispatch picked %s\n\n", count, settings.repetitions, MathKernels::get_kernel_set_name());
+
+		std::printf("%-34s %10s", "ns per element", "glm");
+		for (const EMathKernelSet kernel_set : kernel_sets) {
+			MathKernels::set_kernel_set(kernel_set);
+			std::printf(" %10s %8s", MathKernels::get_kernel_set_name(), "speedup");
+		}
+		std::printf(" %12s\n", "difference");
+
+		bool succeeded = true;
+		for (const KernelBenchmark& benchmark : benchmarks) {
+			const double glm_time = measure_nanoseconds(settings, benchmark.run_glm);
+			std::printf("%-34s %10.2f", benchmark.name, glm_time);
+			float difference = 0.f;
+			for (const EMathKernelSet kernel_set : kernel_sets) {
+				MathKernels::set_kernel_set(kernel_set);
+				const double kernel_time = measure_nanoseconds(settings, benchmark.run_kernels);
+				difference = std::max(difference, benchmark.compare());
+				std::printf(" %10.2f %7.2fx", kernel_time, glm_time / kernel_time);
+			}
+			std::printf(" %12.2e\n", difference);
+			succeeded &= difference <= s_max_allowed_difference;
+		}
+		MathKernels::set_kernel_set(selected_kernel_set);
+
+		// the camera is a single matrix, what counts there is the scalar work the closed form saves
+		std::vector<glm::vec3> rotations(count);
+		for (glm::vec3& rotation : rotations)
+			rotation = glm::vec3(next() * 180.f, next() * 90.f, next() * 180.f);
+		const glm::vec3 camera_position(-2.f, 0.5f, 1.f);
+		Camera camera(camera_position);
+		const double glm_camera_time = measure_nanoseconds(settings, [&]() {
+			for (size_t i = 0; i < count; ++i)
+				glm_matrices[i] = glm_view_matrix(camera_position, rotations[i]);
+		});
+		const double camera_time = measure_nanoseconds(settings, [&]() {
+			for (size_t i = 0; i < count; ++i) {
+				camera.set_rotation(rotations[i]);
+				kernel_matrices[i] = camera.get_view_matrix();
+			}
+		});
+		const float camera_difference = max_relative_difference(kernel_matrices, glm_matrices);
+		std::printf("\n%-34s %10.2f %10.2f %7.2fx %12.2e\n", "Camera::update_view_matrix", glm_camera_time, camera_time,
+			glm_camera_time / camera_time, camera_difference);
+		succeeded &= camera_difference <= s_max_allowed_difference;
+
+		if (!succeeded)
+			std::printf("\nresults differ from glm by more than %g\n", s_max_allowed_difference);
+		return succeeded;
+	}
+
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include <cstddef>
+
+namespace SimpleEngine {
+
+	struct MathBenchmarkSettings {
+		size_t count = 64 * 1024; // elements per batch
+		unsigned int repetitions = 30; // the fastest one is reported
+	};
+
+	// Times the glm paths the engine used before the MathKernels against every kernel set the CPU supports
+	// and prints nanoseconds per element and the largest difference from the glm results
+	class MathBenchmark {
+	public:
+		static bool run(const MathBenchmarkSettings& settings);
+	};
+
+}
@@ -0,0 +1,36 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include "MathBenchmark.hpp"
+
+
+namespace {
+
+	void print_usage() {
+		std::cerr << "usage: SimpleEngineBenchmark [--count N] [--repetitions N]" << std::endl;
+	}
+
+}
+
+int main(int argc, char** argv)
+{
+	SimpleEngine::MathBenchmarkSettings settings;
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
+			settings.count = static_cast<size_t>(std::strtoull(argv[++i], nullptr, 10));
+		}
+		else if (std::strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc) {
+			settings.repetitions = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else {
+			print_usage();
+			return 2;
+		}
+	}
+	if (settings.count == 0 || settings.repetitions == 0) {
+		print_usage();
+		return 2;
+	}
+
+	return SimpleEngine::MathBenchmark::run(settings) ? 0 : 1;
+}
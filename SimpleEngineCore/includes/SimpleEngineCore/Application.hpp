@@ -30,6 +30,11 @@ namespace SimpleEngine {
 		bool is_perspective_mode = true;
 		Camera camera{ {-2, 0, 0} };
 
+		// set before start: GL runs on a dedicated render thread that replays the frames recorded by the
+		// main one, at most render_frame_latency frames behind it
+		bool use_render_thread = false;
+		unsigned int render_frame_latency = 1;
+
 	private:
 		std::unique_ptr<class Window> m_pWindow;
 		EventDispatcher m_event_dispatcher;
@@ -2,6 +2,8 @@
 #include "glm/vec3.hpp"
 #include "glm/ext/matrix_float4x4.hpp"
 
+#include <cstdint>
+
 namespace SimpleEngine {
 
 	class Camera {
@@ -22,10 +24,18 @@ namespace SimpleEngine {
 		void set_position_rotation(const glm::vec3& position, const glm::vec3& rotation);
 		void set_projection_mode(const ProjectionMode& projection_mode);
 
+		ProjectionMode get_projection_mode() const { return m_projection_mode; }
+
 		void update_view_matrix();
 		void update_projection_matrix();
 		const glm::mat4& get_view_matrix();
 		const glm::mat4& get_projection_matrix() const { return m_projection_matrix; }
+		// projection * view, recomputed only after one of them changed
+		const glm::mat4& get_view_projection_matrix();
+
+		// increments whenever the view or the projection matrix changes,
+		// consumers compare it with the version they last saw
+		uint64_t get_version() const { return m_version; }
 
 		void move_forward(const float delta);
 		void move_right(const float delta);
@@ -51,8 +61,11 @@ namespace SimpleEngine {
 
 		glm::mat4 m_view_matrix;
 		glm::mat4 m_projection_matrix;
+		glm::mat4 m_view_projection_matrix;
 
 		bool m_update_view_matrix = false;
+		bool m_update_view_projection_matrix = true;
+		uint64_t m_version = 0;
 	};
 
 }
\ No newline at end of file
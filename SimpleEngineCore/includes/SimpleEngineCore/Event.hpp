@@ -8,6 +8,7 @@ namespace SimpleEngine {
 	enum class EventType {
 		WindowResize,
 		WindowClose,
+		FramebufferResize,
 
 		KeyPressed,
 		KeyReleased,
@@ -62,6 +63,24 @@ namespace SimpleEngine {
 		static const EventType type = EventType::WindowResize;
 	};
 
+	// in pixels, which differ from the window size on high-DPI displays
+	struct EventFramebufferResize : public BaseEvent
+	{
+		EventFramebufferResize(const unsigned int new_width, const unsigned int new_height)
+		:	width(new_width),
+			height(new_height)
+		{}
+
+		virtual EventType get_type() const override {
+			return type;
+		}
+
+		unsigned int width;
+		unsigned int height;
+
+		static const EventType type = EventType::FramebufferResize;
+	};
+
 	struct EventWindowClose : public BaseEvent
 	{
 		virtual EventType get_type() const override {
@@ -3,11 +3,29 @@
 #include "SimpleEngineCore/Window.hpp"
 
 #include "SimpleEngineCore/Rendering/OpenGL/ShaderProgram.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/ShaderCache.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/ShaderPermutations.hpp"
 #include "SimpleEngineCore/Rendering/OpenGL/VertexBuffer.hpp"
 #include "SimpleEngineCore/Rendering/OpenGL/VertexArray.hpp"
 #include "SimpleEngineCore/Rendering/OpenGL/IndexBuffer.hpp"
 #include "SimpleEngineCore/Camera.hpp"
 #include "SimpleEngineCore/Rendering/OpenGL/Renderer_OpenGL.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/RenderQueue.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/RenderStateCache.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/Texture2D.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/Sampler.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/UploadQueue.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/CameraUniformBuffer.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/TransformBuffer.hpp"
+#include "SimpleEngineCore/Rendering/FrustumCulling.hpp"
+#include "SimpleEngineCore/Rendering/RenderThread.hpp"
+#include "SimpleEngineCore/Rendering/VertexQuantization.hpp"
+#include "SimpleEngineCore/Procedural/ProceduralTexture.hpp"
+#include "SimpleEngineCore/Jobs/JobSystem.hpp"
+#include "SimpleEngineCore/Resources/FileSystem.hpp"
+#include "SimpleEngineCore/Resources/TextureFile.hpp"
+#include "SimpleEngineCore/Scene/World.hpp"
+#include "SimpleEngineCore/Scene/TransformHierarchy.hpp"
 #include "SimpleEngineCore/Modules/UIModule.hpp"
 #include "SimpleEngineCore/Input.hpp"
 
@@ -16,13 +34,38 @@
 #include "imgui/imgui.h"
 #include "glm/mat3x3.hpp"
 #include "glm/trigonometric.hpp"
+#include "glm/geometric.hpp"
+#include "glm/gtc/quaternion.hpp"
 
 #include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <vector>
 
 namespace SimpleEngine {
 
-    std::unique_ptr<class ShaderProgram> p_shader_program;
+    std::unique_ptr<class ShaderPermutations> p_shader_permutations;
     std::unique_ptr<class VertexArray> p_vao;
+    std::unique_ptr<class Texture2D> p_smile_texture;
+    std::unique_ptr<class Texture2D> p_squares_texture;
+    // sampled in place of the textures whose uploads are not complete yet
+    std::unique_ptr<class Texture2D> p_placeholder_texture;
+    std::unique_ptr<class UploadQueue> p_upload_queue;
+    std::unique_ptr<class FileSystem> p_file_system;
+    std::unique_ptr<class CameraUniformBuffer> p_camera_uniform_buffer;
+    std::unique_ptr<class TransformBuffer> p_transform_buffer;
+
+    struct TransformNode {
+        TransformId id;
+    };
+
+    // in local space, scaled with the world matrix
+    struct BoundingSphere {
+        float radius;
+    };
 
     GLfloat points_colors[]{
         // position                  color            texture
@@ -32,72 +75,103 @@ namespace SimpleEngine {
          0.0f,  0.5f,  0.5f,   1.0f, 1.0f, 1.0f,   -1.0f, 2.0f,
     };
 
+    constexpr size_t points_colors_stride = 8 * sizeof(GLfloat);
+    constexpr size_t vertices_count = sizeof(points_colors) / points_colors_stride;
+
+    // quantized points_colors: 16 bytes per vertex instead of 32
+    struct PackedVertex {
+        uint16_t position[4];   // Half4, w is unused
+        uint8_t color[4];       // UByte4Norm, alpha is unused
+        uint16_t texture_coord[2];  // Half2
+    };
+
+    using PackedVertexLayout = VertexLayout<PackedVertex,
+        VERTEX_ATTRIBUTE(PackedVertex, position, ShaderDataType::Half4),
+        VERTEX_ATTRIBUTE(PackedVertex, color, ShaderDataType::UByte4Norm),
+        VERTEX_ATTRIBUTE(PackedVertex, texture_coord, ShaderDataType::Half2)>;
+
     GLuint indices[]{
         0, 1, 2, 3, 2, 1
     };
 
-    void generate_circle(unsigned char* data, 
-                        const unsigned int width,
-                        const unsigned int height, 
-                        const unsigned int center_x, 
-                        const unsigned int center_y, 
-                        const unsigned int radius, 
-                        const unsigned char color_r,
-                        const unsigned char color_g, 
-                        const unsigned char color_b) {
-        for (int x = 0; x < width; ++x) {
-            for (int y = 0; y < height; ++y) {
-                if ((x - center_x) * (x - center_x) + (y - center_y) * (y - center_y) < radius * radius) {
-                    data[(width * y + x) * 3 + 0] = color_r;
-                    data[(width * y + x) * 3 + 1] = color_g;
-                    data[(width * y + x) * 3 + 2] = color_b;
-                }
-            }
-        }
-    }
-
     void generate_smile_texture(unsigned char* data,
                                 const unsigned int width,
                                 const unsigned int height) {
+        const ImageView image{ data, width, height, 3 };
+
         // background
-        for (int x = 0; x < width; ++x) {
-            for (int y = 0; y < height; ++y) {
-                data[(width * y + x) * 3 + 0] = 200;
-                data[(width * y + x) * 3 + 1] = 200;
-                data[(width * y + x) * 3 + 2] = 200;
-            }
-        }
+        ProceduralTexture::fill(image, { 200, 200, 200 });
 
         // face
         unsigned int min = (width > height ? height : width);
-        generate_circle(data, width, height, width / 2, height / 2,  min * 0.4, 255, 255, 0);
+        ProceduralTexture::fill_circle(image, width / 2, height / 2, min * 0.4, { 255, 255, 0 });
 
         // smile
-        generate_circle(data, width, height, width / 2, height * 0.4,  min * 0.2, 0, 0, 0);
-        generate_circle(data, width, height, width / 2, height * 0.45, min * 0.2, 255, 255, 0);
+        ProceduralTexture::fill_circle(image, width / 2, height * 0.4, min * 0.2, { 0, 0, 0 });
+        ProceduralTexture::fill_circle(image, width / 2, height * 0.45, min * 0.2, { 255, 255, 0 });
 
         // eyes
-        generate_circle(data, width, height, width * 0.35, height * 0.6, min * 0.07, 255, 0, 255);
-        generate_circle(data, width, height, width * 0.65, height * 0.6, min * 0.07, 0, 0, 255);
-
+        ProceduralTexture::fill_circle(image, width * 0.35, height * 0.6, min * 0.07, { 255, 0, 255 });
+        ProceduralTexture::fill_circle(image, width * 0.65, height * 0.6, min * 0.07, { 0, 0, 255 });
     }
 
     void generate_squares_texture(unsigned char* data,
         const unsigned int width,
         const unsigned int height) {
-        for (int x = 0; x < width; ++x) {
-            for (int y = 0; y < height; ++y) {
-                char color = 0;
-                if (x < width / 2 != y < height / 2) color = 255;
-                data[(width * y + x) * 3 + 0] = color;
-                data[(width * y + x) * 3 + 1] = color;
-                data[(width * y + x) * 3 + 2] = color;
-            }
+        const ImageView image{ data, width, height, 3 };
+        ProceduralTexture::fill_checkerboard(image, (width + 1) / 2, (height + 1) / 2, { 0, 0, 0 }, { 255, 255, 255 });
+    }
+
+    // texture produced by SimpleEngineAssetCooker, nullptr if there is none.
+    // The mip chain is cooked, so the levels are copied from the file as they are; their handles go to uploads
+    std::unique_ptr<Texture2D> load_cooked_texture(UploadQueue& upload_queue, const FileSystem& file_system, const std::string& path,
+                                                   std::vector<UploadHandle>& uploads) {
+        if (!file_system.exists(path))
+            return nullptr;
+        auto file = std::make_shared<TextureFile>();
+        if (!file->open(file_system, path))
+            return nullptr;
+
+        auto texture = std::make_unique<Texture2D>(file->get_width(), file->get_height(), file->get_format(), file->get_mip_levels());
+        for (unsigned int level = 0; level < file->get_mip_levels(); ++level) {
+            const TextureFileMipLevel& mip_level = file->get_header().levels[level];
+            // the producer owns the file, so the mapping outlives the copy
+            uploads.push_back(upload_queue.upload_texture(*texture, 0, 0, mip_level.width, mip_level.height, level,
+                [file, level](void* destination, const size_t size) {
+                    std::memcpy(destination, file->get_level_data(level), size);
+                    return true;
+                }));
         }
+        return texture;
+    }
+
+    // shader source produced by SimpleEngineAssetCooker, empty if there is none
+    std::string load_cooked_shader(const FileSystem& file_system, const std::string& path) {
+        if (!file_system.exists(path))
+            return {};
+        const FileData file = file_system.read(path);
+        if (!file.is_valid())
+            return {};
+        return std::string(reinterpret_cast<const char*>(file.get_data()), file.get_size());
+    }
+
+    // the texture if all of its uploads are complete, the placeholder until then
+    unsigned int get_texture_to_sample(const Texture2D& texture, const std::vector<UploadHandle>& uploads) {
+        const bool is_ready = std::all_of(uploads.begin(), uploads.end(), [](const UploadHandle& upload) { return upload.is_ready(); });
+        return is_ready ? texture.get_id() : p_placeholder_texture->get_id();
     }
 
+    // reported by the thread issuing the GL calls for the UI, which shows it a frame or two late with a render thread
+    struct RenderFrameStats {
+        std::atomic<uint64_t> issued_state_calls{ 0 };
+        std::atomic<uint64_t> skipped_state_calls{ 0 };
+        std::atomic<uint64_t> shader_cache_hits{ 0 };
+        std::atomic<uint64_t> shader_cache_misses{ 0 };
+    };
+
     float scale[] = { 1.0f, 1.0f, 1.0f };
     float rotate = 0.f;
+    bool animate_squares = true;
     float translate[] = { 0.0f, 0.0f , 0.f };
     float m_background_color[4]{ .33f, .33f, .33f, 0.f };
 
@@ -107,8 +181,15 @@ namespace SimpleEngine {
         layout (location = 0) in vec3 vertex_position;
         layout (location = 1) in vec3 vertex_color;
         layout (location = 2) in vec2 texture_coord;
-        uniform mat4 model_matrix;
-        uniform mat4 view_projection_matrix;
+        layout(std430, binding = 1) readonly buffer ModelMatrices {
+            mat4 model_matrices[];
+        };
+        layout(std140, binding = 0) uniform CameraBlock {
+            mat4 view_matrix;
+            mat4 projection_matrix;
+            mat4 view_projection_matrix;
+            vec4 camera_position;
+        };
         uniform int current_frame;        
 
         out vec3 color;
@@ -117,9 +198,13 @@ namespace SimpleEngine {
 
         void main() {
         	color = vertex_color;
-        	gl_Position = view_projection_matrix * model_matrix * vec4(vertex_position, 1.0);
+        	gl_Position = view_projection_matrix * model_matrices[gl_BaseInstance + gl_InstanceID] * vec4(vertex_position, 1.0);
             text_coord_smile = texture_coord;
+        #ifdef ANIMATE_SQUARES
             text_coord_squares = texture_coord + vec2(current_frame / 1000.f, current_frame / 1000.f);
+        #else
+            text_coord_squares = texture_coord;
+        #endif
         }
         )";
 
@@ -149,8 +234,24 @@ namespace SimpleEngine {
 	}
 
 	int Application::start(unsigned __int32 window_width, unsigned __int32 window_height, const char* title) {
+		// this thread becomes the main thread of the job system and helps with jobs while it waits
+		JobSystem::initialize();
 		m_pWindow = std::make_unique<Window>(title, window_width, window_height);
 
+        // GL work of the frame loop goes through render: issued right away, or recorded for the render thread.
+        // The commands capture by value what the main thread goes on to change
+        std::unique_ptr<RenderThread> render_thread;
+        const auto render = [&render_thread](auto&& command) {
+            if (render_thread)
+                render_thread->get_recording_buffer().push(std::forward<decltype(command)>(command));
+            else
+                command();
+        };
+        // arrays read by a command: copied next to the recorded commands, read in place when issued right away
+        const auto render_data = [&render_thread](const auto* data, const size_t count) {
+            return render_thread ? render_thread->get_recording_buffer().push_data(data, count) : data;
+        };
+
 		m_pWindow->set_event_callback(
 			[&](BaseEvent& event) {
 				m_event_dispatcher.dispatch(event);
@@ -162,6 +263,11 @@ namespace SimpleEngine {
 				LOG_INFO("[WindowResized] Change size to {0}x{1}", event.width, event.height);
 			});
 
+		m_event_dispatcher.add_event_listener<EventFramebufferResize>(
+			[&render](EventFramebufferResize& event) {
+				render([width = event.width, height = event.height]() { Renderer_OpenGL::set_view_port(width, height); });
+			});
+
 		m_event_dispatcher.add_event_listener<EventWindowClose>(
 			[&](EventWindowClose& event) {
 				LOG_INFO("[WindowClose] Window closed");
@@ -200,97 +306,192 @@ namespace SimpleEngine {
 			});
         const unsigned int width = 1000;
         const unsigned int height = 1000;
-        const unsigned int channels = 3;
-
-        unsigned char* data = new unsigned char[width * height * channels];
-
-        GLuint smileTexture;
-        glCreateTextures(GL_TEXTURE_2D, 1, &smileTexture);
-        glTextureStorage2D(smileTexture, 1, GL_RGB8, width, height);
-        generate_smile_texture(data, width, height);
-        glTextureSubImage2D(smileTexture, 0, 0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, data);
 
-        glTextureParameteri(smileTexture, GL_TEXTURE_WRAP_S, GL_MIRRORED_REPEAT);
-        glTextureParameteri(smileTexture, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTextureParameteri(smileTexture, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTextureParameteri(smileTexture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        glBindTextureUnit(0, smileTexture);
+        // textures are generated on worker threads straight into staging memory
+        // and appear once their copies complete
+        p_upload_queue = std::make_unique<UploadQueue>();
+
+        // loose cooked files override the packed ones, so assets can be recooked without repacking
+        p_file_system = std::make_unique<FileSystem>();
+        if (std::filesystem::exists("Cooked.pak"))
+            p_file_system->mount_archive("Cooked.pak");
+        if (std::filesystem::is_directory("Cooked"))
+            p_file_system->mount_directory("Cooked");
+
+        // until then draws sample a white texel
+        p_placeholder_texture = std::make_unique<Texture2D>(1, 1, ETextureFormat::RGB8, 1);
+        const unsigned char placeholder_texel[] = { 255, 255, 255 };
+        p_placeholder_texture->set_data(placeholder_texel);
+
+        // cooked textures are preferred, the procedural ones are the fallback when nothing was cooked
+        std::vector<UploadHandle> smile_texture_uploads;
+        p_smile_texture = load_cooked_texture(*p_upload_queue, *p_file_system, "Textures/smile.tex", smile_texture_uploads);
+        if (!p_smile_texture) {
+            p_smile_texture = std::make_unique<Texture2D>(width, height, ETextureFormat::RGB8);
+            smile_texture_uploads.push_back(p_upload_queue->upload_texture(*p_smile_texture, 0, 0, width, height, 0,
+                [width, height](void* destination, size_t) {
+                    generate_smile_texture(static_cast<unsigned char*>(destination), width, height);
+                    return true;
+                },
+                []() { p_smile_texture->generate_mipmaps(); }));
+        }
 
-        GLuint SquaresTexture;
-        glCreateTextures(GL_TEXTURE_2D, 1, &SquaresTexture);
-        glTextureStorage2D(SquaresTexture, 1, GL_RGB8, width, height);
-        generate_squares_texture(data, width, height);
-        glTextureSubImage2D(SquaresTexture, 0, 0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, data);
+        SamplerDescription smile_sampler_description;
+        smile_sampler_description.wrap_s = ETextureWrap::MirroredRepeat;
+        Sampler::get(smile_sampler_description).bind(0);
+
+        std::vector<UploadHandle> squares_texture_uploads;
+        p_squares_texture = load_cooked_texture(*p_upload_queue, *p_file_system, "Textures/squares.tex", squares_texture_uploads);
+        if (!p_squares_texture) {
+            p_squares_texture = std::make_unique<Texture2D>(width, height, ETextureFormat::RGB8);
+            squares_texture_uploads.push_back(p_upload_queue->upload_texture(*p_squares_texture, 0, 0, width, height, 0,
+                [width, height](void* destination, size_t) {
+                    generate_squares_texture(static_cast<unsigned char*>(destination), width, height);
+                    return true;
+                },
+                []() { p_squares_texture->generate_mipmaps(); }));
+        }
 
-        glTextureParameteri(SquaresTexture, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTextureParameteri(SquaresTexture, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTextureParameteri(SquaresTexture, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTextureParameteri(SquaresTexture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        Sampler::get(SamplerDescription{}).bind(1);
 
-        glBindTextureUnit(1, SquaresTexture);
+        //-----------------------------------//
+        ShaderCache::set_directory("ShaderCache");
+        // the animated variant is the fallback, the static one compiles in the background when requested
+        constexpr ShaderFeatureMask animate_squares_feature = 1 << 0;
+        // cooked shaders are preferred as a pair, the embedded sources are the fallback when they were not cooked
+        std::string vertex_shader_src = load_cooked_shader(*p_file_system, "Shaders/quad.vert");
+        std::string fragment_shader_src = load_cooked_shader(*p_file_system, "Shaders/quad.frag");
+        if (vertex_shader_src.empty() || fragment_shader_src.empty()) {
+            vertex_shader_src = vertex_shader;
+            fragment_shader_src = fragment_shader;
+        }
+        p_shader_permutations = std::make_unique<ShaderPermutations>(std::move(vertex_shader_src), std::move(fragment_shader_src),
+            std::vector<std::string>{ "ANIMATE_SQUARES" }, animate_squares_feature);
+        if (!p_shader_permutations->is_ready(animate_squares_feature)) {
+            // the producers and the workers must be done before the statics are destroyed
+            p_upload_queue = nullptr;
+            JobSystem::shutdown();
+            return false;
+        }
 
-        delete[] data;
+        constexpr UniformName current_frame_uniform = "current_frame";
 
-        //-----------------------------------//
-        p_shader_program = std::make_unique<ShaderProgram>(vertex_shader, fragment_shader);
-        if (!p_shader_program->is_compiled()) return false;
+        p_camera_uniform_buffer = std::make_unique<CameraUniformBuffer>();
+        p_transform_buffer = std::make_unique<TransformBuffer>();
 
 
         p_vao = std::make_unique<VertexArray>();
 
-        BufferLayout buffer_layout{
-            ShaderDataType::Float3,
-            ShaderDataType::Float3,
-            ShaderDataType::Float2
-        };
+        PackedVertex packed_vertices[vertices_count]{};
+        VertexQuantization::to_half(packed_vertices[0].position, sizeof(PackedVertex), points_colors, points_colors_stride, vertices_count, 3);
+        VertexQuantization::to_unorm8(packed_vertices[0].color, sizeof(PackedVertex), points_colors + 3, points_colors_stride, vertices_count, 3);
+        VertexQuantization::to_half(packed_vertices[0].texture_coord, sizeof(PackedVertex), points_colors + 6, points_colors_stride, vertices_count, 2);
 
-        VertexBuffer vbo(points_colors, sizeof(points_colors), buffer_layout);
-        IndexBuffer indexBuffer(indices, sizeof(indices) / sizeof(GLuint));
+        VertexBuffer vbo(packed_vertices, sizeof(packed_vertices), PackedVertexLayout::s_layout);
+        IndexBuffer indexBuffer(indices, sizeof(indices) / sizeof(GLuint), vertices_count);
 
         p_vao->add_vertex_buffer(vbo);
         p_vao->set_index_buffer(indexBuffer);
-
-        VertexArray::unbind();
         //-----------------------------------//
 
+        RenderQueue render_queue;
+        DrawItem draw_item;
+        draw_item.vertex_array = p_vao.get();
+
+        // the quad is an entity whose world matrix comes from the hierarchy, drawn with the index of its node
+        // as base instance; the quad lies in the x = 0 plane within [-0.5, 0.5]
+        World world;
+        TransformHierarchy transform_hierarchy;
+        const TransformId quad_transform = transform_hierarchy.create();
+        world.create(TransformNode{ quad_transform }, BoundingSphere{ 0.7072f });
+        float applied_rotate = 0.f;
+        std::vector<uint32_t> visible_transforms;
+
         int frame = 0;
+        RenderFrameStats render_stats;
+
+        // everything above was created on this thread, from here on the context belongs to the render thread
+        if (use_render_thread) {
+            UIModule::set_render_threaded(true);
+            m_pWindow->release_context();
+            render_thread = std::make_unique<RenderThread>(
+                [this]() { m_pWindow->make_context_current(); },
+                [this]() { m_pWindow->release_context(); },
+                render_frame_latency);
+        }
 
 		while (!m_bCloseWindow) {
+            render([]() { p_upload_queue->update(); });
 
             //-----------------------------------//
-            Renderer_OpenGL::set_clear_color(m_background_color[0], m_background_color[1], m_background_color[2], m_background_color[3]);
-            Renderer_OpenGL::clear();
-
-            glm::mat4 scale_matrix(scale[0], 0, 0, 0,
-                0, scale[1], 0, 0,
-                0, 0, scale[2], 0,
-                0, 0, 0, 1);
-
-            float rotate_in_radians = glm::radians(rotate);
-            glm::mat4 rotate_matrix(cos(rotate_in_radians), sin(rotate_in_radians), 0, 0,
-                -sin(rotate_in_radians), cos(rotate_in_radians), 0, 0,
-                0, 0, 1, 0,
-                0, 0, 0, 1);
-
-            glm::mat4 translate_matrix(1, 0, 0, 0,
-                0, 1, 0, 0,
-                0, 0, 1, 0,
-                translate[0], translate[1], translate[2], 1);
-
+            render([r = m_background_color[0], g = m_background_color[1], b = m_background_color[2], a = m_background_color[3]]() {
+                Renderer_OpenGL::set_clear_color(r, g, b, a);
+                Renderer_OpenGL::clear();
+            });
 
-            glm::mat4 model_matrix = translate_matrix * rotate_matrix * scale_matrix;
+            transform_hierarchy.set_translation(quad_transform, glm::vec3(translate[0], translate[1], translate[2]));
+            transform_hierarchy.set_scale(quad_transform, glm::vec3(scale[0], scale[1], scale[2]));
+            if (rotate != applied_rotate) {
+                transform_hierarchy.set_rotation(quad_transform, glm::angleAxis(glm::radians(rotate), glm::vec3(0.f, 0.f, 1.f)));
+                applied_rotate = rotate;
+            }
+            transform_hierarchy.update();
 
             camera.set_projection_mode(is_perspective_mode ? Camera::ProjectionMode::Perspective : Camera::ProjectionMode::Orthographic);
+            render([camera_snapshot = CameraUniformBuffer::capture(camera)]() { p_camera_uniform_buffer->publish(camera_snapshot); });
+
+            const Frustum frustum = Frustum::from_view_projection(camera.get_view_projection_matrix());
+            visible_transforms.clear();
+            world.query<const TransformNode, const BoundingSphere>().each(
+                [&](const TransformNode& node, const BoundingSphere& bounds) {
+                    const glm::mat4& world_matrix = transform_hierarchy.get_world_matrix(node.id);
+                    const float max_scale = std::sqrt(std::max({
+                        glm::dot(glm::vec3(world_matrix[0]), glm::vec3(world_matrix[0])),
+                        glm::dot(glm::vec3(world_matrix[1]), glm::vec3(world_matrix[1])),
+                        glm::dot(glm::vec3(world_matrix[2]), glm::vec3(world_matrix[2])) }));
+                    if (FrustumCulling::is_sphere_visible(frustum, glm::vec3(world_matrix[3]), bounds.radius * max_scale))
+                        visible_transforms.push_back(transform_hierarchy.get_index(node.id));
+                });
+
+            // only the world matrices changed by this update travel to the render thread and the GPU
+            const glm::mat4* changed_matrices = transform_hierarchy.get_world_matrices() + transform_hierarchy.get_changed_first();
+
+            // the queue and the draw item are only touched by the thread issuing the GL calls
+            render([&render_queue, &draw_item, &render_stats, &smile_texture_uploads, &squares_texture_uploads,
+                    current_frame_uniform,
+                    visible_transforms = render_data(visible_transforms.data(), visible_transforms.size()),
+                    visible_transforms_count = visible_transforms.size(),
+                    changed_matrices = render_data(changed_matrices, transform_hierarchy.get_changed_count()),
+                    changed_count = transform_hierarchy.get_changed_count(),
+                    changed_first = transform_hierarchy.get_changed_first(), transforms_count = transform_hierarchy.get_nodes_count(),
+                    features = animate_squares ? animate_squares_feature : ShaderFeatureMask(0), current_frame = frame++]() {
+                p_transform_buffer->upload(changed_matrices, changed_first, changed_count, transforms_count);
+                p_transform_buffer->bind();
+
+                p_shader_permutations->update();
+                ShaderProgram* shader_program = p_shader_permutations->get(features);
+                shader_program->bind();
+                shader_program->set_int(current_frame_uniform, current_frame);
+                draw_item.shader_program = shader_program;
+                // the handles are only read after setup, and their states are atomic
+                draw_item.textures = {
+                    get_texture_to_sample(*p_smile_texture, smile_texture_uploads),
+                    get_texture_to_sample(*p_squares_texture, squares_texture_uploads)
+                };
+
+                render_queue.clear();
+                for (size_t i = 0; i < visible_transforms_count; ++i) {
+                    draw_item.base_instance = visible_transforms[i];
+                    render_queue.push(draw_item);
+                }
+                Renderer_OpenGL::draw(render_queue);
 
-            p_shader_program->bind();
-            p_shader_program->set_matrix4("model_matrix", model_matrix);
-            p_shader_program->set_matrix4("view_projection_matrix", camera.get_projection_matrix() * camera.get_view_matrix());
-            p_shader_program->set_int("current_frame", frame++);
-
-            Renderer_OpenGL::draw(*p_vao);
-
-            ShaderProgram::unbind();
+                render_stats.issued_state_calls.store(RenderStateCache::get_stats().issued_calls, std::memory_order_relaxed);
+                render_stats.skipped_state_calls.store(RenderStateCache::get_stats().skipped_calls, std::memory_order_relaxed);
+                render_stats.shader_cache_hits.store(ShaderCache::get_stats().hits, std::memory_order_relaxed);
+                render_stats.shader_cache_misses.store(ShaderCache::get_stats().misses, std::memory_order_relaxed);
+                RenderStateCache::reset_stats();
+            });
 
             //-----------------------------------//
             UIModule::on_ui_draw_begin();
@@ -302,20 +503,51 @@ namespace SimpleEngine {
             ImGui::SliderFloat3("scale", scale, 0, 2);
             ImGui::SliderFloat("rotate", &rotate, 0, 360);
             ImGui::SliderFloat3("translate", translate, -1, 1);
+            ImGui::Checkbox("animate squares", &animate_squares);
+            ImGui::Text("GL state calls: %llu issued, %llu skipped",
+                static_cast<unsigned long long>(render_stats.issued_state_calls.load(std::memory_order_relaxed)),
+                static_cast<unsigned long long>(render_stats.skipped_state_calls.load(std::memory_order_relaxed)));
+            ImGui::Text("Shader cache: %llu hits, %llu misses",
+                static_cast<unsigned long long>(render_stats.shader_cache_hits.load(std::memory_order_relaxed)),
+                static_cast<unsigned long long>(render_stats.shader_cache_misses.load(std::memory_order_relaxed)));
             ImGui::End();
             //-----------------------------------//
 
             on_ui_draw();
 
-            UIModule::on_ui_draw_end();
+            if (render_thread) {
+                render([ui_draw_data = UIModule::on_ui_draw_end_deferred()]() { UIModule::render_draw_data(*ui_draw_data); });
+                render([this]() { m_pWindow->swap_buffers(); });
+                // blocks while the render thread is render_frame_latency frames behind
+                render_thread->submit_frame();
+            }
+            else {
+                UIModule::on_ui_draw_end();
+                m_pWindow->swap_buffers();
+            }
 
-			m_pWindow->on_update();
+			m_pWindow->poll_events();
 			on_update();
 		}
 
-        glDeleteTextures(1, &smileTexture);
-        glDeleteTextures(1, &SquaresTexture);
+        // the rest of the frames are replayed, then the context comes back for releasing the resources
+        if (render_thread) {
+            render_thread = nullptr;
+            m_pWindow->make_context_current();
+        }
+
+        // pending uploads may still read from mounted archives
+        p_upload_queue = nullptr;
+        p_file_system = nullptr;
+        p_shader_permutations = nullptr;
+        p_camera_uniform_buffer = nullptr;
+        p_transform_buffer = nullptr;
+        p_smile_texture = nullptr;
+        p_squares_texture = nullptr;
+        p_placeholder_texture = nullptr;
+        Sampler::clear_cache();
 		m_pWindow = nullptr;
+		JobSystem::shutdown();
 
 		return 0;
 	}
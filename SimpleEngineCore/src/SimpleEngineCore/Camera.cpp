@@ -1,6 +1,10 @@
 #include "SimpleEngineCore/Camera.hpp"
+#include "SimpleEngineCore/Math/MathKernels.hpp"
 #include "glm/trigonometric.hpp"
-#include "glm/ext/matrix_transform.hpp"
+#include "glm/geometric.hpp"
+#include "glm/mat3x3.hpp"
+
+#include <cmath>
 
 namespace SimpleEngine {
 	Camera::Camera(const glm::vec3& position, const glm::vec3& rotation, const ProjectionMode projection_mode)
@@ -12,51 +16,68 @@ namespace SimpleEngine {
 	}
 
 	void Camera::set_position(const glm::vec3& position) {
+		if (position == m_position)
+			return;
 		m_position = position;
 		m_update_view_matrix = true;
+		++m_version;
 	}
 
 	void Camera::set_rotation(const glm::vec3& rotation) {
+		if (rotation == m_rotation)
+			return;
 		m_rotation = rotation;
 		m_update_view_matrix = true;
+		++m_version;
 	}
 
 	void Camera::set_position_rotation(const glm::vec3& position, const glm::vec3& rotation) {
+		if (position == m_position && rotation == m_rotation)
+			return;
 		m_position = position;
 		m_rotation = rotation;
 		m_update_view_matrix = true;
+		++m_version;
 	}
 
 	void Camera::set_projection_mode(const ProjectionMode& projection_mode) {
+		if (projection_mode == m_projection_mode)
+			return;
 		m_projection_mode = projection_mode;
 		update_projection_matrix();
 	}
 	void Camera::update_view_matrix() {
-
 		const float roll_in_radians  = glm::radians(m_rotation.x);
 		const float pitch_in_radians = glm::radians(m_rotation.y);
 		const float yaw_in_radians   = glm::radians(m_rotation.z);
 
-		const glm::mat3 rotate_matrix_x(	1,	0,						0,
-											0,	cos(roll_in_radians),	sin(roll_in_radians),
-											0,	-sin(roll_in_radians),	cos(roll_in_radians));
-
-		const glm::mat3 rotate_matrix_y(	cos(pitch_in_radians),	0,	-sin(pitch_in_radians),
-											0,						1,	0,
-											sin(pitch_in_radians),	0,	cos(pitch_in_radians));
-
-		const glm::mat3 rotate_matrix_z(	cos(yaw_in_radians),	sin(yaw_in_radians),	0,
-											-sin(yaw_in_radians),	cos(yaw_in_radians),	0,
-											0,						0,						1);
-
-		const glm::mat3 euler_rotate_matrix = rotate_matrix_z * rotate_matrix_y * rotate_matrix_x;
-
-		m_direction = glm::normalize(euler_rotate_matrix * s_world_forward);
-		m_right = glm::normalize(euler_rotate_matrix * s_world_right);
+		const float sin_roll = std::sin(roll_in_radians);
+		const float cos_roll = std::cos(roll_in_radians);
+		const float sin_pitch = std::sin(pitch_in_radians);
+		const float cos_pitch = std::cos(pitch_in_radians);
+		const float sin_yaw = std::sin(yaw_in_radians);
+		const float cos_yaw = std::cos(yaw_in_radians);
+
+		// rotate_z(yaw) * rotate_y(pitch) * rotate_x(roll) multiplied out, each angle's sin and cos computed once
+		const glm::mat3 euler_rotate_matrix(
+			cos_yaw * cos_pitch,								sin_yaw * cos_pitch,								-sin_pitch,
+			cos_yaw * sin_pitch * sin_roll - sin_yaw * cos_roll,	sin_yaw * sin_pitch * sin_roll + cos_yaw * cos_roll,	cos_pitch * sin_roll,
+			cos_yaw * sin_pitch * cos_roll + sin_yaw * sin_roll,	sin_yaw * sin_pitch * cos_roll - cos_yaw * sin_roll,	cos_pitch * cos_roll);
+
+		// a rotation keeps the world axes orthonormal, so no normalization is needed
+		m_direction = euler_rotate_matrix * s_world_forward;
+		m_right = euler_rotate_matrix * s_world_right;
 		m_up = glm::cross(m_right, m_direction);
 
-		m_view_matrix = glm::lookAt(m_position, m_position + m_direction, m_up);
+		// what lookAt(position, position + direction, up) builds, with the basis already at hand:
+		// rows right, up and -direction, translated by the position in that basis
+		m_view_matrix = glm::mat4(
+			m_right.x,	m_up.x,	-m_direction.x,	0,
+			m_right.y,	m_up.y,	-m_direction.y,	0,
+			m_right.z,	m_up.z,	-m_direction.z,	0,
+			-glm::dot(m_right, m_position), -glm::dot(m_up, m_position), glm::dot(m_direction, m_position), 1);
 		m_update_view_matrix = false;
+		m_update_view_projection_matrix = true;
 	}
 	void Camera::update_projection_matrix() {
 		if (m_projection_mode == Camera::ProjectionMode::Perspective) {
@@ -79,6 +100,8 @@ namespace SimpleEngine {
 											0,		0,		-2 / (f - n),		0,
 											0,		0,		(-f - n) / (f - n), 1);
 		}
+		m_update_view_projection_matrix = true;
+		++m_version;
 	}
 
 	const glm::mat4& Camera::get_view_matrix()
@@ -88,25 +111,47 @@ namespace SimpleEngine {
 		return m_view_matrix;
 	}
 
+	const glm::mat4& Camera::get_view_projection_matrix() {
+		if (m_update_view_matrix)
+			update_view_matrix();
+		if (m_update_view_projection_matrix) {
+			MathKernels::multiply_matrices(m_projection_matrix, &m_view_matrix, &m_view_projection_matrix, 1);
+			m_update_view_projection_matrix = false;
+		}
+		return m_view_projection_matrix;
+	}
+
 	void Camera::move_forward(const float delta) {
+		if (delta == 0.f)
+			return;
 		m_position += m_direction * delta;
 		m_update_view_matrix = true;
+		++m_version;
 	}
 
 	void Camera::move_right(const float delta) {
+		if (delta == 0.f)
+			return;
 		m_position += m_right * delta;
 		m_update_view_matrix = true;
+		++m_version;
 	}
 
 	void Camera::move_up(const float delta) {
+		if (delta == 0.f)
+			return;
 		m_position += s_world_up * delta;
 		m_update_view_matrix = true;
+		++m_version;
 	}
 	void Camera::add_movement_and_rotation(const glm::vec3& movement_delta, const glm::vec3& rotation_delta) {
+		if (movement_delta == glm::vec3(0.f) && rotation_delta == glm::vec3(0.f))
+			return;
 		m_position += m_direction * movement_delta.x;
 		m_position += m_right * movement_delta.y;
 		m_position += m_up * movement_delta.z;
 		m_rotation += rotation_delta;
 		m_update_view_matrix = true;
+		++m_version;
 	}
 }
\ No newline at end of file
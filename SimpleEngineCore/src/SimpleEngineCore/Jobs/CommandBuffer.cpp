@@ -0,0 +1,35 @@
+#include "CommandBuffer.hpp"
+
+#include <algorithm>
+
+namespace SimpleEngine {
+
+	// big enough for a frame of small closures, larger commands get a chunk of their own
+	constexpr size_t s_command_chunk_size = 64 * 1024;
+
+	void* CommandArena::allocate(size_t size) {
+		size = (size + s_alignment - 1) & ~(s_alignment - 1);
+
+		// the chunks are reused in order, one too small for this block is skipped until reset
+		while (m_chunk_index < m_chunks.size() && m_chunk_offset + size > m_chunks[m_chunk_index].size) {
+			++m_chunk_index;
+			m_chunk_offset = 0;
+		}
+		if (m_chunk_index == m_chunks.size()) {
+			const size_t chunk_size = std::max(size, s_command_chunk_size);
+			// operator new[] aligns to at least max_align_t
+			m_chunks.push_back({ std::unique_ptr<unsigned char[]>(new unsigned char[chunk_size]), chunk_size });
+			m_chunk_offset = 0;
+		}
+
+		void* memory = m_chunks[m_chunk_index].data.get() + m_chunk_offset;
+		m_chunk_offset += size;
+		return memory;
+	}
+
+	void CommandArena::reset() {
+		m_chunk_index = 0;
+		m_chunk_offset = 0;
+	}
+
+}
@@ -0,0 +1,128 @@
+#pragma once
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace SimpleEngine {
+
+	// Memory handed out one block after another from chunks that are kept and reused after reset,
+	// so that allocating does not touch the heap once the arena has warmed up.
+	class CommandArena {
+	public:
+		CommandArena() = default;
+
+		CommandArena(const CommandArena&) = delete;
+		CommandArena& operator=(const CommandArena&) = delete;
+
+		static constexpr size_t s_alignment = alignof(std::max_align_t);
+
+		// aligned to s_alignment, valid until reset
+		void* allocate(size_t size);
+		// keeps the chunks for the next allocations
+		void reset();
+
+	private:
+		struct Chunk {
+			std::unique_ptr<unsigned char[]> data;
+			size_t size;
+		};
+
+		std::vector<Chunk> m_chunks;
+		size_t m_chunk_index = 0;
+		size_t m_chunk_offset = 0;
+	};
+
+	// Type-erased commands executed in the recorded order. Every command is a closure placed in a CommandArena
+	// right after its header, so closures may be move-only and recording doesn't allocate once the buffer has warmed up.
+	// Not synchronized: a buffer is recorded by one thread at a time.
+	template<typename... Args>
+	class CommandBuffer {
+	public:
+		CommandBuffer() = default;
+		~CommandBuffer() { clear(); }
+
+		CommandBuffer(const CommandBuffer&) = delete;
+		CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+		template<typename F>
+		void push(F&& function) {
+			using Function = std::decay_t<F>;
+			static_assert(alignof(Function) <= alignof(Command), "command is over-aligned");
+
+			void* memory = m_arena.allocate(sizeof(Command) + sizeof(Function));
+			Command* command = new (memory) Command{ &execute_command<Function>, &destroy_command<Function>, nullptr };
+			new (command + 1) Function(std::forward<F>(function));
+
+			if (m_last)
+				m_last->next = command;
+			else
+				m_first = command;
+			m_last = command;
+			++m_commands_count;
+		}
+
+		// a copy that stays valid until clear(), for a command to capture by pointer; nullptr if count is 0
+		template<typename T>
+		const T* push_data(const T* data, const size_t count) {
+			static_assert(std::is_trivially_copyable_v<T>, "command data is copied bytewise");
+			static_assert(alignof(T) <= alignof(Command), "command data is over-aligned");
+			if (count == 0)
+				return nullptr;
+
+			void* memory = m_arena.allocate(count * sizeof(T));
+			std::memcpy(memory, data, count * sizeof(T));
+			return static_cast<const T*>(memory);
+		}
+
+		// in the recorded order
+		void execute(Args... args) {
+			for (Command* command = m_first; command; command = command->next)
+				command->execute(command + 1, args...);
+		}
+
+		// destroys the commands, keeps the memory
+		void clear() {
+			for (Command* command = m_first; command;) {
+				Command* next = command->next;
+				command->destroy(command + 1);
+				command->~Command();
+				command = next;
+			}
+			m_first = nullptr;
+			m_last = nullptr;
+			m_commands_count = 0;
+			m_arena.reset();
+		}
+
+		size_t get_commands_count() const { return m_commands_count; }
+		bool is_empty() const { return m_commands_count == 0; }
+
+	private:
+		// the closure is stored right after its header
+		struct alignas(CommandArena::s_alignment) Command {
+			void (*execute)(void* function, Args... args);
+			void (*destroy)(void* function);
+			Command* next;
+		};
+
+		template<typename Function>
+		static void execute_command(void* function, Args... args) {
+			(*static_cast<Function*>(function))(args...);
+		}
+
+		template<typename Function>
+		static void destroy_command(void* function) {
+			static_cast<Function*>(function)->~Function();
+		}
+
+		CommandArena m_arena;
+		Command* m_first = nullptr;
+		Command* m_last = nullptr;
+		size_t m_commands_count = 0;
+	};
+
+}
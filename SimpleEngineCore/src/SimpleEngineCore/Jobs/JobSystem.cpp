@@ -0,0 +1,244 @@
+#include "JobSystem.hpp"
+#include "WorkStealingDeque.hpp"
+#include "SimpleEngineCore/Log.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace SimpleEngine {
+
+	struct Job {
+		JobSystem::Function function;
+		JobCounter* counter;
+	};
+
+	namespace {
+
+		// a thread that runs out of room in its deque runs the job inline instead
+		constexpr size_t s_job_deque_capacity = 4096;
+		// failed steal rounds before an idle worker goes to sleep
+		constexpr unsigned int s_job_spins_before_sleep = 64;
+
+		std::vector<std::unique_ptr<WorkStealingDeque<Job, s_job_deque_capacity>>> s_job_deques; // [0] - the initializing thread
+		std::vector<std::thread> s_job_workers;
+		std::atomic<bool> s_jobs_initialized{ false };
+
+		// jobs started by threads without a deque
+		std::deque<Job*> s_shared_jobs;
+		std::mutex s_shared_jobs_mutex;
+		std::atomic<size_t> s_shared_jobs_count{ 0 };
+
+		// pushed and not yet taken, wakes the sleeping workers
+		std::atomic<size_t> s_queued_jobs_count{ 0 };
+		std::atomic<unsigned int> s_sleeping_workers_count{ 0 };
+		std::mutex s_sleep_mutex;
+		std::condition_variable s_sleep_condition;
+		std::atomic<bool> s_jobs_stopping{ false };
+
+		thread_local int s_job_thread_index = -1; // into s_job_deques, -1 - not a thread of the system
+		thread_local uint32_t s_job_random_state = 0;
+
+		// xorshift, for picking steal victims
+		uint32_t next_job_random() {
+			if (s_job_random_state == 0)
+				s_job_random_state = static_cast<uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id())) | 1u;
+			s_job_random_state ^= s_job_random_state << 13;
+			s_job_random_state ^= s_job_random_state >> 17;
+			s_job_random_state ^= s_job_random_state << 5;
+			return s_job_random_state;
+		}
+
+		void wake_job_worker() {
+			// pairs with the sleeping worker incrementing the count before it checks for queued jobs
+			if (s_sleeping_workers_count.load() == 0)
+				return;
+			{
+				std::lock_guard<std::mutex> lock(s_sleep_mutex);
+			}
+			s_sleep_condition.notify_one();
+		}
+
+	}
+
+	void JobSystem::initialize(unsigned int workers_count) {
+		if (s_jobs_initialized.load()) {
+			LOG_WARN("JobSystem: already initialized");
+			return;
+		}
+		if (workers_count == 0)
+			workers_count = std::max(1u, std::thread::hardware_concurrency()) - 1;
+
+		s_jobs_stopping.store(false);
+		for (unsigned int i = 0; i <= workers_count; ++i)
+			s_job_deques.push_back(std::make_unique<WorkStealingDeque<Job, s_job_deque_capacity>>());
+		s_job_thread_index = 0;
+		s_jobs_initialized.store(true);
+
+		for (unsigned int i = 1; i <= workers_count; ++i)
+			s_job_workers.emplace_back(&JobSystem::worker_loop, static_cast<int>(i));
+		LOG_INFO("JobSystem: {0} workers", workers_count);
+	}
+
+	void JobSystem::shutdown() {
+		if (!s_jobs_initialized.load())
+			return;
+		if (s_job_thread_index != 0)
+			LOG_ERROR("JobSystem: shutdown must be called from the thread that initialized it");
+
+		{
+			std::lock_guard<std::mutex> lock(s_sleep_mutex);
+			s_jobs_stopping.store(true);
+		}
+		s_sleep_condition.notify_all();
+		for (std::thread& worker : s_job_workers)
+			worker.join();
+		s_job_workers.clear();
+
+		// leftovers would leave their counters unfinished forever
+		while (Job* job = find_job(0))
+			execute(job);
+
+		s_jobs_initialized.store(false);
+		s_job_deques.clear();
+		s_job_thread_index = -1;
+	}
+
+	bool JobSystem::is_initialized() {
+		return s_jobs_initialized.load(std::memory_order_acquire);
+	}
+
+	unsigned int JobSystem::get_threads_count() {
+		return is_initialized() ? static_cast<unsigned int>(s_job_deques.size()) : 1;
+	}
+
+	int JobSystem::get_thread_index() {
+		return s_job_thread_index;
+	}
+
+	void JobSystem::run(Function function, JobCounter* counter) {
+		if (!is_initialized()) {
+			function();
+			return;
+		}
+
+		if (counter)
+			counter->m_value.fetch_add(1, std::memory_order_relaxed);
+		Job* job = new Job{ std::move(function), counter };
+		s_queued_jobs_count.fetch_add(1);
+
+		const int thread_index = s_job_thread_index;
+		if (thread_index >= 0) {
+			if (!s_job_deques[thread_index]->push(job)) {
+				s_queued_jobs_count.fetch_sub(1);
+				execute(job);
+				return;
+			}
+		}
+		else {
+			std::lock_guard<std::mutex> lock(s_shared_jobs_mutex);
+			s_shared_jobs.push_back(job);
+			s_shared_jobs_count.fetch_add(1, std::memory_order_release);
+		}
+		wake_job_worker();
+	}
+
+	void JobSystem::wait(const JobCounter& counter) {
+		const int thread_index = s_job_thread_index;
+		while (!counter.is_done()) {
+			Job* job = is_initialized() ? find_job(thread_index) : nullptr;
+			if (job)
+				execute(job);
+			else
+				std::this_thread::yield();
+		}
+	}
+
+	void JobSystem::parallel_for(const size_t count, const size_t min_range_size, const RangeFunction& function) {
+		if (count == 0)
+			return;
+
+		// a few ranges per thread, so the threads that finish early steal the rest
+		const size_t max_ranges_count = static_cast<size_t>(get_threads_count()) * 4;
+		size_t ranges_count = std::min(max_ranges_count, count / std::max<size_t>(min_range_size, 1));
+		if (ranges_count <= 1) {
+			function(0, count);
+			return;
+		}
+		const size_t range_size = (count + ranges_count - 1) / ranges_count;
+		ranges_count = (count + range_size - 1) / range_size;
+
+		JobCounter counter;
+		for (size_t range = 1; range < ranges_count; ++range) {
+			const size_t first = range * range_size;
+			const size_t last = std::min(count, first + range_size);
+			run([&function, first, last]() { function(first, last); }, &counter);
+		}
+		function(0, range_size);
+		wait(counter);
+	}
+
+	void JobSystem::execute(Job* job) {
+		job->function();
+		if (job->counter)
+			job->counter->m_value.fetch_sub(1, std::memory_order_acq_rel);
+		delete job;
+	}
+
+	Job* JobSystem::find_job(const int thread_index) {
+		Job* job = nullptr;
+		if (thread_index >= 0)
+			job = s_job_deques[thread_index]->pop();
+
+		if (!job && s_shared_jobs_count.load(std::memory_order_acquire) > 0) {
+			std::lock_guard<std::mutex> lock(s_shared_jobs_mutex);
+			if (!s_shared_jobs.empty()) {
+				job = s_shared_jobs.front();
+				s_shared_jobs.pop_front();
+				s_shared_jobs_count.fetch_sub(1, std::memory_order_relaxed);
+			}
+		}
+
+		if (!job) {
+			const size_t deques_count = s_job_deques.size();
+			const size_t first_victim = next_job_random() % deques_count;
+			for (size_t i = 0; i < deques_count && !job; ++i) {
+				const size_t victim = (first_victim + i) % deques_count;
+				if (static_cast<int>(victim) != thread_index)
+					job = s_job_deques[victim]->steal();
+			}
+		}
+
+		if (job)
+			s_queued_jobs_count.fetch_sub(1);
+		return job;
+	}
+
+	void JobSystem::worker_loop(const int thread_index) {
+		s_job_thread_index = thread_index;
+		unsigned int idle_spins = 0;
+		while (!s_jobs_stopping.load(std::memory_order_relaxed)) {
+			if (Job* job = find_job(thread_index)) {
+				execute(job);
+				idle_spins = 0;
+				continue;
+			}
+			if (++idle_spins < s_job_spins_before_sleep) {
+				std::this_thread::yield();
+				continue;
+			}
+
+			idle_spins = 0;
+			std::unique_lock<std::mutex> lock(s_sleep_mutex);
+			s_sleeping_workers_count.fetch_add(1);
+			s_sleep_condition.wait(lock, []() { return s_queued_jobs_count.load() > 0 || s_jobs_stopping.load(); });
+			s_sleeping_workers_count.fetch_sub(1);
+		}
+		s_job_thread_index = -1;
+	}
+
+}
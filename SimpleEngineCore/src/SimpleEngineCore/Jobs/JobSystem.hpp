@@ -0,0 +1,62 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace SimpleEngine {
+
+	struct Job;
+
+	// Number of unfinished jobs started with it. Waiting on a counter is how jobs depend on each other:
+	// a job that needs the results of others starts them with a counter and waits on it.
+	class JobCounter {
+	public:
+		JobCounter() = default;
+		JobCounter(const JobCounter&) = delete;
+		JobCounter& operator=(const JobCounter&) = delete;
+
+		bool is_done() const { return m_value.load(std::memory_order_acquire) == 0; }
+
+	private:
+		friend class JobSystem;
+		std::atomic<uint32_t> m_value{ 0 };
+	};
+
+	// Work-stealing job system: one worker per core besides the thread that initializes it, each with
+	// its own lock-free deque. A thread pushes the jobs it starts to its own deque, idle workers steal
+	// from the others. Threads that are not part of the system (e.g. the render thread) submit through
+	// a shared locked queue.
+	// A thread waiting on a counter runs other jobs meanwhile instead of blocking, so waiting inside a job
+	// is fine, but the jobs must not wait on anything outside of the system.
+	// Until it is initialized (and after shutdown) every job runs inline on the calling thread.
+	class JobSystem {
+	public:
+		using Function = std::function<void()>;
+		using RangeFunction = std::function<void(size_t first, size_t last)>;
+
+		// workers_count = 0 - one worker per hardware thread besides the calling one
+		static void initialize(unsigned int workers_count = 0);
+		// every started job must be finished
+		static void shutdown();
+		static bool is_initialized();
+		// workers and the initializing thread, 1 if not initialized
+		static unsigned int get_threads_count();
+		// of the calling thread in [0, get_threads_count()), -1 for threads outside of the system or if not initialized
+		static int get_thread_index();
+
+		// counter (if any) is incremented now and decremented when the job has finished
+		static void run(Function function, JobCounter* counter = nullptr);
+		static void wait(const JobCounter& counter);
+
+		// function is called for consecutive ranges covering [0, count), at least min_range_size long
+		// (except the last one), and returns once all of them are done
+		static void parallel_for(const size_t count, const size_t min_range_size, const RangeFunction& function);
+
+	private:
+		static void execute(Job* job);
+		static Job* find_job(const int thread_index);
+		static void worker_loop(const int thread_index);
+	};
+
+}
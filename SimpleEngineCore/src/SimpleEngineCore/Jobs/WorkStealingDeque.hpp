@@ -0,0 +1,81 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace SimpleEngine {
+
+	// Lock-free Chase-Lev deque of pointers with a fixed capacity (the C11 formulation of Le et al., 2013).
+	// The owner thread pushes and pops at the bottom, LIFO, so it keeps working on hot data;
+	// any other thread steals from the top, FIFO, taking the oldest and usually the largest work.
+	template<typename T, size_t Capacity>
+	class WorkStealingDeque {
+		static_assert((Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+	public:
+		WorkStealingDeque() = default;
+		WorkStealingDeque(const WorkStealingDeque&) = delete;
+		WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+		// owner only, false if the deque is full
+		bool push(T* item) {
+			const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+			const int64_t top = m_top.load(std::memory_order_acquire);
+			if (bottom - top >= static_cast<int64_t>(Capacity))
+				return false;
+			m_items[bottom & s_mask].store(item, std::memory_order_relaxed);
+			// publishes the item to the thieves
+			m_bottom.store(bottom + 1, std::memory_order_release);
+			return true;
+		}
+
+		// owner only, nullptr if empty or the last item was stolen
+		T* pop() {
+			const int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+			m_bottom.store(bottom, std::memory_order_relaxed);
+			// the bottom decrement must be visible before top is read, or a thief and the owner both take the last item
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t top = m_top.load(std::memory_order_relaxed);
+
+			if (top > bottom) {
+				m_bottom.store(bottom + 1, std::memory_order_relaxed);
+				return nullptr;
+			}
+			T* item = m_items[bottom & s_mask].load(std::memory_order_relaxed);
+			if (top == bottom) {
+				// the last item: race the thieves for it
+				if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+					item = nullptr;
+				m_bottom.store(bottom + 1, std::memory_order_relaxed);
+			}
+			return item;
+		}
+
+		// any thread, nullptr if empty or another thread won the item
+		T* steal() {
+			int64_t top = m_top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			const int64_t bottom = m_bottom.load(std::memory_order_acquire);
+			if (top >= bottom)
+				return nullptr;
+			T* item = m_items[top & s_mask].load(std::memory_order_relaxed);
+			if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				return nullptr;
+			return item;
+		}
+
+		// approximate when called concurrently
+		bool is_empty() const {
+			return m_bottom.load(std::memory_order_relaxed) <= m_top.load(std::memory_order_relaxed);
+		}
+
+	private:
+		static constexpr int64_t s_mask = static_cast<int64_t>(Capacity) - 1;
+
+		// top and bottom on separate cache lines: thieves hammer one, the owner the other
+		alignas(64) std::atomic<int64_t> m_top{ 0 };
+		alignas(64) std::atomic<int64_t> m_bottom{ 0 };
+		alignas(64) std::atomic<T*> m_items[Capacity] = {};
+	};
+
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Shared by MathKernels.cpp and the translation units built with wider instruction sets.
+// Nothing here is inline: those units must not emit copies of functions that other units use,
+// or the linker could pick an AVX2 copy on a CPU without AVX2.
+
+namespace SimpleEngine {
+
+	// local transforms as structure of arrays, rotations are unit quaternions
+	struct TransformArrays {
+		const float* translation_x;
+		const float* translation_y;
+		const float* translation_z;
+		const float* rotation_x;
+		const float* rotation_y;
+		const float* rotation_z;
+		const float* rotation_w;
+		const float* scale_x;
+		const float* scale_y;
+		const float* scale_z;
+	};
+
+	struct SphereArrays {
+		const float* center_x;
+		const float* center_y;
+		const float* center_z;
+		const float* radius;
+	};
+
+	// axis aligned boxes as centers and half extents
+	struct AABBArrays {
+		const float* center_x;
+		const float* center_y;
+		const float* center_z;
+		const float* extent_x;
+		const float* extent_y;
+		const float* extent_z;
+	};
+
+	struct AABBOutputArrays {
+		float* center_x;
+		float* center_y;
+		float* center_z;
+		float* extent_x;
+		float* extent_y;
+		float* extent_z;
+	};
+
+	// Matrices are 16 column-major floats, vectors and planes 4 floats.
+	// The cull kernels write the ascending indices of the visible objects of [first, last) and return their count
+	struct MathKernelTable {
+		const char* name;
+		// left_stride 0 multiplies every right matrix by the same left one, 16 walks both arrays
+		void (*multiply_matrices)(const float* left, const size_t left_stride, const float* right, float* result, const size_t count);
+		void (*transform_vectors)(const float* matrix, const float* vectors, float* result, const size_t count);
+		void (*compose_transforms)(const TransformArrays& transforms, float* result, const size_t count);
+		void (*transform_aabbs)(const float* matrices, const AABBArrays& boxes, const AABBOutputArrays& result, const size_t count);
+		size_t (*cull_spheres)(const float* planes, const size_t planes_count, const SphereArrays& spheres,
+			const size_t first, const size_t last, uint32_t* visible_indices);
+		size_t (*cull_aabbs)(const float* planes, const size_t planes_count, const AABBArrays& boxes,
+			const size_t first, const size_t last, uint32_t* visible_indices);
+	};
+
+	// Float4 kernels, always available; the wider sets hand their remainders over to them
+	const MathKernelTable& get_sse2_math_kernels();
+	// nullptr if the engine was built without them
+	const MathKernelTable* get_avx2_math_kernels();
+
+}
@@ -0,0 +1,399 @@
+#include "MathKernels.hpp"
+#include "SIMD.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define SIMPLE_ENGINE_X86_MSVC 1
+#include <intrin.h>
+#include <immintrin.h>
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define SIMPLE_ENGINE_X86_GCC 1
+#include <cpuid.h>
+#endif
+
+namespace SimpleEngine {
+
+	namespace {
+
+		// AVX2 and FMA on the CPU, with the YMM registers saved by the OS
+		bool cpu_supports_avx2() {
+#if defined(SIMPLE_ENGINE_X86_MSVC) || defined(SIMPLE_ENGINE_X86_GCC)
+			unsigned int registers[4] = {};
+#if defined(SIMPLE_ENGINE_X86_MSVC)
+			__cpuid(reinterpret_cast<int*>(registers), 0);
+#else
+			__cpuid(0, registers[0], registers[1], registers[2], registers[3]);
+#endif
+			if (registers[0] < 7)
+				return false;
+
+#if defined(SIMPLE_ENGINE_X86_MSVC)
+			__cpuid(reinterpret_cast<int*>(registers), 1);
+#else
+			__cpuid(1, registers[0], registers[1], registers[2], registers[3]);
+#endif
+			const bool has_fma = registers[2] & (1u << 12);
+			const bool has_osxsave = registers[2] & (1u << 27);
+			const bool has_avx = registers[2] & (1u << 28);
+			if (!has_fma || !has_osxsave || !has_avx)
+				return false;
+
+#if defined(SIMPLE_ENGINE_X86_MSVC)
+			const unsigned long long enabled_states = _xgetbv(0);
+#else
+			unsigned int enabled_states_low = 0;
+			unsigned int enabled_states_high = 0;
+			__asm__ volatile("xgetbv" : "=a"(enabled_states_low), "=d"(enabled_states_high) : "c"(0));
+			const unsigned long long enabled_states = enabled_states_low;
+#endif
+			// XMM and YMM state
+			if ((enabled_states & 0x6) != 0x6)
+				return false;
+
+#if defined(SIMPLE_ENGINE_X86_MSVC)
+			__cpuidex(reinterpret_cast<int*>(registers), 7, 0);
+#else
+			__cpuid_count(7, 0, registers[0], registers[1], registers[2], registers[3]);
+#endif
+			return registers[1] & (1u << 5);
+#else
+			return false;
+#endif
+		}
+
+		// branchless: every lane is written, only the visible ones are kept
+		inline size_t write_visible_lanes(const int visible_mask, const size_t first, const size_t lanes_count, uint32_t* visible_indices) {
+			size_t count = 0;
+			for (size_t lane = 0; lane < lanes_count; ++lane) {
+				visible_indices[count] = static_cast<uint32_t>(first + lane);
+				count += (visible_mask >> lane) & 1;
+			}
+			return count;
+		}
+
+		void multiply_matrices_sse2(const float* left, const size_t left_stride, const float* right, float* result, const size_t count) {
+			for (size_t i = 0; i < count; ++i) {
+				const float* l = left + i * left_stride;
+				const float* r = right + i * 16;
+				const Float4 left_x = Float4::load(l);
+				const Float4 left_y = Float4::load(l + 4);
+				const Float4 left_z = Float4::load(l + 8);
+				const Float4 left_w = Float4::load(l + 12);
+
+				// right is read entirely before result is written, so they may be the same
+				Float4 columns[4];
+				for (int column = 0; column < 4; ++column) {
+					columns[column] = left_x * Float4(r[column * 4]) + left_y * Float4(r[column * 4 + 1])
+						+ left_z * Float4(r[column * 4 + 2]) + left_w * Float4(r[column * 4 + 3]);
+				}
+				for (int column = 0; column < 4; ++column)
+					columns[column].store(result + i * 16 + column * 4);
+			}
+		}
+
+		// the components are broadcast from one load: per-component scalar loads each cost a load and a shuffle
+		inline Float4 transform_vector(const Float4 x, const Float4 y, const Float4 z, const Float4 w, const Float4 vector) {
+			return (x * broadcast<0>(vector) + y * broadcast<1>(vector)) + (z * broadcast<2>(vector) + w * broadcast<3>(vector));
+		}
+
+		void transform_vectors_sse2(const float* matrix, const float* vectors, float* result, const size_t count) {
+			const Float4 x = Float4::load(matrix);
+			const Float4 y = Float4::load(matrix + 4);
+			const Float4 z = Float4::load(matrix + 8);
+			const Float4 w = Float4::load(matrix + 12);
+			// four independent vectors per iteration keep the multipliers busy
+			size_t i = 0;
+			for (; i + 4 <= count; i += 4) {
+				const Float4 a = Float4::load(vectors + i * 4);
+				const Float4 b = Float4::load(vectors + i * 4 + 4);
+				const Float4 c = Float4::load(vectors + i * 4 + 8);
+				const Float4 d = Float4::load(vectors + i * 4 + 12);
+				transform_vector(x, y, z, w, a).store(result + i * 4);
+				transform_vector(x, y, z, w, b).store(result + i * 4 + 4);
+				transform_vector(x, y, z, w, c).store(result + i * 4 + 8);
+				transform_vector(x, y, z, w, d).store(result + i * 4 + 12);
+			}
+			for (; i < count; ++i)
+				transform_vector(x, y, z, w, Float4::load(vectors + i * 4)).store(result + i * 4);
+		}
+
+		// four transforms starting at first, the first nodes_count of them are written
+		void compose_transforms_lanes(const TransformArrays& transforms, const size_t first, float* result, const size_t nodes_count) {
+			const Float4 zero(0.f);
+			const Float4 one(1.f);
+			const Float4 two(2.f);
+
+			// four transforms per lane: quaternion to rotation matrix, columns scaled
+			const Float4 x = Float4::load(transforms.rotation_x + first);
+			const Float4 y = Float4::load(transforms.rotation_y + first);
+			const Float4 z = Float4::load(transforms.rotation_z + first);
+			const Float4 w = Float4::load(transforms.rotation_w + first);
+			const Float4 x2 = x * two;
+			const Float4 y2 = y * two;
+			const Float4 z2 = z * two;
+			const Float4 xx = x * x2;
+			const Float4 yy = y * y2;
+			const Float4 zz = z * z2;
+			const Float4 xy = x * y2;
+			const Float4 xz = x * z2;
+			const Float4 yz = y * z2;
+			const Float4 wx = w * x2;
+			const Float4 wy = w * y2;
+			const Float4 wz = w * z2;
+
+			const Float4 scale_x = Float4::load(transforms.scale_x + first);
+			const Float4 scale_y = Float4::load(transforms.scale_y + first);
+			const Float4 scale_z = Float4::load(transforms.scale_z + first);
+
+			Float4 columns[4][4] = {
+				{ (one - (yy + zz)) * scale_x, (xy + wz) * scale_x, (xz - wy) * scale_x, zero },
+				{ (xy - wz) * scale_y, (one - (xx + zz)) * scale_y, (yz + wx) * scale_y, zero },
+				{ (xz + wy) * scale_z, (yz - wx) * scale_z, (one - (xx + yy)) * scale_z, zero },
+				{ Float4::load(transforms.translation_x + first), Float4::load(transforms.translation_y + first), Float4::load(transforms.translation_z + first), one },
+			};
+
+			// lanes to matrices: after the transpose element k of a column group is the column of transform k
+			for (int column = 0; column < 4; ++column) {
+				Float4* lanes = columns[column];
+				transpose(lanes[0], lanes[1], lanes[2], lanes[3]);
+				for (size_t node = 0; node < nodes_count; ++node)
+					lanes[node].store(result + node * 16 + column * 4);
+			}
+		}
+
+		void compose_transforms_sse2(const TransformArrays& transforms, float* result, const size_t count) {
+			size_t i = 0;
+			for (; i + 4 <= count; i += 4)
+				compose_transforms_lanes(transforms, i, result + i * 16, 4);
+			if (i == count)
+				return;
+
+			// the remainder goes through identity-padded lanes, so no load reads past the arrays
+			float lanes[10][4] = {
+				{}, {}, {}, {}, {}, {}, { 1.f, 1.f, 1.f, 1.f }, { 1.f, 1.f, 1.f, 1.f }, { 1.f, 1.f, 1.f, 1.f }, { 1.f, 1.f, 1.f, 1.f },
+			};
+			const float* sources[10] = {
+				transforms.translation_x, transforms.translation_y, transforms.translation_z,
+				transforms.rotation_x, transforms.rotation_y, transforms.rotation_z, transforms.rotation_w,
+				transforms.scale_x, transforms.scale_y, transforms.scale_z,
+			};
+			for (int array = 0; array < 10; ++array)
+				std::copy(sources[array] + i, sources[array] + count, lanes[array]);
+
+			const TransformArrays remainder{
+				lanes[0], lanes[1], lanes[2], lanes[3], lanes[4], lanes[5], lanes[6], lanes[7], lanes[8], lanes[9],
+			};
+			compose_transforms_lanes(remainder, 0, result + i * 16, count - i);
+		}
+
+		void transform_aabbs_sse2(const float* matrices, const AABBArrays& boxes, const AABBOutputArrays& result, const size_t count) {
+			size_t i = 0;
+			for (; i + 4 <= count; i += 4) {
+				// element[row] of column c for the four matrices, the fourth row is not needed
+				Float4 elements[4][4];
+				for (int column = 0; column < 4; ++column) {
+					Float4* lanes = elements[column];
+					for (int matrix = 0; matrix < 4; ++matrix)
+						lanes[matrix] = Float4::load(matrices + (i + matrix) * 16 + column * 4);
+					transpose(lanes[0], lanes[1], lanes[2], lanes[3]);
+				}
+
+				const Float4 center_x = Float4::load(boxes.center_x + i);
+				const Float4 center_y = Float4::load(boxes.center_y + i);
+				const Float4 center_z = Float4::load(boxes.center_z + i);
+				const Float4 extent_x = Float4::load(boxes.extent_x + i);
+				const Float4 extent_y = Float4::load(boxes.extent_y + i);
+				const Float4 extent_z = Float4::load(boxes.extent_z + i);
+				for (int row = 0; row < 3; ++row) {
+					const Float4 center = elements[0][row] * center_x + elements[1][row] * center_y + elements[2][row] * center_z + elements[3][row];
+					const Float4 extent = abs(elements[0][row]) * extent_x + abs(elements[1][row]) * extent_y + abs(elements[2][row]) * extent_z;
+					float* centers[3] = { result.center_x, result.center_y, result.center_z };
+					float* extents[3] = { result.extent_x, result.extent_y, result.extent_z };
+					center.store(centers[row] + i);
+					extent.store(extents[row] + i);
+				}
+			}
+
+			for (; i < count; ++i) {
+				const float* matrix = matrices + i * 16;
+				const float center[3] = { boxes.center_x[i], boxes.center_y[i], boxes.center_z[i] };
+				const float extent[3] = { boxes.extent_x[i], boxes.extent_y[i], boxes.extent_z[i] };
+				float transformed_center[3];
+				float transformed_extent[3];
+				for (int row = 0; row < 3; ++row) {
+					transformed_center[row] = matrix[12 + row];
+					transformed_extent[row] = 0.f;
+					for (int column = 0; column < 3; ++column) {
+						transformed_center[row] += matrix[column * 4 + row] * center[column];
+						transformed_extent[row] += std::abs(matrix[column * 4 + row]) * extent[column];
+					}
+				}
+				result.center_x[i] = transformed_center[0];
+				result.center_y[i] = transformed_center[1];
+				result.center_z[i] = transformed_center[2];
+				result.extent_x[i] = transformed_extent[0];
+				result.extent_y[i] = transformed_extent[1];
+				result.extent_z[i] = transformed_extent[2];
+			}
+		}
+
+		size_t cull_spheres_sse2(const float* planes, const size_t planes_count, const SphereArrays& spheres,
+			const size_t first, const size_t last, uint32_t* visible_indices) {
+			size_t visible_count = 0;
+			size_t i = first;
+			for (; i + 4 <= last; i += 4) {
+				const Float4 x = Float4::load(spheres.center_x + i);
+				const Float4 y = Float4::load(spheres.center_y + i);
+				const Float4 z = Float4::load(spheres.center_z + i);
+				const Float4 negative_radius = Float4(0.f) - Float4::load(spheres.radius + i);
+
+				Float4 outside(0.f);
+				for (size_t plane = 0; plane < planes_count; ++plane) {
+					const float* p = planes + plane * 4;
+					const Float4 distance = x * Float4(p[0]) + y * Float4(p[1]) + z * Float4(p[2]) + Float4(p[3]);
+					outside = outside | (distance < negative_radius);
+				}
+				visible_count += write_visible_lanes(~move_mask(outside) & 0xf, i, 4, visible_indices + visible_count);
+			}
+
+			for (; i < last; ++i) {
+				bool is_visible = true;
+				for (size_t plane = 0; plane < planes_count && is_visible; ++plane) {
+					const float* p = planes + plane * 4;
+					is_visible = p[0] * spheres.center_x[i] + p[1] * spheres.center_y[i] + p[2] * spheres.center_z[i] + p[3] >= -spheres.radius[i];
+				}
+				if (is_visible)
+					visible_indices[visible_count++] = static_cast<uint32_t>(i);
+			}
+			return visible_count;
+		}
+
+		size_t cull_aabbs_sse2(const float* planes, const size_t planes_count, const AABBArrays& boxes,
+			const size_t first, const size_t last, uint32_t* visible_indices) {
+			size_t visible_count = 0;
+			size_t i = first;
+			for (; i + 4 <= last; i += 4) {
+				const Float4 x = Float4::load(boxes.center_x + i);
+				const Float4 y = Float4::load(boxes.center_y + i);
+				const Float4 z = Float4::load(boxes.center_z + i);
+				const Float4 extent_x = Float4::load(boxes.extent_x + i);
+				const Float4 extent_y = Float4::load(boxes.extent_y + i);
+				const Float4 extent_z = Float4::load(boxes.extent_z + i);
+
+				Float4 outside(0.f);
+				for (size_t plane = 0; plane < planes_count; ++plane) {
+					// distance of the box corner farthest along the plane normal
+					const float* p = planes + plane * 4;
+					const Float4 distance = x * Float4(p[0]) + y * Float4(p[1]) + z * Float4(p[2]) + Float4(p[3])
+						+ extent_x * Float4(std::abs(p[0])) + extent_y * Float4(std::abs(p[1])) + extent_z * Float4(std::abs(p[2]));
+					outside = outside | (distance < Float4(0.f));
+				}
+				visible_count += write_visible_lanes(~move_mask(outside) & 0xf, i, 4, visible_indices + visible_count);
+			}
+
+			for (; i < last; ++i) {
+				bool is_visible = true;
+				for (size_t plane = 0; plane < planes_count && is_visible; ++plane) {
+					const float* p = planes + plane * 4;
+					is_visible = p[0] * boxes.center_x[i] + p[1] * boxes.center_y[i] + p[2] * boxes.center_z[i] + p[3]
+						+ std::abs(p[0]) * boxes.extent_x[i] + std::abs(p[1]) * boxes.extent_y[i] + std::abs(p[2]) * boxes.extent_z[i] >= 0.f;
+				}
+				if (is_visible)
+					visible_indices[visible_count++] = static_cast<uint32_t>(i);
+			}
+			return visible_count;
+		}
+
+	}
+
+	const MathKernelTable& get_sse2_math_kernels() {
+		static const MathKernelTable kernels{
+			"SSE2",
+			multiply_matrices_sse2,
+			transform_vectors_sse2,
+			compose_transforms_sse2,
+			transform_aabbs_sse2,
+			cull_spheres_sse2,
+			cull_aabbs_sse2,
+		};
+		return kernels;
+	}
+
+	namespace {
+
+		const MathKernelTable* select_math_kernels(const EMathKernelSet kernel_set) {
+			if (kernel_set == EMathKernelSet::AVX2)
+				// the AVX2 unit is compiled for AVX2 throughout, nothing in it runs before the check
+				return cpu_supports_avx2() ? get_avx2_math_kernels() : nullptr;
+			return &get_sse2_math_kernels();
+		}
+
+		std::atomic<const MathKernelTable*> s_math_kernels{ nullptr };
+
+		// the widest set the CPU supports, picked on the first call
+		const MathKernelTable& get_math_kernels() {
+			const MathKernelTable* kernels = s_math_kernels.load(std::memory_order_acquire);
+			if (!kernels) {
+				kernels = select_math_kernels(EMathKernelSet::AVX2);
+				if (!kernels)
+					kernels = select_math_kernels(EMathKernelSet::SSE2);
+				s_math_kernels.store(kernels, std::memory_order_release);
+			}
+			return *kernels;
+		}
+
+	}
+
+	void MathKernels::multiply_matrices(const glm::mat4* left, const glm::mat4* right, glm::mat4* result, const size_t count) {
+		get_math_kernels().multiply_matrices(reinterpret_cast<const float*>(left), 16, reinterpret_cast<const float*>(right), reinterpret_cast<float*>(result), count);
+	}
+
+	void MathKernels::multiply_matrices(const glm::mat4& left, const glm::mat4* right, glm::mat4* result, const size_t count) {
+		get_math_kernels().multiply_matrices(&left[0][0], 0, reinterpret_cast<const float*>(right), reinterpret_cast<float*>(result), count);
+	}
+
+	void MathKernels::transform_vectors(const glm::mat4& matrix, const glm::vec4* vectors, glm::vec4* result, const size_t count) {
+		get_math_kernels().transform_vectors(&matrix[0][0], reinterpret_cast<const float*>(vectors), reinterpret_cast<float*>(result), count);
+	}
+
+	void MathKernels::compose_transforms(const TransformArrays& transforms, glm::mat4* result, const size_t count) {
+		get_math_kernels().compose_transforms(transforms, reinterpret_cast<float*>(result), count);
+	}
+
+	void MathKernels::transform_aabbs(const glm::mat4* matrices, const AABBArrays& boxes, const AABBOutputArrays& result, const size_t count) {
+		get_math_kernels().transform_aabbs(reinterpret_cast<const float*>(matrices), boxes, result, count);
+	}
+
+	size_t MathKernels::cull_spheres(const glm::vec4* planes, const size_t planes_count, const SphereArrays& spheres,
+		const size_t first, const size_t last, uint32_t* visible_indices) {
+		return get_math_kernels().cull_spheres(reinterpret_cast<const float*>(planes), planes_count, spheres, first, last, visible_indices);
+	}
+
+	size_t MathKernels::cull_aabbs(const glm::vec4* planes, const size_t planes_count, const AABBArrays& boxes,
+		const size_t first, const size_t last, uint32_t* visible_indices) {
+		return get_math_kernels().cull_aabbs(reinterpret_cast<const float*>(planes), planes_count, boxes, first, last, visible_indices);
+	}
+
+	EMathKernelSet MathKernels::get_kernel_set() {
+		return &get_math_kernels() == &get_sse2_math_kernels() ? EMathKernelSet::SSE2 : EMathKernelSet::AVX2;
+	}
+
+	const char* MathKernels::get_kernel_set_name() {
+		return get_math_kernels().name;
+	}
+
+	bool MathKernels::is_supported(const EMathKernelSet kernel_set) {
+		return select_math_kernels(kernel_set) != nullptr;
+	}
+
+	bool MathKernels::set_kernel_set(const EMathKernelSet kernel_set) {
+		const MathKernelTable* kernels = select_math_kernels(kernel_set);
+		if (!kernels)
+			return false;
+		s_math_kernels.store(kernels, std::memory_order_release);
+		return true;
+	}
+
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "MathKernelTable.hpp"
+#include "glm/vec4.hpp"
+#include "glm/mat4x4.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace SimpleEngine {
+
+	enum class EMathKernelSet {
+		SSE2, // Float4, plain arrays on targets without SSE2
+		AVX2, // 8 lanes with FMA, only on x86 builds and CPUs supporting it
+	};
+
+	// Batch math over arrays, with the kernels chosen once at runtime from what the CPU supports.
+	// Results match glm up to rounding; the arrays must not overlap unless stated otherwise.
+	class MathKernels {
+	public:
+		// result[i] = left[i] * right[i]
+		static void multiply_matrices(const glm::mat4* left, const glm::mat4* right, glm::mat4* result, const size_t count);
+		// result[i] = left * right[i], e.g. view projection * model; result may be right
+		static void multiply_matrices(const glm::mat4& left, const glm::mat4* right, glm::mat4* result, const size_t count);
+		// result[i] = matrix * vectors[i]; result may be vectors
+		static void transform_vectors(const glm::mat4& matrix, const glm::vec4* vectors, glm::vec4* result, const size_t count);
+
+		// translation * mat4_cast(rotation) * scale per transform
+		static void compose_transforms(const TransformArrays& transforms, glm::mat4* result, const size_t count);
+		// the smallest boxes containing the boxes transformed by matrices[i], which have no projection
+		static void transform_aabbs(const glm::mat4* matrices, const AABBArrays& boxes, const AABBOutputArrays& result, const size_t count);
+
+		// plane tests: an object is culled only if it is fully outside one of the planes,
+		// given as xyz - normal pointing inside and w - distance
+		static size_t cull_spheres(const glm::vec4* planes, const size_t planes_count, const SphereArrays& spheres,
+			const size_t first, const size_t last, uint32_t* visible_indices);
+		static size_t cull_aabbs(const glm::vec4* planes, const size_t planes_count, const AABBArrays& boxes,
+			const size_t first, const size_t last, uint32_t* visible_indices);
+
+		static EMathKernelSet get_kernel_set();
+		static const char* get_kernel_set_name();
+		static bool is_supported(const EMathKernelSet kernel_set);
+		// for comparing the sets, false if the CPU or the build doesn't support it
+		static bool set_kernel_set(const EMathKernelSet kernel_set);
+	};
+
+}
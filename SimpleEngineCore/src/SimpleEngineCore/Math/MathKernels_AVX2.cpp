@@ -0,0 +1,287 @@
+#include "MathKernelTable.hpp"
+
+// Built with AVX2 and FMA enabled (see CmakeLists.txt) and only called after the CPU was checked for them,
+// without the flags the set is left out.
+// Includes nothing but intrinsics, so no inline function of a shared header is compiled with them.
+
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+
+#include <immintrin.h>
+
+namespace SimpleEngine {
+
+	namespace {
+
+		// rows to columns within both 128-bit halves: a, b, c, d become the first, second, third and fourth elements of each
+		inline void transpose_avx2(__m256& a, __m256& b, __m256& c, __m256& d) {
+			const __m256 ab_low = _mm256_unpacklo_ps(a, b);
+			const __m256 ab_high = _mm256_unpackhi_ps(a, b);
+			const __m256 cd_low = _mm256_unpacklo_ps(c, d);
+			const __m256 cd_high = _mm256_unpackhi_ps(c, d);
+			a = _mm256_shuffle_ps(ab_low, cd_low, _MM_SHUFFLE(1, 0, 1, 0));
+			b = _mm256_shuffle_ps(ab_low, cd_low, _MM_SHUFFLE(3, 2, 3, 2));
+			c = _mm256_shuffle_ps(ab_high, cd_high, _MM_SHUFFLE(1, 0, 1, 0));
+			d = _mm256_shuffle_ps(ab_high, cd_high, _MM_SHUFFLE(3, 2, 3, 2));
+		}
+
+		inline __m256 abs_avx2(const __m256 value) {
+			return _mm256_andnot_ps(_mm256_set1_ps(-0.f), value);
+		}
+
+		inline size_t write_visible_lanes_avx2(const int visible_mask, const size_t first, uint32_t* visible_indices) {
+			size_t count = 0;
+			for (size_t lane = 0; lane < 8; ++lane) {
+				visible_indices[count] = static_cast<uint32_t>(first + lane);
+				count += (visible_mask >> lane) & 1;
+			}
+			return count;
+		}
+
+		// two columns of the right matrix per register, each multiplied by the left matrix
+		inline __m256 multiply_columns_avx2(const __m256 left_x, const __m256 left_y, const __m256 left_z, const __m256 left_w, const __m256 right) {
+			__m256 value = _mm256_mul_ps(left_x, _mm256_permute_ps(right, _MM_SHUFFLE(0, 0, 0, 0)));
+			value = _mm256_fmadd_ps(left_y, _mm256_permute_ps(right, _MM_SHUFFLE(1, 1, 1, 1)), value);
+			value = _mm256_fmadd_ps(left_z, _mm256_permute_ps(right, _MM_SHUFFLE(2, 2, 2, 2)), value);
+			return _mm256_fmadd_ps(left_w, _mm256_permute_ps(right, _MM_SHUFFLE(3, 3, 3, 3)), value);
+		}
+
+		void multiply_matrices_avx2(const float* left, const size_t left_stride, const float* right, float* result, const size_t count) {
+			for (size_t i = 0; i < count; ++i) {
+				const float* l = left + i * left_stride;
+				const __m256 left_x = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(l));
+				const __m256 left_y = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(l + 4));
+				const __m256 left_z = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(l + 8));
+				const __m256 left_w = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(l + 12));
+
+				const __m256 right_01 = _mm256_loadu_ps(right + i * 16);
+				const __m256 right_23 = _mm256_loadu_ps(right + i * 16 + 8);
+				_mm256_storeu_ps(result + i * 16, multiply_columns_avx2(left_x, left_y, left_z, left_w, right_01));
+				_mm256_storeu_ps(result + i * 16 + 8, multiply_columns_avx2(left_x, left_y, left_z, left_w, right_23));
+			}
+		}
+
+		void transform_vectors_avx2(const float* matrix, const float* vectors, float* result, const size_t count) {
+			const __m256 x = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(matrix));
+			const __m256 y = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(matrix + 4));
+			const __m256 z = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(matrix + 8));
+			const __m256 w = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(matrix + 12));
+			size_t i = 0;
+			for (; i + 2 <= count; i += 2)
+				_mm256_storeu_ps(result + i * 4, multiply_columns_avx2(x, y, z, w, _mm256_loadu_ps(vectors + i * 4)));
+			if (i < count)
+				get_sse2_math_kernels().transform_vectors(matrix, vectors + i * 4, result + i * 4, count - i);
+		}
+
+		void compose_transforms_avx2(const TransformArrays& transforms, float* result, const size_t count) {
+			const __m256 zero = _mm256_setzero_ps();
+			const __m256 one = _mm256_set1_ps(1.f);
+
+			size_t i = 0;
+			for (; i + 8 <= count; i += 8) {
+				const __m256 x = _mm256_loadu_ps(transforms.rotation_x + i);
+				const __m256 y = _mm256_loadu_ps(transforms.rotation_y + i);
+				const __m256 z = _mm256_loadu_ps(transforms.rotation_z + i);
+				const __m256 w = _mm256_loadu_ps(transforms.rotation_w + i);
+				const __m256 x2 = _mm256_add_ps(x, x);
+				const __m256 y2 = _mm256_add_ps(y, y);
+				const __m256 z2 = _mm256_add_ps(z, z);
+				const __m256 xx = _mm256_mul_ps(x, x2);
+				const __m256 yy = _mm256_mul_ps(y, y2);
+				const __m256 zz = _mm256_mul_ps(z, z2);
+				const __m256 xy = _mm256_mul_ps(x, y2);
+				const __m256 xz = _mm256_mul_ps(x, z2);
+				const __m256 yz = _mm256_mul_ps(y, z2);
+				const __m256 wx = _mm256_mul_ps(w, x2);
+				const __m256 wy = _mm256_mul_ps(w, y2);
+				const __m256 wz = _mm256_mul_ps(w, z2);
+
+				const __m256 scale_x = _mm256_loadu_ps(transforms.scale_x + i);
+				const __m256 scale_y = _mm256_loadu_ps(transforms.scale_y + i);
+				const __m256 scale_z = _mm256_loadu_ps(transforms.scale_z + i);
+
+				__m256 columns[4][4] = {
+					{
+						_mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), scale_x),
+						_mm256_mul_ps(_mm256_add_ps(xy, wz), scale_x),
+						_mm256_mul_ps(_mm256_sub_ps(xz, wy), scale_x),
+						zero,
+					},
+					{
+						_mm256_mul_ps(_mm256_sub_ps(xy, wz), scale_y),
+						_mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), scale_y),
+						_mm256_mul_ps(_mm256_add_ps(yz, wx), scale_y),
+						zero,
+					},
+					{
+						_mm256_mul_ps(_mm256_add_ps(xz, wy), scale_z),
+						_mm256_mul_ps(_mm256_sub_ps(yz, wx), scale_z),
+						_mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), scale_z),
+						zero,
+					},
+					{
+						_mm256_loadu_ps(transforms.translation_x + i),
+						_mm256_loadu_ps(transforms.translation_y + i),
+						_mm256_loadu_ps(transforms.translation_z + i),
+						one,
+					},
+				};
+
+				// after the transpose element k holds the column of transform k in its low half and of k + 4 in its high one
+				float* matrices = result + i * 16;
+				for (int column = 0; column < 4; ++column) {
+					__m256* lanes = columns[column];
+					transpose_avx2(lanes[0], lanes[1], lanes[2], lanes[3]);
+					for (int node = 0; node < 4; ++node) {
+						_mm_storeu_ps(matrices + node * 16 + column * 4, _mm256_castps256_ps128(lanes[node]));
+						_mm_storeu_ps(matrices + (node + 4) * 16 + column * 4, _mm256_extractf128_ps(lanes[node], 1));
+					}
+				}
+			}
+
+			if (i < count) {
+				const TransformArrays remainder{
+					transforms.translation_x + i, transforms.translation_y + i, transforms.translation_z + i,
+					transforms.rotation_x + i, transforms.rotation_y + i, transforms.rotation_z + i, transforms.rotation_w + i,
+					transforms.scale_x + i, transforms.scale_y + i, transforms.scale_z + i,
+				};
+				get_sse2_math_kernels().compose_transforms(remainder, result + i * 16, count - i);
+			}
+		}
+
+		void transform_aabbs_avx2(const float* matrices, const AABBArrays& boxes, const AABBOutputArrays& result, const size_t count) {
+			const __m256 sign_mask = _mm256_set1_ps(-0.f);
+			float* centers[3] = { result.center_x, result.center_y, result.center_z };
+			float* extents[3] = { result.extent_x, result.extent_y, result.extent_z };
+
+			size_t i = 0;
+			for (; i + 8 <= count; i += 8) {
+				// element[row] of column c for the eight matrices, the fourth row is not needed
+				__m256 elements[4][4];
+				for (int column = 0; column < 4; ++column) {
+					__m256* lanes = elements[column];
+					for (int matrix = 0; matrix < 4; ++matrix) {
+						const __m128 low = _mm_loadu_ps(matrices + (i + matrix) * 16 + column * 4);
+						const __m128 high = _mm_loadu_ps(matrices + (i + matrix + 4) * 16 + column * 4);
+						lanes[matrix] = _mm256_insertf128_ps(_mm256_castps128_ps256(low), high, 1);
+					}
+					transpose_avx2(lanes[0], lanes[1], lanes[2], lanes[3]);
+				}
+
+				const __m256 center_x = _mm256_loadu_ps(boxes.center_x + i);
+				const __m256 center_y = _mm256_loadu_ps(boxes.center_y + i);
+				const __m256 center_z = _mm256_loadu_ps(boxes.center_z + i);
+				const __m256 extent_x = _mm256_loadu_ps(boxes.extent_x + i);
+				const __m256 extent_y = _mm256_loadu_ps(boxes.extent_y + i);
+				const __m256 extent_z = _mm256_loadu_ps(boxes.extent_z + i);
+				for (int row = 0; row < 3; ++row) {
+					__m256 center = _mm256_fmadd_ps(elements[0][row], center_x, elements[3][row]);
+					center = _mm256_fmadd_ps(elements[1][row], center_y, center);
+					center = _mm256_fmadd_ps(elements[2][row], center_z, center);
+					__m256 extent = _mm256_mul_ps(_mm256_andnot_ps(sign_mask, elements[0][row]), extent_x);
+					extent = _mm256_fmadd_ps(_mm256_andnot_ps(sign_mask, elements[1][row]), extent_y, extent);
+					extent = _mm256_fmadd_ps(_mm256_andnot_ps(sign_mask, elements[2][row]), extent_z, extent);
+					_mm256_storeu_ps(centers[row] + i, center);
+					_mm256_storeu_ps(extents[row] + i, extent);
+				}
+			}
+
+			if (i < count) {
+				const AABBArrays remainder{
+					boxes.center_x + i, boxes.center_y + i, boxes.center_z + i, boxes.extent_x + i, boxes.extent_y + i, boxes.extent_z + i,
+				};
+				const AABBOutputArrays remainder_result{
+					result.center_x + i, result.center_y + i, result.center_z + i, result.extent_x + i, result.extent_y + i, result.extent_z + i,
+				};
+				get_sse2_math_kernels().transform_aabbs(matrices + i * 16, remainder, remainder_result, count - i);
+			}
+		}
+
+		size_t cull_spheres_avx2(const float* planes, const size_t planes_count, const SphereArrays& spheres,
+			const size_t first, const size_t last, uint32_t* visible_indices) {
+			size_t visible_count = 0;
+			size_t i = first;
+			for (; i + 8 <= last; i += 8) {
+				const __m256 x = _mm256_loadu_ps(spheres.center_x + i);
+				const __m256 y = _mm256_loadu_ps(spheres.center_y + i);
+				const __m256 z = _mm256_loadu_ps(spheres.center_z + i);
+				const __m256 negative_radius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(spheres.radius + i));
+
+				__m256 outside = _mm256_setzero_ps();
+				for (size_t plane = 0; plane < planes_count; ++plane) {
+					const float* p = planes + plane * 4;
+					__m256 distance = _mm256_fmadd_ps(x, _mm256_broadcast_ss(p), _mm256_broadcast_ss(p + 3));
+					distance = _mm256_fmadd_ps(y, _mm256_broadcast_ss(p + 1), distance);
+					distance = _mm256_fmadd_ps(z, _mm256_broadcast_ss(p + 2), distance);
+					outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, negative_radius, _CMP_LT_OQ));
+				}
+				visible_count += write_visible_lanes_avx2(~_mm256_movemask_ps(outside) & 0xff, i, visible_indices + visible_count);
+			}
+
+			if (i < last)
+				visible_count += get_sse2_math_kernels().cull_spheres(planes, planes_count, spheres, i, last, visible_indices + visible_count);
+			return visible_count;
+		}
+
+		size_t cull_aabbs_avx2(const float* planes, const size_t planes_count, const AABBArrays& boxes,
+			const size_t first, const size_t last, uint32_t* visible_indices) {
+			size_t visible_count = 0;
+			size_t i = first;
+			for (; i + 8 <= last; i += 8) {
+				const __m256 x = _mm256_loadu_ps(boxes.center_x + i);
+				const __m256 y = _mm256_loadu_ps(boxes.center_y + i);
+				const __m256 z = _mm256_loadu_ps(boxes.center_z + i);
+				const __m256 extent_x = _mm256_loadu_ps(boxes.extent_x + i);
+				const __m256 extent_y = _mm256_loadu_ps(boxes.extent_y + i);
+				const __m256 extent_z = _mm256_loadu_ps(boxes.extent_z + i);
+
+				__m256 outside = _mm256_setzero_ps();
+				for (size_t plane = 0; plane < planes_count; ++plane) {
+					// distance of the box corner farthest along the plane normal
+					const float* p = planes + plane * 4;
+					const __m256 normal_x = _mm256_broadcast_ss(p);
+					const __m256 normal_y = _mm256_broadcast_ss(p + 1);
+					const __m256 normal_z = _mm256_broadcast_ss(p + 2);
+					__m256 distance = _mm256_fmadd_ps(x, normal_x, _mm256_broadcast_ss(p + 3));
+					distance = _mm256_fmadd_ps(y, normal_y, distance);
+					distance = _mm256_fmadd_ps(z, normal_z, distance);
+					distance = _mm256_fmadd_ps(extent_x, abs_avx2(normal_x), distance);
+					distance = _mm256_fmadd_ps(extent_y, abs_avx2(normal_y), distance);
+					distance = _mm256_fmadd_ps(extent_z, abs_avx2(normal_z), distance);
+					outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_LT_OQ));
+				}
+				visible_count += write_visible_lanes_avx2(~_mm256_movemask_ps(outside) & 0xff, i, visible_indices + visible_count);
+			}
+
+			if (i < last)
+				visible_count += get_sse2_math_kernels().cull_aabbs(planes, planes_count, boxes, i, last, visible_indices + visible_count);
+			return visible_count;
+		}
+
+	}
+
+	const MathKernelTable* get_avx2_math_kernels() {
+		static const MathKernelTable kernels{
+			"AVX2",
+			multiply_matrices_avx2,
+			transform_vectors_avx2,
+			compose_transforms_avx2,
+			transform_aabbs_avx2,
+			cull_spheres_avx2,
+			cull_aabbs_avx2,
+		};
+		return &kernels;
+	}
+
+}
+
+#else
+
+namespace SimpleEngine {
+
+	const MathKernelTable* get_avx2_math_kernels() {
+		return nullptr;
+	}
+
+}
+
+#endif
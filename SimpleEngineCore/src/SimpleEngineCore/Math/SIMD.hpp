@@ -0,0 +1,172 @@
+#pragma once
+#include <cstdint>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMPLE_ENGINE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace SimpleEngine {
+
+	// Minimal 4-wide float/int vectors. SSE2 when the target has it, plain arrays otherwise,
+	// so kernels are written once. Comparisons return all-bits masks usable in select().
+	struct Float4;
+	struct Int4;
+
+#ifdef SIMPLE_ENGINE_SSE2
+
+	struct Float4 {
+		__m128 v;
+
+		Float4() = default;
+		Float4(const __m128 value) : v(value) {}
+		explicit Float4(const float value) : v(_mm_set1_ps(value)) {}
+		Float4(const float x, const float y, const float z, const float w) : v(_mm_setr_ps(x, y, z, w)) {}
+
+		static Float4 load(const float* data) { return _mm_loadu_ps(data); }
+		void store(float* data) const { _mm_storeu_ps(data, v); }
+	};
+
+	struct Int4 {
+		__m128i v;
+
+		Int4() = default;
+		Int4(const __m128i value) : v(value) {}
+		explicit Int4(const int32_t value) : v(_mm_set1_epi32(value)) {}
+		Int4(const int32_t x, const int32_t y, const int32_t z, const int32_t w) : v(_mm_setr_epi32(x, y, z, w)) {}
+
+		static Int4 load(const int32_t* data) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data)); }
+		void store(int32_t* data) const { _mm_storeu_si128(reinterpret_cast<__m128i*>(data), v); }
+	};
+
+	inline Float4 operator+(const Float4 a, const Float4 b) { return _mm_add_ps(a.v, b.v); }
+	inline Float4 operator-(const Float4 a, const Float4 b) { return _mm_sub_ps(a.v, b.v); }
+	inline Float4 operator*(const Float4 a, const Float4 b) { return _mm_mul_ps(a.v, b.v); }
+	inline Float4 operator/(const Float4 a, const Float4 b) { return _mm_div_ps(a.v, b.v); }
+	inline Float4 operator&(const Float4 a, const Float4 b) { return _mm_and_ps(a.v, b.v); }
+	inline Float4 operator|(const Float4 a, const Float4 b) { return _mm_or_ps(a.v, b.v); }
+	inline Float4 operator<(const Float4 a, const Float4 b) { return _mm_cmplt_ps(a.v, b.v); }
+	inline Float4 operator>(const Float4 a, const Float4 b) { return _mm_cmpgt_ps(a.v, b.v); }
+	inline Float4 operator>=(const Float4 a, const Float4 b) { return _mm_cmpge_ps(a.v, b.v); }
+	inline Float4 min(const Float4 a, const Float4 b) { return _mm_min_ps(a.v, b.v); }
+	inline Float4 max(const Float4 a, const Float4 b) { return _mm_max_ps(a.v, b.v); }
+	inline Float4 select(const Float4 mask, const Float4 a, const Float4 b) { return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)); }
+	inline int move_mask(const Float4 mask) { return _mm_movemask_ps(mask.v); }
+	inline Float4 abs(const Float4 value) { return _mm_andnot_ps(_mm_set1_ps(-0.f), value.v); }
+	// every element set to element Lane of value, without going through memory
+	template<int Lane>
+	inline Float4 broadcast(const Float4 value) { return _mm_shuffle_ps(value.v, value.v, _MM_SHUFFLE(Lane, Lane, Lane, Lane)); }
+
+	// valid for |value| < 2^31
+	inline Float4 floor(const Float4 value) {
+		const __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(value.v));
+		return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmplt_ps(value.v, truncated), _mm_set1_ps(1.f)));
+	}
+
+	inline Int4 operator+(const Int4 a, const Int4 b) { return _mm_add_epi32(a.v, b.v); }
+	inline Int4 operator-(const Int4 a, const Int4 b) { return _mm_sub_epi32(a.v, b.v); }
+	inline Int4 operator^(const Int4 a, const Int4 b) { return _mm_xor_si128(a.v, b.v); }
+	inline Int4 operator&(const Int4 a, const Int4 b) { return _mm_and_si128(a.v, b.v); }
+	inline Int4 operator|(const Int4 a, const Int4 b) { return _mm_or_si128(a.v, b.v); }
+	inline Int4 operator>>(const Int4 a, const int bits) { return _mm_srl_epi32(a.v, _mm_cvtsi32_si128(bits)); }
+	inline Int4 operator<<(const Int4 a, const int bits) { return _mm_sll_epi32(a.v, _mm_cvtsi32_si128(bits)); }
+	inline Int4 operator==(const Int4 a, const Int4 b) { return _mm_cmpeq_epi32(a.v, b.v); }
+	inline Int4 operator>(const Int4 a, const Int4 b) { return _mm_cmpgt_epi32(a.v, b.v); }
+	inline Int4 select(const Int4 mask, const Int4 a, const Int4 b) { return _mm_or_si128(_mm_and_si128(mask.v, a.v), _mm_andnot_si128(mask.v, b.v)); }
+	inline Int4 operator*(const Int4 a, const Int4 b) {
+		// SSE2 has no 32-bit low multiply, combine two 32x32->64 products
+		const __m128i even = _mm_mul_epu32(a.v, b.v);
+		const __m128i odd = _mm_mul_epu32(_mm_srli_si128(a.v, 4), _mm_srli_si128(b.v, 4));
+		return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+	}
+
+	// rows to columns: a, b, c, d become the first, second, third and fourth elements of each
+	inline void transpose(Float4& a, Float4& b, Float4& c, Float4& d) { _MM_TRANSPOSE4_PS(a.v, b.v, c.v, d.v); }
+
+	inline Int4 to_int4(const Float4 value) { return _mm_cvttps_epi32(value.v); }
+	inline Float4 to_float4(const Int4 value) { return _mm_cvtepi32_ps(value.v); }
+	inline Float4 as_float4(const Int4 value) { return _mm_castsi128_ps(value.v); }
+	inline Int4 as_int4(const Float4 value) { return _mm_castps_si128(value.v); }
+
+#else
+
+	struct Float4 {
+		float v[4];
+
+		Float4() = default;
+		explicit Float4(const float value) : v{ value, value, value, value } {}
+		Float4(const float x, const float y, const float z, const float w) : v{ x, y, z, w } {}
+
+		static Float4 load(const float* data) { return { data[0], data[1], data[2], data[3] }; }
+		void store(float* data) const { for (int i = 0; i < 4; ++i) data[i] = v[i]; }
+	};
+
+	struct Int4 {
+		int32_t v[4];
+
+		Int4() = default;
+		explicit Int4(const int32_t value) : v{ value, value, value, value } {}
+		Int4(const int32_t x, const int32_t y, const int32_t z, const int32_t w) : v{ x, y, z, w } {}
+
+		static Int4 load(const int32_t* data) { return { data[0], data[1], data[2], data[3] }; }
+		void store(int32_t* data) const { for (int i = 0; i < 4; ++i) data[i] = v[i]; }
+	};
+
+	inline uint32_t float_bits(const float value) { uint32_t bits; std::memcpy(&bits, &value, 4); return bits; }
+	inline float bits_float(const uint32_t bits) { float value; std::memcpy(&value, &bits, 4); return value; }
+	inline float mask_float(const bool condition) { return bits_float(condition ? ~0u : 0u); }
+
+#define SIMPLE_ENGINE_FLOAT4_OP(expression) Float4 r; for (int i = 0; i < 4; ++i) r.v[i] = (expression); return r;
+#define SIMPLE_ENGINE_INT4_OP(expression) Int4 r; for (int i = 0; i < 4; ++i) r.v[i] = (expression); return r;
+
+	inline Float4 operator+(const Float4 a, const Float4 b) { SIMPLE_ENGINE_FLOAT4_OP(a.v[i] + b.v[i]) }
+	inline Float4 operator-(const Float4 a, const Float4 b) { SIMPLE_ENGINE_FLOAT4_OP(a.v[i] - b.v[i]) }
+	inline Float4 operator*(const Float4 a, const Float4 b) { SIMPLE_ENGINE_FLOAT4_OP(a.v[i] * b.v[i]) }
+	inline Float4 operator/(const Float4 a, const Float4 b) { SIMPLE_ENGINE_FLOAT4_OP(a.v[i] / b.v[i]) }
+	inline Float4 operator&(const Float4 a, const Float4 b) { SIMPLE_ENGINE_FLOAT4_OP(bits_float(float_bits(a.v[i]) & float_bits(b.v[i]))) }
+	inline Float4 operator|(const Float4 a, const Float4 b) { SIMPLE_ENGINE_FLOAT4_OP(bits_float(float_bits(a.v[i]) | float_bits(b.v[i]))) }
+	inline Float4 operator<(const Float4 a, const Float4 b) { SIMPLE_ENGINE_FLOAT4_OP(mask_float(a.v[i] < b.v[i])) }
+	inline Float4 operator>(const Float4 a, const Float4 b) { SIMPLE_ENGINE_FLOAT4_OP(mask_float(a.v[i] > b.v[i])) }
+	inline Float4 operator>=(const Float4 a, const Float4 b) { SIMPLE_ENGINE_FLOAT4_OP(mask_float(a.v[i] >= b.v[i])) }
+	inline Float4 min(const Float4 a, const Float4 b) { SIMPLE_ENGINE_FLOAT4_OP(a.v[i] < b.v[i] ? a.v[i] : b.v[i]) }
+	inline Float4 max(const Float4 a, const Float4 b) { SIMPLE_ENGINE_FLOAT4_OP(a.v[i] > b.v[i] ? a.v[i] : b.v[i]) }
+	inline Float4 select(const Float4 mask, const Float4 a, const Float4 b) { SIMPLE_ENGINE_FLOAT4_OP(float_bits(mask.v[i]) ? a.v[i] : b.v[i]) }
+	inline int move_mask(const Float4 mask) { int m = 0; for (int i = 0; i < 4; ++i) m |= (float_bits(mask.v[i]) >> 31) << i; return m; }
+	inline Float4 abs(const Float4 value) { SIMPLE_ENGINE_FLOAT4_OP(std::fabs(value.v[i])) }
+	inline Float4 floor(const Float4 value) { SIMPLE_ENGINE_FLOAT4_OP(std::floor(value.v[i])) }
+	template<int Lane>
+	inline Float4 broadcast(const Float4 value) { return Float4(value.v[Lane]); }
+
+	inline Int4 operator+(const Int4 a, const Int4 b) { SIMPLE_ENGINE_INT4_OP(int32_t(uint32_t(a.v[i]) + uint32_t(b.v[i]))) }
+	inline Int4 operator-(const Int4 a, const Int4 b) { SIMPLE_ENGINE_INT4_OP(int32_t(uint32_t(a.v[i]) - uint32_t(b.v[i]))) }
+	inline Int4 operator^(const Int4 a, const Int4 b) { SIMPLE_ENGINE_INT4_OP(a.v[i] ^ b.v[i]) }
+	inline Int4 operator&(const Int4 a, const Int4 b) { SIMPLE_ENGINE_INT4_OP(a.v[i] & b.v[i]) }
+	inline Int4 operator|(const Int4 a, const Int4 b) { SIMPLE_ENGINE_INT4_OP(a.v[i] | b.v[i]) }
+	inline Int4 operator>>(const Int4 a, const int bits) { SIMPLE_ENGINE_INT4_OP(int32_t(uint32_t(a.v[i]) >> bits)) }
+	inline Int4 operator<<(const Int4 a, const int bits) { SIMPLE_ENGINE_INT4_OP(int32_t(uint32_t(a.v[i]) << bits)) }
+	inline Int4 operator==(const Int4 a, const Int4 b) { SIMPLE_ENGINE_INT4_OP(a.v[i] == b.v[i] ? -1 : 0) }
+	inline Int4 operator>(const Int4 a, const Int4 b) { SIMPLE_ENGINE_INT4_OP(a.v[i] > b.v[i] ? -1 : 0) }
+	inline Int4 select(const Int4 mask, const Int4 a, const Int4 b) { SIMPLE_ENGINE_INT4_OP(mask.v[i] ? a.v[i] : b.v[i]) }
+	inline Int4 operator*(const Int4 a, const Int4 b) { SIMPLE_ENGINE_INT4_OP(int32_t(uint32_t(a.v[i]) * uint32_t(b.v[i]))) }
+
+	inline void transpose(Float4& a, Float4& b, Float4& c, Float4& d) {
+		Float4* rows[4] = { &a, &b, &c, &d };
+		for (int row = 0; row < 4; ++row)
+			for (int column = row + 1; column < 4; ++column)
+				std::swap(rows[row]->v[column], rows[column]->v[row]);
+	}
+
+	inline Int4 to_int4(const Float4 value) { SIMPLE_ENGINE_INT4_OP(int32_t(value.v[i])) }
+	inline Float4 to_float4(const Int4 value) { SIMPLE_ENGINE_FLOAT4_OP(float(value.v[i])) }
+	inline Float4 as_float4(const Int4 value) { SIMPLE_ENGINE_FLOAT4_OP(bits_float(uint32_t(value.v[i]))) }
+	inline Int4 as_int4(const Float4 value) { SIMPLE_ENGINE_INT4_OP(int32_t(float_bits(value.v[i]))) }
+
+#undef SIMPLE_ENGINE_FLOAT4_OP
+#undef SIMPLE_ENGINE_INT4_OP
+
+#endif
+
+}
@@ -1,4 +1,5 @@
 #include "SimpleEngineCore/Modules/UIModule.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/RenderStateCache.hpp"
 
 #include "GLFW/glfw3.h"
 
@@ -6,8 +7,41 @@
 #include "imgui/backends/imgui_impl_opengl3.h"
 #include "imgui/backends/imgui_impl_glfw.h"
 
+#include <vector>
+
 namespace SimpleEngine {
 
+	struct UIDrawData {
+		ImDrawData draw_data;
+		std::vector<ImDrawList*> draw_lists;
+
+		UIDrawData() = default;
+		UIDrawData(const UIDrawData&) = delete;
+		UIDrawData& operator=(const UIDrawData&) = delete;
+
+		~UIDrawData() {
+			for (ImDrawList* draw_list : draw_lists)
+				IM_DELETE(draw_list);
+		}
+	};
+
+	namespace {
+
+		// ImDrawData::CmdLists is a plain array in older ImGui versions and an ImVector in newer ones
+		void set_ui_draw_lists(ImDrawList**& target, std::vector<ImDrawList*>& draw_lists) {
+			target = draw_lists.data();
+		}
+
+		void set_ui_draw_lists(ImVector<ImDrawList*>& target, std::vector<ImDrawList*>& draw_lists) {
+			target.resize(0);
+			for (ImDrawList* draw_list : draw_lists)
+				target.push_back(draw_list);
+		}
+
+		bool s_ui_render_threaded = false;
+
+	}
+
 	void UIModule::on_window_create(GLFWwindow* pWindow) {
 		IMGUI_CHECKVERSION();
 		ImGui::CreateContext();
@@ -27,7 +61,9 @@ namespace SimpleEngine {
 	}
 
 	void UIModule::on_ui_draw_begin() {
-		ImGui_ImplOpenGL3_NewFrame();
+		// it only (re)creates the GL objects, which set_render_threaded has done
+		if (!s_ui_render_threaded)
+			ImGui_ImplOpenGL3_NewFrame();
 		ImGui_ImplGlfw_NewFrame();
 		ImGui::NewFrame();
 	}
@@ -42,6 +78,34 @@ namespace SimpleEngine {
 			ImGui::RenderPlatformWindowsDefault();
 			glfwMakeContextCurrent(backup_current_context);
 		}
+		// the backend sets GL state directly, behind the cache
+		RenderStateCache::invalidate();
+	}
+
+	void UIModule::set_render_threaded(const bool render_threaded) {
+		s_ui_render_threaded = render_threaded;
+		if (render_threaded) {
+			ImGui_ImplOpenGL3_NewFrame();
+			ImGui::GetIO().ConfigFlags &= ~ImGuiConfigFlags_ViewportsEnable;
+		}
+	}
+
+	std::shared_ptr<UIDrawData> UIModule::on_ui_draw_end_deferred() {
+		ImGui::Render();
+		const ImDrawData* source = ImGui::GetDrawData();
+
+		auto copy = std::make_shared<UIDrawData>();
+		copy->draw_data = *source;
+		copy->draw_lists.reserve(source->CmdListsCount);
+		for (int i = 0; i < source->CmdListsCount; ++i)
+			copy->draw_lists.push_back(source->CmdLists[i]->CloneOutput());
+		set_ui_draw_lists(copy->draw_data.CmdLists, copy->draw_lists);
+		return copy;
+	}
+
+	void UIModule::render_draw_data(UIDrawData& draw_data) {
+		ImGui_ImplOpenGL3_RenderDrawData(&draw_data.draw_data);
+		RenderStateCache::invalidate();
 	}
 
     void UIModule::ShowExampleAppDockSpace(bool* p_open) {
@@ -1,9 +1,13 @@
 #pragma once
+#include <memory>
 
 struct GLFWwindow;
 
 namespace SimpleEngine {
 
+	// ImGui draw lists copied out of the frame that built them
+	struct UIDrawData;
+
 	class UIModule {
 	public:
 		static void on_window_create(GLFWwindow* pWindow);
@@ -11,6 +15,15 @@ namespace SimpleEngine {
 		static void on_ui_draw_begin();
 		static void on_ui_draw_end();
 
+		// With a render thread the UI is still built on the main thread, where GLFW lives, and drawn on the render one.
+		// Called with the GL context current, before it moves to the render thread: creates the GL objects of the UI
+		// up front and turns off the multi-viewports, whose platform windows can't be driven from two threads
+		static void set_render_threaded(const bool render_threaded);
+		// instead of on_ui_draw_end: ends the frame and copies its draw lists, as the next frame overwrites them
+		static std::shared_ptr<UIDrawData> on_ui_draw_end_deferred();
+		// render thread
+		static void render_draw_data(UIDrawData& draw_data);
+
 		static void UIModule::ShowExampleAppDockSpace(bool* p_open);
 	};
 }
\ No newline at end of file
@@ -0,0 +1,178 @@
+#include "SimpleEngineCore/Procedural/Noise.hpp"
+#include "SimpleEngineCore/Procedural/ProceduralTexture.hpp"
+#include "SimpleEngineCore/Math/SIMD.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace SimpleEngine {
+
+	namespace {
+
+		using NoiseKernel = Float4(*)(const Float4 x, const Float4 y, const Int4 seed);
+
+		inline Int4 hash_lattice(const Int4 x, const Int4 y, const Int4 seed) {
+			Int4 hash = (x * Int4(0x27d4eb2d)) ^ (y * Int4(0x165667b1)) ^ seed;
+			hash = (hash ^ (hash >> 15)) * Int4(0x2c1b3c6d);
+			return hash ^ (hash >> 12);
+		}
+
+		inline Float4 fade(const Float4 t) {
+			// 6t^5 - 15t^4 + 10t^3
+			return t * t * t * (t * (t * Float4(6.f) - Float4(15.f)) + Float4(10.f));
+		}
+
+		inline Float4 lerp(const Float4 a, const Float4 b, const Float4 t) {
+			return a + (b - a) * t;
+		}
+
+		// dot product with one of the four diagonal gradients picked by the hash
+		inline Float4 gradient(const Int4 hash, const Float4 x, const Float4 y) {
+			const Float4 flip_x = as_float4((hash & Int4(1)) == Int4(1));
+			const Float4 flip_y = as_float4((hash & Int4(2)) == Int4(2));
+			const Float4 zero(0.f);
+			return select(flip_x, zero - x, x) + select(flip_y, zero - y, y);
+		}
+
+		// [0, 1]
+		Float4 value_kernel(const Float4 x, const Float4 y, const Int4 seed) {
+			const Float4 floor_x = floor(x);
+			const Float4 floor_y = floor(y);
+			const Int4 x0 = to_int4(floor_x);
+			const Int4 y0 = to_int4(floor_y);
+			const Int4 x1 = x0 + Int4(1);
+			const Int4 y1 = y0 + Int4(1);
+
+			const Float4 to_unit(1.f / 16777215.f);
+			const Float4 v00 = to_float4(hash_lattice(x0, y0, seed) & Int4(0xffffff)) * to_unit;
+			const Float4 v10 = to_float4(hash_lattice(x1, y0, seed) & Int4(0xffffff)) * to_unit;
+			const Float4 v01 = to_float4(hash_lattice(x0, y1, seed) & Int4(0xffffff)) * to_unit;
+			const Float4 v11 = to_float4(hash_lattice(x1, y1, seed) & Int4(0xffffff)) * to_unit;
+
+			const Float4 u = fade(x - floor_x);
+			const Float4 v = fade(y - floor_y);
+			return lerp(lerp(v00, v10, u), lerp(v01, v11, u), v);
+		}
+
+		// [-1, 1]
+		Float4 perlin_kernel(const Float4 x, const Float4 y, const Int4 seed) {
+			const Float4 floor_x = floor(x);
+			const Float4 floor_y = floor(y);
+			const Int4 x0 = to_int4(floor_x);
+			const Int4 y0 = to_int4(floor_y);
+			const Int4 x1 = x0 + Int4(1);
+			const Int4 y1 = y0 + Int4(1);
+
+			const Float4 fx = x - floor_x;
+			const Float4 fy = y - floor_y;
+			const Float4 one(1.f);
+
+			const Float4 g00 = gradient(hash_lattice(x0, y0, seed), fx, fy);
+			const Float4 g10 = gradient(hash_lattice(x1, y0, seed), fx - one, fy);
+			const Float4 g01 = gradient(hash_lattice(x0, y1, seed), fx, fy - one);
+			const Float4 g11 = gradient(hash_lattice(x1, y1, seed), fx - one, fy - one);
+
+			const Float4 u = fade(fx);
+			const Float4 v = fade(fy);
+			return lerp(lerp(g00, g10, u), lerp(g01, g11, u), v);
+		}
+
+		inline Float4 simplex_corner(const Int4 hash, const Float4 x, const Float4 y) {
+			const Float4 t = Float4(0.5f) - x * x - y * y;
+			const Float4 t2 = t * t;
+			const Float4 contribution = t2 * t2 * gradient(hash, x, y);
+			return select(t < Float4(0.f), Float4(0.f), contribution);
+		}
+
+		// [-1, 1]
+		Float4 simplex_kernel(const Float4 x, const Float4 y, const Int4 seed) {
+			const float F2 = 0.36602540378f; // (sqrt(3) - 1) / 2
+			const float G2 = 0.2113248654f;  // (3 - sqrt(3)) / 6
+
+			const Float4 skew = (x + y) * Float4(F2);
+			const Float4 cell_x = floor(x + skew);
+			const Float4 cell_y = floor(y + skew);
+			const Float4 unskew = (cell_x + cell_y) * Float4(G2);
+
+			const Float4 x0 = x - (cell_x - unskew);
+			const Float4 y0 = y - (cell_y - unskew);
+
+			// lower or upper triangle of the skewed cell
+			const Float4 lower = x0 > y0;
+			const Float4 i1 = select(lower, Float4(1.f), Float4(0.f));
+			const Float4 j1 = select(lower, Float4(0.f), Float4(1.f));
+
+			const Float4 x1 = x0 - i1 + Float4(G2);
+			const Float4 y1 = y0 - j1 + Float4(G2);
+			const Float4 x2 = x0 - Float4(1.f - 2.f * G2);
+			const Float4 y2 = y0 - Float4(1.f - 2.f * G2);
+
+			const Int4 i = to_int4(cell_x);
+			const Int4 j = to_int4(cell_y);
+			const Float4 n0 = simplex_corner(hash_lattice(i, j, seed), x0, y0);
+			const Float4 n1 = simplex_corner(hash_lattice(i + to_int4(i1), j + to_int4(j1), seed), x1, y1);
+			const Float4 n2 = simplex_corner(hash_lattice(i + Int4(1), j + Int4(1), seed), x2, y2);
+
+			const Float4 result = (n0 + n1 + n2) * Float4(70.f);
+			return max(Float4(-1.f), min(Float4(1.f), result));
+		}
+
+		void generate(float* destination, const unsigned int width, const unsigned int height, const NoiseSettings& settings,
+					  const NoiseKernel kernel, const bool is_signed) {
+			const unsigned int octaves = std::max(1u, settings.octaves);
+
+			float amplitudes_sum = 0.f;
+			for (unsigned int octave = 0; octave < octaves; ++octave)
+				amplitudes_sum += std::pow(settings.persistence, static_cast<float>(octave));
+			const float normalization = 1.f / amplitudes_sum;
+
+			ProceduralTexture::parallel_for_rows(height, static_cast<size_t>(width) * octaves * 16,
+				[&](const unsigned int first_row, const unsigned int last_row) {
+					alignas(16) float tail[4];
+					for (unsigned int row = first_row; row < last_row; ++row) {
+						float* output = destination + static_cast<size_t>(width) * row;
+						for (unsigned int column = 0; column < width; column += 4) {
+							const Float4 pixel_x = Float4(static_cast<float>(column)) + Float4(0.f, 1.f, 2.f, 3.f) + Float4(settings.offset_x);
+							const Float4 pixel_y = Float4(static_cast<float>(row) + settings.offset_y);
+
+							Float4 sum(0.f);
+							float frequency = settings.frequency;
+							float amplitude = 1.f;
+							for (unsigned int octave = 0; octave < octaves; ++octave) {
+								const Int4 seed(settings.seed + static_cast<int32_t>(octave) * 1013);
+								sum = sum + kernel(pixel_x * Float4(frequency), pixel_y * Float4(frequency), seed) * Float4(amplitude);
+								frequency *= settings.lacunarity;
+								amplitude *= settings.persistence;
+							}
+
+							Float4 result = sum * Float4(normalization);
+							if (is_signed)
+								result = result * Float4(0.5f) + Float4(0.5f);
+
+							if (column + 4 <= width) {
+								result.store(output + column);
+							}
+							else {
+								result.store(tail);
+								std::copy(tail, tail + (width - column), output + column);
+							}
+						}
+					}
+				});
+		}
+
+	}
+
+	void Noise::value(float* destination, const unsigned int width, const unsigned int height, const NoiseSettings& settings) {
+		generate(destination, width, height, settings, value_kernel, false);
+	}
+
+	void Noise::perlin(float* destination, const unsigned int width, const unsigned int height, const NoiseSettings& settings) {
+		generate(destination, width, height, settings, perlin_kernel, true);
+	}
+
+	void Noise::simplex(float* destination, const unsigned int width, const unsigned int height, const NoiseSettings& settings) {
+		generate(destination, width, height, settings, simplex_kernel, true);
+	}
+
+}
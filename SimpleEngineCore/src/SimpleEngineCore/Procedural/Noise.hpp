@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+
+namespace SimpleEngine {
+
+	struct NoiseSettings {
+		float frequency = 1.f / 64.f;	// lattice cells per pixel
+		unsigned int octaves = 1;		// > 1 sums octaves into fractal noise
+		float lacunarity = 2.f;			// frequency multiplier between octaves
+		float persistence = 0.5f;		// amplitude multiplier between octaves
+		float offset_x = 0.f;
+		float offset_y = 0.f;
+		int32_t seed = 0;
+	};
+
+	// Noise generators writing width * height floats in [0, 1]. Four pixels of a row are evaluated
+	// at once (lattice hashing included, no permutation table), rows are split across threads.
+	class Noise {
+	public:
+		static void value(float* destination, const unsigned int width, const unsigned int height, const NoiseSettings& settings);
+		static void perlin(float* destination, const unsigned int width, const unsigned int height, const NoiseSettings& settings);
+		static void simplex(float* destination, const unsigned int width, const unsigned int height, const NoiseSettings& settings);
+	};
+
+}
@@ -0,0 +1,175 @@
+#include "SimpleEngineCore/Procedural/ProceduralTexture.hpp"
+#include "SimpleEngineCore/Math/SIMD.hpp"
+#include "SimpleEngineCore/Jobs/JobSystem.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace SimpleEngine {
+
+	namespace {
+
+		// 48 bytes hold a whole number of pixels for 1, 2, 3 and 4 channels
+		constexpr size_t s_pattern_size = 48;
+		// below this many bytes per job the scheduling costs more than it saves
+		constexpr size_t s_min_parallel_work = 64 * 1024;
+
+		struct SpanPattern {
+			alignas(16) unsigned char bytes[s_pattern_size];
+
+			SpanPattern(const Color color, const unsigned int channels) {
+				const unsigned char components[4] = { color.r, color.g, color.b, color.a };
+				for (size_t i = 0; i < s_pattern_size; ++i)
+					bytes[i] = components[i % channels];
+			}
+		};
+
+		void fill_span(unsigned char* destination, const size_t pixels_count, const unsigned int channels, const SpanPattern& pattern) {
+			size_t bytes_left = pixels_count * channels;
+#ifdef SIMPLE_ENGINE_SSE2
+			const __m128i pattern_0 = _mm_load_si128(reinterpret_cast<const __m128i*>(pattern.bytes));
+			const __m128i pattern_1 = _mm_load_si128(reinterpret_cast<const __m128i*>(pattern.bytes + 16));
+			const __m128i pattern_2 = _mm_load_si128(reinterpret_cast<const __m128i*>(pattern.bytes + 32));
+			for (; bytes_left >= s_pattern_size; bytes_left -= s_pattern_size, destination += s_pattern_size) {
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(destination), pattern_0);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + 16), pattern_1);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + 32), pattern_2);
+			}
+#else
+			for (; bytes_left >= s_pattern_size; bytes_left -= s_pattern_size, destination += s_pattern_size)
+				std::memcpy(destination, pattern.bytes, s_pattern_size);
+#endif
+			std::memcpy(destination, pattern.bytes, bytes_left);
+		}
+
+		// largest d >= 0 with d * d < value, -1 if value <= 0
+		int64_t max_distance_below(const int64_t value) {
+			if (value <= 0)
+				return -1;
+			int64_t distance = static_cast<int64_t>(std::sqrt(static_cast<double>(value)));
+			while (distance * distance >= value)
+				--distance;
+			while ((distance + 1) * (distance + 1) < value)
+				++distance;
+			return distance;
+		}
+
+	}
+
+	void ProceduralTexture::parallel_for_rows(const unsigned int rows_count, const size_t work_per_row,
+											  const std::function<void(unsigned int first_row, unsigned int last_row)>& function) {
+		const size_t min_rows_per_job = std::max<size_t>(1, s_min_parallel_work / std::max<size_t>(1, work_per_row));
+		JobSystem::parallel_for(rows_count, min_rows_per_job, [&function](const size_t first_row, const size_t last_row) {
+			function(static_cast<unsigned int>(first_row), static_cast<unsigned int>(last_row));
+		});
+	}
+
+	void ProceduralTexture::fill(const ImageView& image, const Color color) {
+		fill_rect(image, 0, 0, image.width, image.height, color);
+	}
+
+	void ProceduralTexture::fill_rect(const ImageView& image, const unsigned int x, const unsigned int y,
+									  const unsigned int width, const unsigned int height, const Color color) {
+		if (x >= image.width || y >= image.height)
+			return;
+		const unsigned int clipped_width = std::min(width, image.width - x);
+		const unsigned int clipped_height = std::min(height, image.height - y);
+		const SpanPattern pattern(color, image.channels);
+
+		parallel_for_rows(clipped_height, clipped_width * image.channels,
+			[&](const unsigned int first_row, const unsigned int last_row) {
+				for (unsigned int row = first_row; row < last_row; ++row) {
+					unsigned char* destination = image.data + (static_cast<size_t>(image.width) * (y + row) + x) * image.channels;
+					fill_span(destination, clipped_width, image.channels, pattern);
+				}
+			});
+	}
+
+	void ProceduralTexture::fill_circle(const ImageView& image, const int center_x, const int center_y,
+										const unsigned int radius, const Color color) {
+		// bounding box clipped to the image
+		const int64_t first_y = std::max<int64_t>(0, static_cast<int64_t>(center_y) - radius);
+		const int64_t last_y = std::min<int64_t>(image.height, static_cast<int64_t>(center_y) + radius + 1);
+		if (first_y >= last_y)
+			return;
+
+		const int64_t radius_squared = static_cast<int64_t>(radius) * radius;
+		const SpanPattern pattern(color, image.channels);
+
+		parallel_for_rows(static_cast<unsigned int>(last_y - first_y), static_cast<size_t>(radius) * 2 * image.channels,
+			[&](const unsigned int first_row, const unsigned int last_row) {
+				for (int64_t y = first_y + first_row; y < first_y + last_row; ++y) {
+					const int64_t dy = y - center_y;
+					// the distance test of the whole row reduces to the half-width of its span
+					const int64_t half_width = max_distance_below(radius_squared - dy * dy);
+					if (half_width < 0)
+						continue;
+
+					const int64_t first_x = std::max<int64_t>(0, center_x - half_width);
+					const int64_t last_x = std::min<int64_t>(image.width, center_x + half_width + 1);
+					if (first_x >= last_x)
+						continue;
+
+					unsigned char* destination = image.data + (static_cast<size_t>(image.width) * y + first_x) * image.channels;
+					fill_span(destination, static_cast<size_t>(last_x - first_x), image.channels, pattern);
+				}
+			});
+	}
+
+	void ProceduralTexture::fill_checkerboard(const ImageView& image, const unsigned int cell_width, const unsigned int cell_height,
+											  const Color first, const Color second) {
+		if (cell_width == 0 || cell_height == 0)
+			return;
+		const SpanPattern patterns[2] = { SpanPattern(first, image.channels), SpanPattern(second, image.channels) };
+
+		parallel_for_rows(image.height, image.width * image.channels,
+			[&](const unsigned int first_row, const unsigned int last_row) {
+				for (unsigned int y = first_row; y < last_row; ++y) {
+					unsigned char* row = image.data + static_cast<size_t>(image.width) * y * image.channels;
+					const unsigned int row_parity = (y / cell_height) & 1;
+					for (unsigned int x = 0; x < image.width; x += cell_width) {
+						const unsigned int span = std::min(cell_width, image.width - x);
+						fill_span(row + static_cast<size_t>(x) * image.channels, span, image.channels,
+							patterns[row_parity ^ ((x / cell_width) & 1)]);
+					}
+				}
+			});
+	}
+
+	void ProceduralTexture::write_grayscale(const ImageView& image, const float* values) {
+		const unsigned int color_channels = image.channels == 4 ? 3 : (image.channels == 2 ? 1 : image.channels);
+
+		parallel_for_rows(image.height, image.width * image.channels,
+			[&](const unsigned int first_row, const unsigned int last_row) {
+				std::vector<unsigned char> bytes(image.width + 16);
+				for (unsigned int y = first_row; y < last_row; ++y) {
+					const float* source = values + static_cast<size_t>(image.width) * y;
+					unsigned int x = 0;
+#ifdef SIMPLE_ENGINE_SSE2
+					const __m128 scale = _mm_set1_ps(255.f);
+					const __m128 zero = _mm_setzero_ps();
+					const __m128 one = _mm_set1_ps(1.f);
+					for (; x + 16 <= image.width; x += 16) {
+						__m128i quarters[4];
+						for (int i = 0; i < 4; ++i) {
+							const __m128 value = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(source + x + i * 4), zero), one);
+							quarters[i] = _mm_cvtps_epi32(_mm_mul_ps(value, scale));
+						}
+						const __m128i halves_0 = _mm_packs_epi32(quarters[0], quarters[1]);
+						const __m128i halves_1 = _mm_packs_epi32(quarters[2], quarters[3]);
+						_mm_storeu_si128(reinterpret_cast<__m128i*>(bytes.data() + x), _mm_packus_epi16(halves_0, halves_1));
+					}
+#endif
+					for (; x < image.width; ++x)
+						bytes[x] = static_cast<unsigned char>(std::clamp(source[x], 0.f, 1.f) * 255.f + 0.5f);
+
+					unsigned char* row = image.data + static_cast<size_t>(image.width) * y * image.channels;
+					for (x = 0; x < image.width; ++x)
+						for (unsigned int channel = 0; channel < color_channels; ++channel)
+							row[x * image.channels + channel] = bytes[x];
+				}
+			});
+	}
+
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace SimpleEngine {
+
+	// tightly packed 8-bit image, channels 1..4
+	struct ImageView {
+		unsigned char* data;
+		unsigned int width;
+		unsigned int height;
+		unsigned int channels;
+	};
+
+	struct Color {
+		unsigned char r = 0;
+		unsigned char g = 0;
+		unsigned char b = 0;
+		unsigned char a = 255;
+	};
+
+	// Shape rasterizers touch only the rows and columns the shape covers: each row of a shape
+	// is reduced to a span and filled with 16-byte stores; large shapes split their rows into jobs.
+	class ProceduralTexture {
+	public:
+		static void fill(const ImageView& image, const Color color);
+		static void fill_rect(const ImageView& image, const unsigned int x, const unsigned int y,
+							  const unsigned int width, const unsigned int height, const Color color);
+		// pixels with (x - center_x)^2 + (y - center_y)^2 < radius^2
+		static void fill_circle(const ImageView& image, const int center_x, const int center_y,
+								const unsigned int radius, const Color color);
+		static void fill_checkerboard(const ImageView& image, const unsigned int cell_width, const unsigned int cell_height,
+									  const Color first, const Color second);
+
+		// values in [0, 1] -> every channel of the pixel (alpha stays untouched if present)
+		static void write_grayscale(const ImageView& image, const float* values);
+
+		// splits [0, rows_count) into JobSystem jobs when it pays off
+		static void parallel_for_rows(const unsigned int rows_count, const size_t work_per_row,
+									  const std::function<void(unsigned int first_row, unsigned int last_row)>& function);
+	};
+
+}
@@ -0,0 +1,161 @@
+#include "FrustumCulling.hpp"
+#include "SimpleEngineCore/Math/MathKernels.hpp"
+#include "SimpleEngineCore/Jobs/JobSystem.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace SimpleEngine {
+
+	namespace {
+
+		using CullRange = std::function<void(size_t first, size_t last, std::vector<uint32_t>& visible_indices)>;
+
+		// ranges are culled as jobs and their results concatenated in order, so the indices stay ascending.
+		// cull_range appends to visible_indices, which is reserved for the whole range
+		void cull_in_parallel(const size_t count, std::vector<uint32_t>& visible_indices, const CullRange& cull_range) {
+			visible_indices.clear();
+			const size_t jobs_count = std::min<size_t>(JobSystem::get_threads_count(), count / FrustumCulling::s_min_objects_per_job);
+			if (jobs_count <= 1) {
+				visible_indices.reserve(count);
+				cull_range(0, count, visible_indices);
+				return;
+			}
+
+			const size_t objects_per_job = (count + jobs_count - 1) / jobs_count;
+			std::vector<std::vector<uint32_t>> job_results(jobs_count);
+			JobCounter counter;
+			for (size_t job = 1; job < jobs_count; ++job) {
+				const size_t first = job * objects_per_job;
+				const size_t last = std::min(count, first + objects_per_job);
+				JobSystem::run([&, job, first, last]() {
+					job_results[job].reserve(last - first);
+					cull_range(first, last, job_results[job]);
+				}, &counter);
+			}
+			visible_indices.reserve(count);
+			cull_range(0, std::min(count, objects_per_job), visible_indices);
+			JobSystem::wait(counter);
+			for (size_t job = 1; job < jobs_count; ++job)
+				visible_indices.insert(visible_indices.end(), job_results[job].begin(), job_results[job].end());
+		}
+
+	}
+
+	Frustum Frustum::from_view_projection(const glm::mat4& view_projection) {
+		// glm is column major: row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+		const glm::vec4 row_x(view_projection[0][0], view_projection[1][0], view_projection[2][0], view_projection[3][0]);
+		const glm::vec4 row_y(view_projection[0][1], view_projection[1][1], view_projection[2][1], view_projection[3][1]);
+		const glm::vec4 row_z(view_projection[0][2], view_projection[1][2], view_projection[2][2], view_projection[3][2]);
+		const glm::vec4 row_w(view_projection[0][3], view_projection[1][3], view_projection[2][3], view_projection[3][3]);
+
+		Frustum frustum;
+		frustum.planes[Left]	= row_w + row_x;
+		frustum.planes[Right]	= row_w - row_x;
+		frustum.planes[Bottom]	= row_w + row_y;
+		frustum.planes[Top]		= row_w - row_y;
+		frustum.planes[Near]	= row_w + row_z;
+		frustum.planes[Far]		= row_w - row_z;
+
+		for (glm::vec4& plane : frustum.planes) {
+			const float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+			if (length > 0.f)
+				plane /= length;
+		}
+		return frustum;
+	}
+
+	void SphereBoundsSoA::push(const glm::vec3& center, const float sphere_radius) {
+		center_x.push_back(center.x);
+		center_y.push_back(center.y);
+		center_z.push_back(center.z);
+		radius.push_back(sphere_radius);
+	}
+
+	void SphereBoundsSoA::clear() {
+		center_x.clear();
+		center_y.clear();
+		center_z.clear();
+		radius.clear();
+	}
+
+	void SphereBoundsSoA::reserve(const size_t count) {
+		center_x.reserve(count);
+		center_y.reserve(count);
+		center_z.reserve(count);
+		radius.reserve(count);
+	}
+
+	void AABBBoundsSoA::push(const glm::vec3& min, const glm::vec3& max) {
+		const glm::vec3 center = (min + max) * 0.5f;
+		const glm::vec3 extent = (max - min) * 0.5f;
+		center_x.push_back(center.x);
+		center_y.push_back(center.y);
+		center_z.push_back(center.z);
+		extent_x.push_back(extent.x);
+		extent_y.push_back(extent.y);
+		extent_z.push_back(extent.z);
+	}
+
+	void AABBBoundsSoA::clear() {
+		center_x.clear();
+		center_y.clear();
+		center_z.clear();
+		extent_x.clear();
+		extent_y.clear();
+		extent_z.clear();
+	}
+
+	void AABBBoundsSoA::reserve(const size_t count) {
+		center_x.reserve(count);
+		center_y.reserve(count);
+		center_z.reserve(count);
+		extent_x.reserve(count);
+		extent_y.reserve(count);
+		extent_z.reserve(count);
+	}
+
+	bool FrustumCulling::is_sphere_visible(const Frustum& frustum, const glm::vec3& center, const float radius) {
+		for (const glm::vec4& plane : frustum.planes) {
+			if (plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w < -radius)
+				return false;
+		}
+		return true;
+	}
+
+	bool FrustumCulling::is_aabb_visible(const Frustum& frustum, const glm::vec3& min, const glm::vec3& max) {
+		const glm::vec3 center = (min + max) * 0.5f;
+		const glm::vec3 extent = (max - min) * 0.5f;
+		for (const glm::vec4& plane : frustum.planes) {
+			// distance of the box corner farthest along the plane normal
+			const float distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w
+				+ std::abs(plane.x) * extent.x + std::abs(plane.y) * extent.y + std::abs(plane.z) * extent.z;
+			if (distance < 0.f)
+				return false;
+		}
+		return true;
+	}
+
+	void FrustumCulling::cull_spheres(const Frustum& frustum, const SphereBoundsSoA& spheres, std::vector<uint32_t>& visible_indices) {
+		const SphereArrays arrays{ spheres.center_x.data(), spheres.center_y.data(), spheres.center_z.data(), spheres.radius.data() };
+		cull_in_parallel(spheres.size(), visible_indices, [&](const size_t first, const size_t last, std::vector<uint32_t>& visible) {
+			const size_t offset = visible.size();
+			visible.resize(offset + last - first);
+			visible.resize(offset + MathKernels::cull_spheres(frustum.planes, Frustum::PlanesCount, arrays, first, last, visible.data() + offset));
+		});
+	}
+
+	void FrustumCulling::cull_aabbs(const Frustum& frustum, const AABBBoundsSoA& boxes, std::vector<uint32_t>& visible_indices) {
+		const AABBArrays arrays{
+			boxes.center_x.data(), boxes.center_y.data(), boxes.center_z.data(),
+			boxes.extent_x.data(), boxes.extent_y.data(), boxes.extent_z.data(),
+		};
+		cull_in_parallel(boxes.size(), visible_indices, [&](const size_t first, const size_t last, std::vector<uint32_t>& visible) {
+			const size_t offset = visible.size();
+			visible.resize(offset + last - first);
+			visible.resize(offset + MathKernels::cull_aabbs(frustum.planes, Frustum::PlanesCount, arrays, first, last, visible.data() + offset));
+		});
+	}
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include "glm/vec3.hpp"
+#include "glm/vec4.hpp"
+#include "glm/mat4x4.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace SimpleEngine {
+
+	struct Frustum {
+		enum EPlane { Left, Right, Bottom, Top, Near, Far, PlanesCount };
+
+		// xyz - normal pointing inside, w - distance; a point p is inside if dot(xyz, p) + w >= 0
+		glm::vec4 planes[PlanesCount];
+
+		// planes of the clip volume of a GL view-projection matrix, in world space
+		static Frustum from_view_projection(const glm::mat4& view_projection);
+	};
+
+	// bounding spheres as structure of arrays, so four or eight of them are tested with one instruction
+	struct SphereBoundsSoA {
+		std::vector<float> center_x;
+		std::vector<float> center_y;
+		std::vector<float> center_z;
+		std::vector<float> radius;
+
+		void push(const glm::vec3& center, const float sphere_radius);
+		void clear();
+		void reserve(const size_t count);
+		size_t size() const { return radius.size(); }
+	};
+
+	// axis aligned boxes as centers and half extents
+	struct AABBBoundsSoA {
+		std::vector<float> center_x;
+		std::vector<float> center_y;
+		std::vector<float> center_z;
+		std::vector<float> extent_x;
+		std::vector<float> extent_y;
+		std::vector<float> extent_z;
+
+		void push(const glm::vec3& min, const glm::vec3& max);
+		void clear();
+		void reserve(const size_t count);
+		size_t size() const { return extent_x.size(); }
+	};
+
+	// Conservative culling: an object is rejected only if it is fully outside one plane.
+	// visible_indices is overwritten with the ascending indices of the visible objects.
+	// Large sets are split into JobSystem jobs.
+	class FrustumCulling {
+	public:
+		static constexpr size_t s_min_objects_per_job = 16 * 1024;
+
+		static void cull_spheres(const Frustum& frustum, const SphereBoundsSoA& spheres, std::vector<uint32_t>& visible_indices);
+		static void cull_aabbs(const Frustum& frustum, const AABBBoundsSoA& boxes, std::vector<uint32_t>& visible_indices);
+
+		static bool is_sphere_visible(const Frustum& frustum, const glm::vec3& center, const float radius);
+		static bool is_aabb_visible(const Frustum& frustum, const glm::vec3& min, const glm::vec3& max);
+	};
+
+}
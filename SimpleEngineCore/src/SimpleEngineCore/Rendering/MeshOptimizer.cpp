@@ -0,0 +1,405 @@
+#include "MeshOptimizer.hpp"
+#include "SimpleEngineCore/Log.hpp"
+#include "SimpleEngineCore/Resources/Hash.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace SimpleEngine {
+
+	namespace {
+
+		constexpr uint32_t s_invalid_index = ~0u;
+
+		// Forsyth's scoring constants
+		constexpr float s_cache_decay_power = 1.5f;
+		constexpr float s_last_triangle_score = 0.75f;
+		constexpr float s_valence_boost_scale = 2.f;
+		constexpr float s_valence_boost_power = 0.5f;
+		constexpr unsigned int s_max_valence = 64;
+
+		// input copy when the caller optimizes in place
+		const uint32_t* source_indices(const uint32_t* destination, const uint32_t* indices, const size_t indices_count,
+									   std::vector<uint32_t>& copy) {
+			if (destination != indices)
+				return indices;
+			copy.assign(indices, indices + indices_count);
+			return copy.data();
+		}
+
+		float vertex_score(const int cache_position, const unsigned int live_triangles) {
+			if (live_triangles == 0)
+				return -1.f;
+
+			float score = 0.f;
+			if (cache_position >= 0) {
+				if (cache_position < 3) {
+					// the vertices of the last triangle get a fixed score, so its neighbours are not preferred
+					// over the ones sharing an edge with it
+					score = s_last_triangle_score;
+				}
+				else {
+					const float scale = 1.f / (MeshOptimizer::s_cache_size - 3);
+					score = std::pow(1.f - (cache_position - 3) * scale, s_cache_decay_power);
+				}
+			}
+			// vertices with few triangles left are finished first, so they leave the working set
+			score += s_valence_boost_scale * std::pow(static_cast<float>(std::min(live_triangles, s_max_valence)), -s_valence_boost_power);
+			return score;
+		}
+
+		// FIFO cache simulation, returns the number of misses of the triangle
+		unsigned int update_fifo_cache(const uint32_t* triangle, std::vector<uint32_t>& cache_timestamps,
+									   uint32_t& timestamp, const unsigned int cache_size) {
+			unsigned int misses = 0;
+			for (size_t k = 0; k < 3; ++k) {
+				const uint32_t vertex = triangle[k];
+				if (timestamp - cache_timestamps[vertex] > cache_size) {
+					cache_timestamps[vertex] = timestamp++;
+					++misses;
+				}
+			}
+			return misses;
+		}
+
+	}
+
+	size_t MeshOptimizer::generate_vertex_remap(std::vector<uint32_t>& remap, const uint32_t* indices, const size_t indices_count,
+												const void* vertices, const size_t vertices_count, const size_t vertex_size) {
+		remap.assign(vertices_count, s_invalid_index);
+		const unsigned char* bytes = static_cast<const unsigned char*>(vertices);
+
+		// open addressing table of the first vertex of each unique value
+		size_t buckets_count = 1;
+		while (buckets_count < vertices_count + vertices_count / 4)
+			buckets_count *= 2;
+		std::vector<uint32_t> buckets(buckets_count, s_invalid_index);
+
+		size_t unique_count = 0;
+		const size_t count = indices ? indices_count : vertices_count;
+		for (size_t i = 0; i < count; ++i) {
+			const uint32_t vertex = indices ? indices[i] : static_cast<uint32_t>(i);
+			if (vertex >= vertices_count) {
+				LOG_ERROR("MeshOptimizer: index {0} is out of {1} vertices", vertex, vertices_count);
+				continue;
+			}
+			if (remap[vertex] != s_invalid_index)
+				continue;
+
+			const unsigned char* data = bytes + vertex * vertex_size;
+			size_t bucket = hash_fnv1a(data, vertex_size) & (buckets_count - 1);
+			while (buckets[bucket] != s_invalid_index
+				&& std::memcmp(bytes + buckets[bucket] * vertex_size, data, vertex_size) != 0) {
+				bucket = (bucket + 1) & (buckets_count - 1);
+			}
+
+			if (buckets[bucket] == s_invalid_index) {
+				buckets[bucket] = vertex;
+				remap[vertex] = static_cast<uint32_t>(unique_count++);
+			}
+			else {
+				remap[vertex] = remap[buckets[bucket]];
+			}
+		}
+		return unique_count;
+	}
+
+	void MeshOptimizer::remap_vertex_buffer(void* destination, const void* vertices, const size_t vertices_count,
+											const size_t vertex_size, const std::vector<uint32_t>& remap) {
+		unsigned char* destination_bytes = static_cast<unsigned char*>(destination);
+		const unsigned char* source_bytes = static_cast<const unsigned char*>(vertices);
+		for (size_t i = 0; i < vertices_count; ++i) {
+			if (remap[i] != s_invalid_index)
+				std::memcpy(destination_bytes + remap[i] * vertex_size, source_bytes + i * vertex_size, vertex_size);
+		}
+	}
+
+	void MeshOptimizer::remap_index_buffer(uint32_t* destination, const uint32_t* indices, const size_t indices_count,
+										   const std::vector<uint32_t>& remap) {
+		for (size_t i = 0; i < indices_count; ++i)
+			destination[i] = remap[indices[i]];
+	}
+
+	void MeshOptimizer::optimize_vertex_cache(uint32_t* destination, const uint32_t* indices, const size_t indices_count,
+											  const size_t vertices_count) {
+		std::vector<uint32_t> indices_copy;
+		indices = source_indices(destination, indices, indices_count, indices_copy);
+
+		const size_t triangles_count = indices_count / 3;
+		if (triangles_count == 0)
+			return;
+
+		// triangles adjacent to each vertex
+		std::vector<unsigned int> live_triangles(vertices_count, 0);
+		for (size_t i = 0; i < triangles_count * 3; ++i)
+			++live_triangles[indices[i]];
+
+		std::vector<uint32_t> adjacency_offsets(vertices_count + 1, 0);
+		for (size_t v = 0; v < vertices_count; ++v)
+			adjacency_offsets[v + 1] = adjacency_offsets[v] + live_triangles[v];
+
+		std::vector<uint32_t> adjacency(triangles_count * 3);
+		std::vector<uint32_t> adjacency_fill(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+		for (size_t t = 0; t < triangles_count; ++t) {
+			for (size_t k = 0; k < 3; ++k)
+				adjacency[adjacency_fill[indices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+		}
+
+		std::vector<int> cache_positions(vertices_count, -1);
+		std::vector<float> vertex_scores(vertices_count);
+		for (size_t v = 0; v < vertices_count; ++v)
+			vertex_scores[v] = vertex_score(-1, live_triangles[v]);
+
+		std::vector<float> triangle_scores(triangles_count);
+		for (size_t t = 0; t < triangles_count; ++t) {
+			triangle_scores[t] = vertex_scores[indices[t * 3]] + vertex_scores[indices[t * 3 + 1]] + vertex_scores[indices[t * 3 + 2]];
+		}
+
+		std::vector<bool> emitted(triangles_count, false);
+
+		// three extra slots keep the vertices pushed out by the new triangle until they are rescored
+		uint32_t cache[s_cache_size + 3];
+		uint32_t new_cache[s_cache_size + 3];
+		size_t cache_count = 0;
+
+		size_t best_triangle = 0;
+		size_t next_unemitted = 0;
+		for (size_t emitted_count = 0; emitted_count < triangles_count; ++emitted_count) {
+			if (best_triangle == s_invalid_index) {
+				// dead end: nothing in the cache has live triangles left, continue with the next one in input order
+				while (emitted[next_unemitted])
+					++next_unemitted;
+				best_triangle = next_unemitted;
+			}
+
+			const uint32_t* triangle = indices + best_triangle * 3;
+			std::memcpy(destination + emitted_count * 3, triangle, 3 * sizeof(uint32_t));
+			emitted[best_triangle] = true;
+
+			// detach the triangle from its vertices
+			for (size_t k = 0; k < 3; ++k) {
+				const uint32_t vertex = triangle[k];
+				uint32_t* first = adjacency.data() + adjacency_offsets[vertex];
+				uint32_t* last = first + live_triangles[vertex];
+				*std::find(first, last, static_cast<uint32_t>(best_triangle)) = *(last - 1);
+				--live_triangles[vertex];
+			}
+
+			// the triangle goes to the front of the LRU cache
+			size_t new_cache_count = 0;
+			for (size_t k = 0; k < 3; ++k)
+				new_cache[new_cache_count++] = triangle[k];
+			for (size_t i = 0; i < cache_count; ++i) {
+				const uint32_t vertex = cache[i];
+				if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+					new_cache[new_cache_count++] = vertex;
+			}
+
+			for (size_t i = s_cache_size; i < new_cache_count; ++i)
+				cache_positions[new_cache[i]] = -1;
+			new_cache_count = std::min<size_t>(new_cache_count, s_cache_size + 3);
+			std::copy(new_cache, new_cache + new_cache_count, cache);
+			cache_count = std::min<size_t>(new_cache_count, s_cache_size);
+
+			// rescore everything that moved, including the evicted vertices
+			for (size_t i = 0; i < new_cache_count; ++i) {
+				const uint32_t vertex = cache[i];
+				if (i < s_cache_size)
+					cache_positions[vertex] = static_cast<int>(i);
+				const float score = vertex_score(cache_positions[vertex], live_triangles[vertex]);
+				const float delta = score - vertex_scores[vertex];
+				vertex_scores[vertex] = score;
+
+				const uint32_t* first = adjacency.data() + adjacency_offsets[vertex];
+				for (const uint32_t* it = first; it != first + live_triangles[vertex]; ++it)
+					triangle_scores[*it] += delta;
+			}
+
+			// the next triangle is picked among the ones touching the cache
+			best_triangle = s_invalid_index;
+			float best_score = 0.f;
+			for (size_t i = 0; i < cache_count; ++i) {
+				const uint32_t vertex = cache[i];
+				const uint32_t* first = adjacency.data() + adjacency_offsets[vertex];
+				for (const uint32_t* it = first; it != first + live_triangles[vertex]; ++it) {
+					if (triangle_scores[*it] > best_score) {
+						best_score = triangle_scores[*it];
+						best_triangle = *it;
+					}
+				}
+			}
+		}
+	}
+
+	void MeshOptimizer::optimize_overdraw(uint32_t* destination, const uint32_t* indices, const size_t indices_count,
+										  const float* positions, const size_t vertices_count, const size_t vertex_stride,
+										  const float threshold) {
+		std::vector<uint32_t> indices_copy;
+		indices = source_indices(destination, indices, indices_count, indices_copy);
+
+		const size_t triangles_count = indices_count / 3;
+		if (triangles_count == 0)
+			return;
+
+		constexpr unsigned int cache_size = 16;
+		std::vector<uint32_t> cache_timestamps(vertices_count, 0);
+		// timestamps start past the cache size, so every vertex misses at first
+		uint32_t timestamp = cache_size + 1;
+
+		// hard boundaries: triangles missing all three vertices start a new cluster anyway
+		std::vector<uint32_t> hard_clusters;
+		for (size_t t = 0; t < triangles_count; ++t) {
+			if (update_fifo_cache(indices + t * 3, cache_timestamps, timestamp, cache_size) == 3)
+				hard_clusters.push_back(static_cast<uint32_t>(t));
+		}
+		hard_clusters.push_back(static_cast<uint32_t>(triangles_count));
+
+		// soft boundaries: split a cluster where its prefix is as cache efficient as the cluster allows
+		std::vector<uint32_t> clusters;
+		for (size_t c = 0; c + 1 < hard_clusters.size(); ++c) {
+			const uint32_t begin = hard_clusters[c];
+			const uint32_t end = hard_clusters[c + 1];
+
+			timestamp += cache_size + 1;
+			unsigned int cluster_misses = 0;
+			for (uint32_t t = begin; t < end; ++t)
+				cluster_misses += update_fifo_cache(indices + t * 3, cache_timestamps, timestamp, cache_size);
+			const float cluster_threshold = threshold * cluster_misses / (end - begin);
+
+			clusters.push_back(begin);
+			timestamp += cache_size + 1;
+			unsigned int running_misses = 0;
+			unsigned int running_triangles = 0;
+			for (uint32_t t = begin; t < end; ++t) {
+				running_misses += update_fifo_cache(indices + t * 3, cache_timestamps, timestamp, cache_size);
+				++running_triangles;
+				if (static_cast<float>(running_misses) / running_triangles <= cluster_threshold) {
+					clusters.push_back(t + 1);
+					timestamp += cache_size + 1;
+					running_misses = 0;
+					running_triangles = 0;
+				}
+			}
+			// the last split lands exactly on the end of the hard cluster
+			if (clusters.back() == end)
+				clusters.pop_back();
+		}
+		clusters.push_back(static_cast<uint32_t>(triangles_count));
+
+		const unsigned char* position_bytes = reinterpret_cast<const unsigned char*>(positions);
+		auto position = [&](const uint32_t vertex) {
+			return reinterpret_cast<const float*>(position_bytes + vertex * vertex_stride);
+		};
+
+		// area weighted centroids and normals
+		struct Cluster {
+			uint32_t begin;
+			uint32_t end;
+			float centroid[3];
+			float normal[3];
+			float sort_key;
+		};
+		std::vector<Cluster> sorted_clusters(clusters.size() - 1);
+		float mesh_centroid[3] = { 0.f, 0.f, 0.f };
+		float mesh_area = 0.f;
+
+		for (size_t c = 0; c < sorted_clusters.size(); ++c) {
+			Cluster& cluster = sorted_clusters[c];
+			cluster = { clusters[c], clusters[c + 1], { 0.f, 0.f, 0.f }, { 0.f, 0.f, 0.f }, 0.f };
+
+			float cluster_area = 0.f;
+			for (uint32_t t = cluster.begin; t < cluster.end; ++t) {
+				const float* p0 = position(indices[t * 3]);
+				const float* p1 = position(indices[t * 3 + 1]);
+				const float* p2 = position(indices[t * 3 + 2]);
+				const float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+				const float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+				const float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+				const float area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+				for (size_t k = 0; k < 3; ++k) {
+					cluster.centroid[k] += (p0[k] + p1[k] + p2[k]) * (area / 3.f);
+					cluster.normal[k] += n[k];
+				}
+				cluster_area += area;
+			}
+
+			for (size_t k = 0; k < 3; ++k)
+				mesh_centroid[k] += cluster.centroid[k];
+			mesh_area += cluster_area;
+
+			const float inverse_area = cluster_area > 0.f ? 1.f / cluster_area : 0.f;
+			const float normal_length = std::sqrt(cluster.normal[0] * cluster.normal[0] + cluster.normal[1] * cluster.normal[1] + cluster.normal[2] * cluster.normal[2]);
+			const float inverse_normal_length = normal_length > 0.f ? 1.f / normal_length : 0.f;
+			for (size_t k = 0; k < 3; ++k) {
+				cluster.centroid[k] *= inverse_area;
+				cluster.normal[k] *= inverse_normal_length;
+			}
+		}
+
+		const float inverse_mesh_area = mesh_area > 0.f ? 1.f / mesh_area : 0.f;
+		for (float& coordinate : mesh_centroid)
+			coordinate *= inverse_mesh_area;
+
+		// clusters facing away from the center are likely to occlude the rest from most view directions
+		for (Cluster& cluster : sorted_clusters) {
+			cluster.sort_key = 0.f;
+			for (size_t k = 0; k < 3; ++k)
+				cluster.sort_key += (cluster.centroid[k] - mesh_centroid[k]) * cluster.normal[k];
+		}
+		std::stable_sort(sorted_clusters.begin(), sorted_clusters.end(), [](const Cluster& a, const Cluster& b) {
+			return a.sort_key > b.sort_key;
+		});
+
+		uint32_t* output = destination;
+		for (const Cluster& cluster : sorted_clusters) {
+			const size_t cluster_indices_count = (cluster.end - cluster.begin) * 3;
+			std::memcpy(output, indices + cluster.begin * 3, cluster_indices_count * sizeof(uint32_t));
+			output += cluster_indices_count;
+		}
+	}
+
+	size_t MeshOptimizer::optimize_vertex_fetch(void* destination, uint32_t* indices, const size_t indices_count,
+												const void* vertices, const size_t vertices_count, const size_t vertex_size) {
+		std::vector<uint32_t> remap(vertices_count, s_invalid_index);
+		uint32_t next_vertex = 0;
+		for (size_t i = 0; i < indices_count; ++i) {
+			uint32_t& new_vertex = remap[indices[i]];
+			if (new_vertex == s_invalid_index)
+				new_vertex = next_vertex++;
+			indices[i] = new_vertex;
+		}
+
+		remap_vertex_buffer(destination, vertices, vertices_count, vertex_size, remap);
+		return next_vertex;
+	}
+
+	VertexCacheStats MeshOptimizer::analyze_vertex_cache(const uint32_t* indices, const size_t indices_count,
+														 const size_t vertices_count, const unsigned int cache_size) {
+		VertexCacheStats stats;
+		const size_t triangles_count = indices_count / 3;
+		if (triangles_count == 0)
+			return stats;
+
+		std::vector<uint32_t> cache_timestamps(vertices_count, 0);
+		uint32_t timestamp = cache_size + 1;
+		std::vector<bool> referenced(vertices_count, false);
+		size_t referenced_count = 0;
+		size_t misses = 0;
+		for (size_t t = 0; t < triangles_count; ++t) {
+			misses += update_fifo_cache(indices + t * 3, cache_timestamps, timestamp, cache_size);
+			for (size_t k = 0; k < 3; ++k) {
+				if (!referenced[indices[t * 3 + k]]) {
+					referenced[indices[t * 3 + k]] = true;
+					++referenced_count;
+				}
+			}
+		}
+
+		stats.acmr = static_cast<float>(misses) / triangles_count;
+		stats.atvr = static_cast<float>(misses) / referenced_count;
+		return stats;
+	}
+
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace SimpleEngine {
+
+	struct VertexCacheStats {
+		float acmr = 0.f; // average cache miss ratio, transformed vertices per triangle, 0.5 at best for a grid
+		float atvr = 0.f; // average transformed to vertex ratio, 1.0 at best
+	};
+
+	// Triangle list optimizations, all of them work on 32-bit indices and raw interleaved vertices.
+	// Recommended order: deduplicate (generate_vertex_remap + remap_*), optimize_vertex_cache,
+	// optimize_overdraw, optimize_vertex_fetch; then IndexBuffer picks the narrowest index type.
+	// Used offline by the asset cooker, cheap enough to run at load time for procedural meshes.
+	class MeshOptimizer {
+	public:
+		static constexpr unsigned int s_cache_size = 32;
+
+		// remap[old vertex] = new vertex, binary equal vertices share one; returns unique vertices count.
+		// indices may be null, then every vertex is treated as referenced
+		static size_t generate_vertex_remap(std::vector<uint32_t>& remap, const uint32_t* indices, const size_t indices_count,
+											const void* vertices, const size_t vertices_count, const size_t vertex_size);
+		static void remap_vertex_buffer(void* destination, const void* vertices, const size_t vertices_count,
+										const size_t vertex_size, const std::vector<uint32_t>& remap);
+		static void remap_index_buffer(uint32_t* destination, const uint32_t* indices, const size_t indices_count,
+									   const std::vector<uint32_t>& remap);
+
+		// reorders triangles for the post-transform cache (Forsyth's linear-speed algorithm)
+		static void optimize_vertex_cache(uint32_t* destination, const uint32_t* indices, const size_t indices_count,
+										  const size_t vertices_count);
+		// reorders cache-friendly clusters of triangles outside-in, so the front faces tend to be drawn first;
+		// threshold - allowed ACMR growth of a cluster, 1.05 keeps the vertex cache efficiency within 5%.
+		// positions - the first three floats of each vertex, vertex_stride in bytes
+		static void optimize_overdraw(uint32_t* destination, const uint32_t* indices, const size_t indices_count,
+									  const float* positions, const size_t vertices_count, const size_t vertex_stride,
+									  const float threshold = 1.05f);
+		// reorders vertices by first use and rewrites indices in place, unused vertices are dropped;
+		// returns the new vertices count
+		static size_t optimize_vertex_fetch(void* destination, uint32_t* indices, const size_t indices_count,
+											const void* vertices, const size_t vertices_count, const size_t vertex_size);
+
+		// simulates a FIFO cache of cache_size entries
+		static VertexCacheStats analyze_vertex_cache(const uint32_t* indices, const size_t indices_count,
+													 const size_t vertices_count, const unsigned int cache_size = 16);
+	};
+
+}
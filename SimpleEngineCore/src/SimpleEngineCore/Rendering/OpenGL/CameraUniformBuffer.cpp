@@ -0,0 +1,69 @@
+#include "CameraUniformBuffer.hpp"
+#include "RenderStateCache.hpp"
+#include "SimpleEngineCore/Camera.hpp"
+#include "SimpleEngineCore/Log.hpp"
+#include "glad/glad.h"
+
+#include <cstring>
+
+namespace SimpleEngine {
+
+	static_assert(sizeof(CameraUniformBuffer::BlockData) == 3 * 64 + 16, "BlockData has to match the std140 layout of CameraBlock");
+
+	CameraUniformBuffer::CameraUniformBuffer()
+		: m_staging_buffer(sizeof(BlockData))
+	{
+		glCreateBuffers(1, &m_id);
+		glNamedBufferStorage(m_id, sizeof(BlockData), nullptr, 0);
+	}
+
+	CameraUniformBuffer::~CameraUniformBuffer() {
+		RenderStateCache::forget_buffer(m_id);
+		glDeleteBuffers(1, &m_id);
+	}
+
+	void CameraUniformBuffer::publish(Camera& camera) {
+		// the matrices are only gathered when they are going to be uploaded
+		if (needs_upload(&camera, camera.get_version()))
+			upload(capture(camera));
+		RenderStateCache::bind_buffer_base(GL_UNIFORM_BUFFER, s_binding, m_id);
+	}
+
+	void CameraUniformBuffer::publish(const Snapshot& snapshot) {
+		if (needs_upload(snapshot.camera, snapshot.version))
+			upload(snapshot);
+		RenderStateCache::bind_buffer_base(GL_UNIFORM_BUFFER, s_binding, m_id);
+	}
+
+	CameraUniformBuffer::Snapshot CameraUniformBuffer::capture(Camera& camera) {
+		Snapshot snapshot;
+		snapshot.data.view_matrix = camera.get_view_matrix();
+		snapshot.data.projection_matrix = camera.get_projection_matrix();
+		snapshot.data.view_projection_matrix = camera.get_view_projection_matrix();
+		snapshot.data.camera_position = glm::vec4(camera.get_position(), 1.f);
+		snapshot.camera = &camera;
+		snapshot.version = camera.get_version();
+		return snapshot;
+	}
+
+	bool CameraUniformBuffer::needs_upload(const Camera* camera, const uint64_t version) const {
+		return m_published_camera != camera || m_published_version != version || m_uploads_count == 0;
+	}
+
+	void CameraUniformBuffer::upload(const Snapshot& snapshot) {
+		m_staging_buffer.begin_frame();
+		const StreamingBuffer::Allocation allocation = m_staging_buffer.allocate(sizeof(BlockData));
+		if (!allocation.is_valid()) {
+			LOG_ERROR("CameraUniformBuffer: failed to allocate the camera block");
+			return;
+		}
+		std::memcpy(allocation.data, &snapshot.data, sizeof(BlockData));
+		glCopyNamedBufferSubData(m_staging_buffer.get_id(), m_id, allocation.offset, 0, sizeof(BlockData));
+		m_staging_buffer.end_frame();
+
+		m_published_camera = snapshot.camera;
+		m_published_version = snapshot.version;
+		++m_uploads_count;
+	}
+
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include "glm/vec4.hpp"
+#include "glm/mat4x4.hpp"
+#include "StreamingBuffer.hpp"
+
+#include <cstdint>
+
+namespace SimpleEngine {
+	class Camera;
+
+	// Camera data shared by every shader through one uniform block:
+	//
+	// layout(std140, binding = 0) uniform CameraBlock {
+	//     mat4 view_matrix;
+	//     mat4 projection_matrix;
+	//     mat4 view_projection_matrix;
+	//     vec4 camera_position;
+	// };
+	//
+	// Changed data is written into a StreamingBuffer and copied into the block on the GPU,
+	// so publishing never waits for draws that still read the previous camera.
+	class CameraUniformBuffer {
+	public:
+		static constexpr unsigned int s_binding = 0;
+
+		// mirrors the std140 layout of CameraBlock
+		struct BlockData {
+			glm::mat4 view_matrix;
+			glm::mat4 projection_matrix;
+			glm::mat4 view_projection_matrix;
+			glm::vec4 camera_position;
+		};
+
+		// the camera as of the moment it was captured, for publishing it from the render thread
+		struct Snapshot {
+			BlockData data;
+			const Camera* camera;
+			uint64_t version;
+		};
+
+		CameraUniformBuffer();
+		~CameraUniformBuffer();
+
+		CameraUniformBuffer(const CameraUniformBuffer&) = delete;
+		CameraUniformBuffer& operator=(const CameraUniformBuffer&) = delete;
+
+		// once per frame: uploads only if the camera changed since the last publish, binds the block
+		void publish(Camera& camera);
+		void publish(const Snapshot& snapshot);
+
+		static Snapshot capture(Camera& camera);
+
+		unsigned int get_id() const { return m_id; }
+		uint64_t get_uploads_count() const { return m_uploads_count; }
+
+	private:
+		bool needs_upload(const Camera* camera, const uint64_t version) const;
+		void upload(const Snapshot& snapshot);
+
+		unsigned int m_id = 0;
+		StreamingBuffer m_staging_buffer;
+		const Camera* m_published_camera = nullptr;
+		uint64_t m_published_version = 0;
+		uint64_t m_uploads_count = 0;
+	};
+
+}
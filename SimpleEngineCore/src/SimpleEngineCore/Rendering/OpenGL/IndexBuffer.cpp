@@ -1,26 +1,76 @@
 #include "IndexBuffer.hpp"
 #include "SimpleEngineCore/Log.hpp"
+#include "RenderStateCache.hpp"
 #include "glad/glad.h"
 
+#include <vector>
 
 namespace SimpleEngine {
 
-	constexpr GLenum usage_to_GLenum(const VertexBuffer::EUsage usage);
+	size_t index_type_size(const EIndexType type) {
+		switch (type) {
+		case EIndexType::UInt16:	return sizeof(GLushort);
+		case EIndexType::UInt32:	return sizeof(GLuint);
+		}
+		LOG_ERROR("index_type_size: unknown EIndexType!");
+		return sizeof(GLuint);
+	}
+
+	unsigned int index_type_to_GLenum(const EIndexType type) {
+		switch (type) {
+		case EIndexType::UInt16:	return GL_UNSIGNED_SHORT;
+		case EIndexType::UInt32:	return GL_UNSIGNED_INT;
+		}
+		LOG_ERROR("index_type_to_GLenum: unknown EIndexType!");
+		return GL_UNSIGNED_INT;
+	}
+
+	EIndexType select_index_type(const size_t vertices_count) {
+		if (vertices_count <= 0x10000)
+			return EIndexType::UInt16;
+		return EIndexType::UInt32;
+	}
+
+	template<typename T>
+	std::vector<T> narrow_indices(const uint32_t* indices, const size_t count) {
+		std::vector<T> narrowed(count);
+		for (size_t i = 0; i < count; ++i)
+			narrowed[i] = static_cast<T>(indices[i]);
+		return narrowed;
+	}
+
+	IndexBuffer::IndexBuffer(const void* data, const size_t count, const EIndexType type, const VertexBuffer::EUsage usage)
+		: m_count(count),
+		  m_type(type)
+	{
+		glCreateBuffers(1, &m_id);
+		glNamedBufferStorage(m_id, count * index_type_size(m_type), data, usage_to_storage_flags(usage));
+	}
 
-	IndexBuffer::IndexBuffer(const void* data, const size_t count, const VertexBuffer::EUsage usage)
-		: m_count(count)
+	IndexBuffer::IndexBuffer(const uint32_t* indices, const size_t count, const size_t vertices_count, const VertexBuffer::EUsage usage)
+		: m_count(count),
+		  m_type(select_index_type(vertices_count))
 	{
-		glGenBuffers(1, &m_id);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(GLuint), data, usage_to_GLenum(usage));
+		glCreateBuffers(1, &m_id);
+		const GLbitfield flags = usage_to_storage_flags(usage);
+		switch (m_type) {
+		case EIndexType::UInt16:
+			glNamedBufferStorage(m_id, count * sizeof(GLushort), narrow_indices<GLushort>(indices, count).data(), flags);
+			break;
+		case EIndexType::UInt32:
+			glNamedBufferStorage(m_id, count * sizeof(GLuint), indices, flags);
+			break;
+		}
 	}
 
 	SimpleEngine::IndexBuffer::~IndexBuffer() {
+		RenderStateCache::forget_buffer(m_id);
 		glDeleteBuffers(1, &m_id);
 	}
 
 	IndexBuffer& IndexBuffer::operator=(IndexBuffer&& indexBuffer) noexcept {
 		m_count = indexBuffer.m_count;
+		m_type = indexBuffer.m_type;
 		indexBuffer.m_count = 0;
 		m_id = indexBuffer.m_id;
 		indexBuffer.m_id = 0;
@@ -28,19 +78,26 @@ namespace SimpleEngine {
 	}
 
 	IndexBuffer::IndexBuffer(IndexBuffer&& indexBuffer) noexcept
-		: m_count(indexBuffer.m_count),
-		  m_id(indexBuffer.m_id)
+		: m_id(indexBuffer.m_id),
+		  m_count(indexBuffer.m_count),
+		  m_type(indexBuffer.m_type)
 	{
 		indexBuffer.m_count = 0;
 		indexBuffer.m_id = 0;
 	}
 
 	void IndexBuffer::bind() const {
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id);
+		RenderStateCache::bind_buffer(GL_ELEMENT_ARRAY_BUFFER, m_id);
 	}
 
 	void IndexBuffer::unbind() {
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		RenderStateCache::bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
+
+	void IndexBuffer::set_data(const void* data, const size_t count, const size_t first_index) {
+		// named update, binding GL_ELEMENT_ARRAY_BUFFER would change the currently bound VAO
+		const size_t index_size = index_type_size(m_type);
+		glNamedBufferSubData(m_id, first_index * index_size, count * index_size, data);
 	}
 
 }
\ No newline at end of file
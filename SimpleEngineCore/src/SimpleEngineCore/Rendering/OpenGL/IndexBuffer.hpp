@@ -3,10 +3,26 @@
 
 namespace SimpleEngine {
 
+	// no 8-bit type: it is not a native index format on many GPUs and gets converted by the driver
+	enum class EIndexType : uint8_t {
+		UInt16,
+		UInt32
+	};
+
+	size_t index_type_size(const EIndexType type);
+	unsigned int index_type_to_GLenum(const EIndexType type);
+	// narrowest type able to address vertices_count vertices
+	EIndexType select_index_type(const size_t vertices_count);
+
 	class IndexBuffer {
 	public:
 
-		IndexBuffer(const void* data, const size_t count, const VertexBuffer::EUsage usage = VertexBuffer::EUsage::Static);
+		// data is count indices of the given type
+		IndexBuffer(const void* data, const size_t count, const EIndexType type = EIndexType::UInt32,
+					const VertexBuffer::EUsage usage = VertexBuffer::EUsage::Static);
+		// picks the index type from the vertex count and narrows the indices into it
+		IndexBuffer(const uint32_t* indices, const size_t count, const size_t vertices_count,
+					const VertexBuffer::EUsage usage = VertexBuffer::EUsage::Static);
 		~IndexBuffer();
 
 		IndexBuffer() = delete;
@@ -17,11 +33,16 @@ namespace SimpleEngine {
 
 		void bind() const;
 		static void unbind();
+		// overwrites count indices of the buffer type starting from first_index, for Dynamic/Stream buffers
+		void set_data(const void* data, const size_t count, const size_t first_index = 0);
 		size_t get_count() const { return m_count; }
+		EIndexType get_type() const { return m_type; }
+		unsigned int get_id() const { return m_id; }
 
 	private:
 		unsigned int m_id = 0;
 		size_t m_count = 0;
+		EIndexType m_type = EIndexType::UInt32;
 	};
 
 }
\ No newline at end of file
@@ -0,0 +1,27 @@
+#include "Mesh.hpp"
+#include "RenderQueue.hpp"
+
+#include <algorithm>
+
+namespace SimpleEngine {
+
+	Mesh::Mesh(const MeshFile& mesh_file)
+		: m_vertex_buffer(mesh_file.get_vertices(), mesh_file.get_vertices_size(), mesh_file.get_layout()),
+		  m_index_buffer(mesh_file.get_indices(), mesh_file.get_indices_count(), mesh_file.get_index_type()),
+		  m_lods(mesh_file.get_header().lods, mesh_file.get_header().lods + mesh_file.get_header().lods_count),
+		  m_bounds(mesh_file.get_header().bounds)
+	{
+		m_vertex_array.add_vertex_buffer(m_vertex_buffer);
+		m_vertex_array.set_index_buffer(m_index_buffer);
+		if (m_lods.empty())
+			m_lods.push_back({ 0, mesh_file.get_indices_count(), 0.f });
+	}
+
+	void Mesh::fill_draw_item(DrawItem& draw_item, const size_t lod) const {
+		const MeshLod& mesh_lod = m_lods[std::min(lod, m_lods.size() - 1)];
+		draw_item.vertex_array = &m_vertex_array;
+		draw_item.first_index = mesh_lod.first_index;
+		draw_item.index_count = mesh_lod.indices_count;
+	}
+
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "VertexBuffer.hpp"
+#include "IndexBuffer.hpp"
+#include "VertexArray.hpp"
+#include "SimpleEngineCore/Resources/MeshFile.hpp"
+
+#include <vector>
+
+namespace SimpleEngine {
+	struct DrawItem;
+
+	// GPU copy of a mesh file: the mapped vertex and index blobs go straight into immutable buffers.
+	// The mesh file may be closed once the mesh is created.
+	class Mesh {
+	public:
+		Mesh(const MeshFile& mesh_file);
+
+		Mesh() = delete;
+		Mesh(const Mesh&) = delete;
+		Mesh& operator=(const Mesh&) = delete;
+		Mesh& operator=(Mesh&&) = default;
+		Mesh(Mesh&&) = default;
+
+		const VertexArray& get_vertex_array() const { return m_vertex_array; }
+		size_t get_lods_count() const { return m_lods.size(); }
+		const MeshLod& get_lod(const size_t lod) const { return m_lods[lod]; }
+		const MeshBounds& get_bounds() const { return m_bounds; }
+
+		// sets the vertex array and the index range of the LOD, clamped to the coarsest one
+		void fill_draw_item(DrawItem& draw_item, const size_t lod = 0) const;
+
+	private:
+		VertexBuffer m_vertex_buffer;
+		IndexBuffer m_index_buffer;
+		VertexArray m_vertex_array;
+		std::vector<MeshLod> m_lods;
+		MeshBounds m_bounds;
+	};
+
+}
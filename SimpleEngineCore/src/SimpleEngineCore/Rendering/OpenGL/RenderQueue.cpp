@@ -0,0 +1,157 @@
+#include "RenderQueue.hpp"
+#include "ShaderProgram.hpp"
+#include "VertexArray.hpp"
+#include "StreamingBuffer.hpp"
+#include "RenderStateCache.hpp"
+#include "SimpleEngineCore/Log.hpp"
+#include "SimpleEngineCore/Resources/Hash.hpp"
+#include "glad/glad.h"
+
+#include <algorithm>
+
+namespace SimpleEngine {
+
+	namespace {
+
+		constexpr uint64_t low_bits_mask(const uint64_t bits) {
+			return (uint64_t(1) << bits) - 1;
+		}
+
+		// textures are compared exactly when batching, the hash only has to keep equal sets adjacent
+		uint64_t hash_textures(const std::array<unsigned int, DrawItem::s_max_textures>& textures) {
+			const uint64_t hash = hash_fnv1a(textures.data(), sizeof(textures));
+			return hash ^ (hash >> 32);
+		}
+
+	}
+
+	RenderQueue::RenderQueue() = default;
+	RenderQueue::~RenderQueue() = default;
+
+	uint64_t RenderQueue::make_sort_key(const DrawItem& item, const ERenderPass pass, const float depth) {
+		const float clamped_depth = std::clamp(depth, 0.f, 1.f);
+		uint64_t quantized_depth = static_cast<uint64_t>(clamped_depth * low_bits_mask(s_depth_bits));
+		if (pass == ERenderPass::Transparent)
+			quantized_depth = low_bits_mask(s_depth_bits) - quantized_depth;
+
+		const uint64_t shader_id = item.shader_program ? item.shader_program->get_id() : 0;
+		const uint64_t vertex_array_id = item.vertex_array ? item.vertex_array->get_id() : 0;
+
+		uint64_t state = shader_id & low_bits_mask(s_shader_bits);
+		state = (state << s_material_bits) | (hash_textures(item.textures) & low_bits_mask(s_material_bits));
+		state = (state << s_vertex_array_bits) | (vertex_array_id & low_bits_mask(s_vertex_array_bits));
+		constexpr uint64_t state_bits = s_shader_bits + s_material_bits + s_vertex_array_bits;
+
+		uint64_t key = static_cast<uint64_t>(pass) & low_bits_mask(s_pass_bits);
+		if (pass == ERenderPass::Transparent) {
+			key = (key << s_depth_bits) | quantized_depth;
+			key = (key << state_bits) | state;
+		}
+		else {
+			key = (key << state_bits) | state;
+			key = (key << s_depth_bits) | quantized_depth;
+		}
+		return key;
+	}
+
+	void RenderQueue::push(const DrawItem& item, const ERenderPass pass, const float depth) {
+		m_items.push_back(item);
+		m_keys.push_back(make_sort_key(item, pass, depth));
+	}
+
+	void RenderQueue::clear() {
+		m_items.clear();
+		m_keys.clear();
+		m_sorted_indices.clear();
+	}
+
+	// LSD radix sort of (key, index) pairs, 16 bits per pass.
+	// Passes where every key has the same digit are skipped, so unused key fields cost nothing.
+	void RenderQueue::sort() {
+		const size_t count = m_keys.size();
+		m_sorted_indices.resize(count);
+		for (uint32_t i = 0; i < count; ++i)
+			m_sorted_indices[i] = i;
+
+		if (count < 2)
+			return;
+
+		// clearing 64k buckets per pass is not worth it for small queues
+		if (count < s_radix_sort_threshold) {
+			std::stable_sort(m_sorted_indices.begin(), m_sorted_indices.end(),
+				[this](const uint32_t a, const uint32_t b) { return m_keys[a] < m_keys[b]; });
+			return;
+		}
+
+		m_sorted_keys.assign(m_keys.begin(), m_keys.end());
+		m_keys_scratch.resize(count);
+		m_indices_scratch.resize(count);
+
+		std::vector<uint64_t>& keys = m_sorted_keys;
+		constexpr size_t radix_bits = 16;
+		constexpr size_t buckets_count = size_t(1) << radix_bits;
+		std::vector<uint32_t>& offsets = m_radix_offsets;
+		offsets.resize(buckets_count);
+
+		for (size_t shift = 0; shift < 64; shift += radix_bits) {
+			std::fill(offsets.begin(), offsets.end(), 0);
+			for (const uint64_t key : keys)
+				++offsets[(key >> shift) & (buckets_count - 1)];
+
+			if (offsets[(keys[0] >> shift) & (buckets_count - 1)] == count)
+				continue;
+
+			uint32_t sum = 0;
+			for (uint32_t& offset : offsets) {
+				const uint32_t bucket_size = offset;
+				offset = sum;
+				sum += bucket_size;
+			}
+
+			for (size_t i = 0; i < count; ++i) {
+				const uint32_t destination = offsets[(keys[i] >> shift) & (buckets_count - 1)]++;
+				m_keys_scratch[destination] = keys[i];
+				m_indices_scratch[destination] = m_sorted_indices[i];
+			}
+			keys.swap(m_keys_scratch);
+			m_sorted_indices.swap(m_indices_scratch);
+		}
+	}
+
+	bool RenderQueue::upload_indirect_commands(size_t& offset) {
+		const size_t size = m_sorted_indices.size() * sizeof(DrawElementsIndirectCommand);
+		if (!m_indirect_commands_buffer || m_indirect_commands_buffer->get_frame_size() < size) {
+			const size_t frame_size = std::max(size * 2, s_min_indirect_buffer_size);
+			m_indirect_commands_buffer = std::make_unique<StreamingBuffer>(frame_size);
+		}
+
+		m_indirect_commands_buffer->begin_frame();
+		const StreamingBuffer::Allocation allocation = m_indirect_commands_buffer->allocate(size, sizeof(DrawElementsIndirectCommand));
+		if (!allocation.is_valid()) {
+			LOG_ERROR("RenderQueue: failed to allocate {0} bytes for indirect commands", size);
+			return false;
+		}
+		// straight into the mapped memory, in order, so write combining sees whole lines
+		DrawElementsIndirectCommand* commands = static_cast<DrawElementsIndirectCommand*>(allocation.data);
+		for (size_t i = 0; i < m_sorted_indices.size(); ++i) {
+			const DrawItem& item = get_sorted_item(i);
+			commands[i] = {
+				item.index_count ? item.index_count : static_cast<unsigned int>(item.vertex_array->get_indeces_count()),
+				item.instance_count,
+				item.first_index,
+				item.base_vertex,
+				item.base_instance
+			};
+		}
+
+		RenderStateCache::bind_buffer(GL_DRAW_INDIRECT_BUFFER, m_indirect_commands_buffer->get_id());
+		offset = allocation.offset;
+		return true;
+	}
+
+	void RenderQueue::end_submission() {
+		if (m_indirect_commands_buffer)
+			m_indirect_commands_buffer->end_frame();
+	}
+
+}
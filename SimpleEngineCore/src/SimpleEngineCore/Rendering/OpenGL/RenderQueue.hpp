@@ -0,0 +1,90 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace SimpleEngine {
+	class ShaderProgram;
+	class VertexArray;
+	class StreamingBuffer;
+
+	enum class ERenderPass : uint8_t {
+		Opaque,			// front to back
+		Transparent,	// back to front
+		UI
+	};
+
+	struct DrawItem {
+		static constexpr size_t s_max_textures = 4;
+
+		const ShaderProgram* shader_program = nullptr;
+		const VertexArray* vertex_array = nullptr;
+		std::array<unsigned int, s_max_textures> textures{}; // bound to units 0..N, 0 - unused
+
+		unsigned int index_count = 0; // 0 - whole index buffer of vertex_array
+		unsigned int first_index = 0;
+		int base_vertex = 0;
+		unsigned int instance_count = 1;
+		unsigned int base_instance = 0;
+	};
+
+	// layout of the command consumed by glMultiDrawElementsIndirect
+	struct DrawElementsIndirectCommand {
+		unsigned int count;
+		unsigned int instance_count;
+		unsigned int first_index;
+		int base_vertex;
+		unsigned int base_instance;
+	};
+
+	class RenderQueue {
+	public:
+		// opaque and UI key:  | pass 4 | shader 12 | material 16 | vertex array 12 | depth 20 |
+		// transparent key:    | pass 4 | inverted depth 20 | shader 12 | material 16 | vertex array 12 |
+		// transparent items are ordered back to front across state changes, the state only breaks depth ties
+		static constexpr uint64_t s_pass_bits = 4;
+		static constexpr uint64_t s_shader_bits = 12;
+		static constexpr uint64_t s_material_bits = 16;
+		static constexpr uint64_t s_vertex_array_bits = 12;
+		static constexpr uint64_t s_depth_bits = 20;
+
+		static constexpr size_t s_radix_sort_threshold = 1024;
+		static constexpr size_t s_min_indirect_buffer_size = 64 * 1024;
+
+		RenderQueue();
+		~RenderQueue();
+
+		RenderQueue(const RenderQueue&) = delete;
+		RenderQueue& operator=(const RenderQueue&) = delete;
+
+		// depth - normalized view depth in [0, 1]
+		void push(const DrawItem& item, const ERenderPass pass = ERenderPass::Opaque, const float depth = 0.f);
+		void clear();
+		void sort();
+
+		static uint64_t make_sort_key(const DrawItem& item, const ERenderPass pass, const float depth);
+
+		size_t get_items_count() const { return m_items.size(); }
+		const DrawItem& get_sorted_item(const size_t i) const { return m_items[m_sorted_indices[i]]; }
+
+		// writes the commands of the sorted items into the streaming buffer, binds it to GL_DRAW_INDIRECT_BUFFER
+		// and reports the offset of the first command in it
+		bool upload_indirect_commands(size_t& offset);
+		// fences the region written by upload_indirect_commands, call after the draws that read it
+		void end_submission();
+
+	private:
+		std::vector<DrawItem> m_items;
+		std::vector<uint64_t> m_keys;
+		std::vector<uint32_t> m_sorted_indices;
+
+		std::vector<uint64_t> m_sorted_keys;
+		std::vector<uint64_t> m_keys_scratch;
+		std::vector<uint32_t> m_indices_scratch;
+		std::vector<uint32_t> m_radix_offsets;
+
+		std::unique_ptr<StreamingBuffer> m_indirect_commands_buffer;
+	};
+
+}
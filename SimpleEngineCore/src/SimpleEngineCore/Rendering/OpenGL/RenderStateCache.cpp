@@ -0,0 +1,277 @@
+#include "RenderStateCache.hpp"
+#include "SimpleEngineCore/Log.hpp"
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <array>
+
+namespace SimpleEngine {
+
+	namespace {
+
+		constexpr unsigned int s_unknown = ~0u;
+		constexpr size_t s_max_texture_units = 32;
+		constexpr size_t s_max_indexed_bindings = 16;
+
+		constexpr GLenum s_buffer_targets[] = {
+			GL_ARRAY_BUFFER,
+			GL_ELEMENT_ARRAY_BUFFER,
+			GL_DRAW_INDIRECT_BUFFER,
+			GL_UNIFORM_BUFFER,
+			GL_SHADER_STORAGE_BUFFER,
+			GL_PIXEL_UNPACK_BUFFER,
+			GL_PIXEL_PACK_BUFFER,
+			GL_COPY_READ_BUFFER,
+			GL_COPY_WRITE_BUFFER
+		};
+		constexpr size_t s_buffer_targets_count = sizeof(s_buffer_targets) / sizeof(s_buffer_targets[0]);
+
+		constexpr GLenum s_indexed_buffer_targets[] = {
+			GL_UNIFORM_BUFFER,
+			GL_SHADER_STORAGE_BUFFER
+		};
+		constexpr size_t s_indexed_buffer_targets_count = sizeof(s_indexed_buffer_targets) / sizeof(s_indexed_buffer_targets[0]);
+
+		struct CachedState {
+			unsigned int program;
+			unsigned int vertex_array;
+			std::array<unsigned int, s_buffer_targets_count> buffers;
+			std::array<std::array<unsigned int, s_max_indexed_bindings>, s_indexed_buffer_targets_count> indexed_buffers;
+			std::array<unsigned int, s_max_texture_units> textures;
+			std::array<unsigned int, s_max_texture_units> samplers;
+
+			unsigned int blend_enabled;
+			unsigned int blend_source_factor;
+			unsigned int blend_destination_factor;
+			unsigned int depth_test_enabled;
+			unsigned int depth_write_enabled;
+			unsigned int depth_func;
+			unsigned int cull_face_enabled;
+			unsigned int cull_face;
+			std::array<int, 4> viewport;
+			std::array<float, 4> clear_color;
+			bool clear_color_known;
+		};
+
+		CachedState s_state;
+		RenderStateCache::Stats s_stats;
+
+		size_t buffer_target_slot(const GLenum target) {
+			return std::find(std::begin(s_buffer_targets), std::end(s_buffer_targets), target) - std::begin(s_buffer_targets);
+		}
+
+		size_t indexed_buffer_target_slot(const GLenum target) {
+			return std::find(std::begin(s_indexed_buffer_targets), std::end(s_indexed_buffer_targets), target) - std::begin(s_indexed_buffer_targets);
+		}
+
+		// true if the driver has to be called
+		template<typename T>
+		bool update_cached(T& cached, const T value) {
+			if (cached == value) {
+				++s_stats.skipped_calls;
+				return false;
+			}
+			cached = value;
+			++s_stats.issued_calls;
+			return true;
+		}
+
+		void set_capability(unsigned int& cached, const GLenum capability, const bool enabled) {
+			if (!update_cached(cached, static_cast<unsigned int>(enabled)))
+				return;
+			if (enabled)
+				glEnable(capability);
+			else
+				glDisable(capability);
+		}
+
+	}
+
+	void RenderStateCache::invalidate() {
+		s_state.program = s_unknown;
+		s_state.vertex_array = s_unknown;
+		s_state.buffers.fill(s_unknown);
+		for (auto& bindings : s_state.indexed_buffers)
+			bindings.fill(s_unknown);
+		s_state.textures.fill(s_unknown);
+		s_state.samplers.fill(s_unknown);
+
+		s_state.blend_enabled = s_unknown;
+		s_state.blend_source_factor = s_unknown;
+		s_state.blend_destination_factor = s_unknown;
+		s_state.depth_test_enabled = s_unknown;
+		s_state.depth_write_enabled = s_unknown;
+		s_state.depth_func = s_unknown;
+		s_state.cull_face_enabled = s_unknown;
+		s_state.cull_face = s_unknown;
+		s_state.viewport.fill(-1);
+		s_state.clear_color_known = false;
+	}
+
+	void RenderStateCache::use_program(const unsigned int program_id) {
+		if (update_cached(s_state.program, program_id))
+			glUseProgram(program_id);
+	}
+
+	void RenderStateCache::bind_vertex_array(const unsigned int vertex_array_id) {
+		if (update_cached(s_state.vertex_array, vertex_array_id)) {
+			glBindVertexArray(vertex_array_id);
+			s_state.buffers[buffer_target_slot(GL_ELEMENT_ARRAY_BUFFER)] = s_unknown;
+		}
+	}
+
+	void RenderStateCache::bind_buffer(const unsigned int target, const unsigned int buffer_id) {
+		const size_t slot = buffer_target_slot(target);
+		if (slot == s_buffer_targets_count) {
+			++s_stats.issued_calls;
+			glBindBuffer(target, buffer_id);
+			return;
+		}
+		if (update_cached(s_state.buffers[slot], buffer_id))
+			glBindBuffer(target, buffer_id);
+	}
+
+	void RenderStateCache::bind_buffer_base(const unsigned int target, const unsigned int index, const unsigned int buffer_id) {
+		// also replaces the generic binding point of the target, tracked only for the targets in s_buffer_targets,
+		// e.g. not for GL_ATOMIC_COUNTER_BUFFER or GL_TRANSFORM_FEEDBACK_BUFFER
+		const size_t buffer_slot = buffer_target_slot(target);
+		const size_t slot = indexed_buffer_target_slot(target);
+		if (slot == s_indexed_buffer_targets_count || index >= s_max_indexed_bindings) {
+			++s_stats.issued_calls;
+			glBindBufferBase(target, index, buffer_id);
+			if (buffer_slot < s_buffer_targets_count)
+				s_state.buffers[buffer_slot] = buffer_id;
+			return;
+		}
+		if (update_cached(s_state.indexed_buffers[slot][index], buffer_id)) {
+			glBindBufferBase(target, index, buffer_id);
+			if (buffer_slot < s_buffer_targets_count)
+				s_state.buffers[buffer_slot] = buffer_id;
+		}
+	}
+
+	void RenderStateCache::bind_texture_unit(const unsigned int unit, const unsigned int texture_id) {
+		if (unit >= s_max_texture_units) {
+			++s_stats.issued_calls;
+			glBindTextureUnit(unit, texture_id);
+			return;
+		}
+		if (update_cached(s_state.textures[unit], texture_id))
+			glBindTextureUnit(unit, texture_id);
+	}
+
+	void RenderStateCache::bind_textures(const unsigned int first_unit, const unsigned int count, const unsigned int* texture_ids) {
+		if (first_unit + count > s_max_texture_units) {
+			++s_stats.issued_calls;
+			glBindTextures(first_unit, count, texture_ids);
+			return;
+		}
+		if (std::equal(texture_ids, texture_ids + count, s_state.textures.begin() + first_unit)) {
+			++s_stats.skipped_calls;
+			return;
+		}
+		std::copy(texture_ids, texture_ids + count, s_state.textures.begin() + first_unit);
+		++s_stats.issued_calls;
+		glBindTextures(first_unit, count, texture_ids);
+	}
+
+	void RenderStateCache::bind_sampler(const unsigned int unit, const unsigned int sampler_id) {
+		if (unit >= s_max_texture_units) {
+			++s_stats.issued_calls;
+			glBindSampler(unit, sampler_id);
+			return;
+		}
+		if (update_cached(s_state.samplers[unit], sampler_id))
+			glBindSampler(unit, sampler_id);
+	}
+
+	void RenderStateCache::set_blend_enabled(const bool enabled) {
+		set_capability(s_state.blend_enabled, GL_BLEND, enabled);
+	}
+
+	void RenderStateCache::set_blend_func(const unsigned int source_factor, const unsigned int destination_factor) {
+		if (s_state.blend_source_factor == source_factor && s_state.blend_destination_factor == destination_factor) {
+			++s_stats.skipped_calls;
+			return;
+		}
+		s_state.blend_source_factor = source_factor;
+		s_state.blend_destination_factor = destination_factor;
+		++s_stats.issued_calls;
+		glBlendFunc(source_factor, destination_factor);
+	}
+
+	void RenderStateCache::set_depth_test_enabled(const bool enabled) {
+		set_capability(s_state.depth_test_enabled, GL_DEPTH_TEST, enabled);
+	}
+
+	void RenderStateCache::set_depth_write_enabled(const bool enabled) {
+		if (update_cached(s_state.depth_write_enabled, static_cast<unsigned int>(enabled)))
+			glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+	}
+
+	void RenderStateCache::set_depth_func(const unsigned int func) {
+		if (update_cached(s_state.depth_func, func))
+			glDepthFunc(func);
+	}
+
+	void RenderStateCache::set_cull_face_enabled(const bool enabled) {
+		set_capability(s_state.cull_face_enabled, GL_CULL_FACE, enabled);
+	}
+
+	void RenderStateCache::set_cull_face(const unsigned int face) {
+		if (update_cached(s_state.cull_face, face))
+			glCullFace(face);
+	}
+
+	void RenderStateCache::set_viewport(const int x, const int y, const int width, const int height) {
+		if (update_cached(s_state.viewport, { x, y, width, height }))
+			glViewport(x, y, width, height);
+	}
+
+	void RenderStateCache::set_clear_color(const float r, const float g, const float b, const float a) {
+		const std::array<float, 4> clear_color{ r, g, b, a };
+		if (s_state.clear_color_known && s_state.clear_color == clear_color) {
+			++s_stats.skipped_calls;
+			return;
+		}
+		s_state.clear_color = clear_color;
+		s_state.clear_color_known = true;
+		++s_stats.issued_calls;
+		glClearColor(r, g, b, a);
+	}
+
+	// a deleted object is unbound by GL, and its name may come back for a new object
+
+	void RenderStateCache::forget_program(const unsigned int program_id) {
+		if (s_state.program == program_id)
+			s_state.program = s_unknown;
+	}
+
+	void RenderStateCache::forget_vertex_array(const unsigned int vertex_array_id) {
+		if (s_state.vertex_array == vertex_array_id)
+			s_state.vertex_array = s_unknown;
+	}
+
+	void RenderStateCache::forget_buffer(const unsigned int buffer_id) {
+		std::replace(s_state.buffers.begin(), s_state.buffers.end(), buffer_id, s_unknown);
+		for (auto& bindings : s_state.indexed_buffers)
+			std::replace(bindings.begin(), bindings.end(), buffer_id, s_unknown);
+	}
+
+	void RenderStateCache::forget_texture(const unsigned int texture_id) {
+		std::replace(s_state.textures.begin(), s_state.textures.end(), texture_id, s_unknown);
+	}
+
+	void RenderStateCache::forget_sampler(const unsigned int sampler_id) {
+		std::replace(s_state.samplers.begin(), s_state.samplers.end(), sampler_id, s_unknown);
+	}
+
+	const RenderStateCache::Stats& RenderStateCache::get_stats() {
+		return s_stats;
+	}
+
+	void RenderStateCache::reset_stats() {
+		s_stats = {};
+	}
+
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+
+namespace SimpleEngine {
+
+	// Shadow copy of the GL context state. Every setter compares against the shadow
+	// and only reaches the driver when the value actually changes.
+	// Objects have to be forgotten when they are deleted: GL reuses names.
+	class RenderStateCache {
+	public:
+		struct Stats {
+			uint64_t issued_calls = 0;
+			uint64_t skipped_calls = 0;
+		};
+
+		// forget everything, the next call of each setter reaches the driver
+		static void invalidate();
+
+		static void use_program(const unsigned int program_id);
+		static void bind_vertex_array(const unsigned int vertex_array_id);
+		// ELEMENT_ARRAY_BUFFER binding is part of the VAO, it is forgotten when the VAO changes
+		static void bind_buffer(const unsigned int target, const unsigned int buffer_id);
+		static void bind_buffer_base(const unsigned int target, const unsigned int index, const unsigned int buffer_id);
+		static void bind_texture_unit(const unsigned int unit, const unsigned int texture_id);
+		static void bind_textures(const unsigned int first_unit, const unsigned int count, const unsigned int* texture_ids);
+		static void bind_sampler(const unsigned int unit, const unsigned int sampler_id);
+
+		static void set_blend_enabled(const bool enabled);
+		static void set_blend_func(const unsigned int source_factor, const unsigned int destination_factor);
+		static void set_depth_test_enabled(const bool enabled);
+		static void set_depth_write_enabled(const bool enabled);
+		static void set_depth_func(const unsigned int func);
+		static void set_cull_face_enabled(const bool enabled);
+		static void set_cull_face(const unsigned int face);
+		static void set_viewport(const int x, const int y, const int width, const int height);
+		static void set_clear_color(const float r, const float g, const float b, const float a);
+
+		static void forget_program(const unsigned int program_id);
+		static void forget_vertex_array(const unsigned int vertex_array_id);
+		static void forget_buffer(const unsigned int buffer_id);
+		static void forget_texture(const unsigned int texture_id);
+		static void forget_sampler(const unsigned int sampler_id);
+
+		static const Stats& get_stats();
+		static void reset_stats();
+	};
+
+}
@@ -1,13 +1,31 @@
 #include "SimpleEngineCore/Rendering/OpenGL/Renderer_OpenGL.hpp"
 #include "SimpleEngineCore/Log.hpp"
 #include "VertexArray.hpp"
+#include "ShaderProgram.hpp"
+#include "RenderQueue.hpp"
+#include "RenderStateCache.hpp"
 
 #include "glad/glad.h"
 #include "GLFW/glfw3.h"
 
+#include <cstring>
+
 namespace SimpleEngine {
 
+	// GL_KHR_parallel_shader_compile and its ARB twin, not part of the core profile loader
+	typedef void (APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+
+	namespace {
+
+		bool s_parallel_shader_compile = false;
+
+		bool have_same_state(const DrawItem& a, const DrawItem& b) {
+			return a.shader_program == b.shader_program
+				&& a.vertex_array == b.vertex_array
+				&& a.textures == b.textures;
+		}
 
+	}
 
 	bool Renderer_OpenGL::init(GLFWwindow* pWindow) {
 		glfwMakeContextCurrent(pWindow);
@@ -22,16 +40,78 @@ namespace SimpleEngine {
 		LOG_INFO("  Renderer: {0}", get_renderer_str());
 		LOG_INFO("  Version: {0}", get_version_str());
 
+		RenderStateCache::invalidate();
+		// texture uploads take tightly packed rows, RGB8 rows are not 4-byte aligned in general
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+		s_parallel_shader_compile = false;
+		PFNGLMAXSHADERCOMPILERTHREADSKHRPROC max_shader_compiler_threads = nullptr;
+		if (has_extension("GL_KHR_parallel_shader_compile"))
+			max_shader_compiler_threads = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)glfwGetProcAddress("glMaxShaderCompilerThreadsKHR");
+		else if (has_extension("GL_ARB_parallel_shader_compile"))
+			max_shader_compiler_threads = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)glfwGetProcAddress("glMaxShaderCompilerThreadsARB");
+		if (max_shader_compiler_threads) {
+			// as many threads as the driver wants
+			max_shader_compiler_threads(0xFFFFFFFF);
+			s_parallel_shader_compile = true;
+		}
+		LOG_INFO("  Parallel shader compile: {0}", s_parallel_shader_compile ? "yes" : "no");
+
 		return true;
 	}
 
 	void Renderer_OpenGL::draw(const VertexArray& vertex_array) {
 		vertex_array.bind();
-		glDrawElements(GL_TRIANGLES, vertex_array.get_indeces_count(), GL_UNSIGNED_INT, nullptr);
+		glDrawElements(GL_TRIANGLES, vertex_array.get_indeces_count(), index_type_to_GLenum(vertex_array.get_index_type()), nullptr);
+	}
+
+	void Renderer_OpenGL::draw_instanced(const VertexArray& vertex_array, const unsigned int instance_count) {
+		vertex_array.bind();
+		glDrawElementsInstanced(GL_TRIANGLES, vertex_array.get_indeces_count(), index_type_to_GLenum(vertex_array.get_index_type()), nullptr, instance_count);
+	}
+
+	void Renderer_OpenGL::draw(RenderQueue& render_queue) {
+		const size_t items_count = render_queue.get_items_count();
+		if (items_count == 0)
+			return;
+
+		render_queue.sort();
+
+		size_t commands_offset = 0;
+		if (!render_queue.upload_indirect_commands(commands_offset))
+			return;
+
+		const DrawItem* current = nullptr;
+		size_t batch_begin = 0;
+		for (size_t i = 0; i <= items_count; ++i) {
+			const DrawItem* item = i < items_count ? &render_queue.get_sorted_item(i) : nullptr;
+			if (item && current && have_same_state(*current, *item))
+				continue;
+
+			if (current) {
+				// batches never span vertex arrays, so the whole batch shares one index type
+				glMultiDrawElementsIndirect(GL_TRIANGLES, index_type_to_GLenum(current->vertex_array->get_index_type()),
+					reinterpret_cast<const void*>(commands_offset + batch_begin * sizeof(DrawElementsIndirectCommand)),
+					static_cast<GLsizei>(i - batch_begin), 0);
+			}
+			if (!item)
+				break;
+
+			if (!current || current->shader_program != item->shader_program)
+				item->shader_program->bind();
+			if (!current || current->textures != item->textures)
+				RenderStateCache::bind_textures(0, static_cast<unsigned int>(item->textures.size()), item->textures.data());
+			if (!current || current->vertex_array != item->vertex_array)
+				item->vertex_array->bind();
+
+			current = item;
+			batch_begin = i;
+		}
+		render_queue.end_submission();
 	}
 
 	void Renderer_OpenGL::set_clear_color(const float r, const float g, const float b, const float a) {
-		glClearColor(r, g, b, a);
+		RenderStateCache::set_clear_color(r, g, b, a);
 	}
 
 	void Renderer_OpenGL::clear() {
@@ -39,7 +119,22 @@ namespace SimpleEngine {
 	}
 
 	void Renderer_OpenGL::set_view_port(const unsigned int width, const unsigned int height, const unsigned int left_offset, const unsigned int bottom_offset) {
-		glViewport(left_offset, bottom_offset, width, height);
+		RenderStateCache::set_viewport(left_offset, bottom_offset, width, height);
+	}
+
+	bool Renderer_OpenGL::has_extension(const char* name) {
+		GLint extensions_count = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &extensions_count);
+		for (GLint i = 0; i < extensions_count; ++i) {
+			const GLubyte* extension = glGetStringi(GL_EXTENSIONS, i);
+			if (extension && std::strcmp(reinterpret_cast<const char*>(extension), name) == 0)
+				return true;
+		}
+		return false;
+	}
+
+	bool Renderer_OpenGL::supports_parallel_shader_compile() {
+		return s_parallel_shader_compile;
 	}
 
 	const char* Renderer_OpenGL::get_vendor_str() {
@@ -4,16 +4,25 @@ struct GLFWwindow;
 
 namespace SimpleEngine {
 	class VertexArray;
+	class RenderQueue;
 
 	class Renderer_OpenGL {
 	public:
 		static bool init(GLFWwindow* pWindow);
 
 		static void draw(const VertexArray& vertex_array);
+		// per-instance attributes are the ones added with a non-zero step rate
+		static void draw_instanced(const VertexArray& vertex_array, const unsigned int instance_count);
+		// sorts the queue and submits it, merging items with equal state into one multi-draw
+		static void draw(RenderQueue& render_queue);
 		static void set_clear_color(const float r, const float g, const float b, const float a);
 		static void clear();
 		static void set_view_port(const unsigned int width, const unsigned int height, const unsigned int left_offset = 0, const unsigned int bottom_offset = 0);
 
+		static bool has_extension(const char* name);
+		// GL_KHR/ARB_parallel_shader_compile: link status can be polled without blocking
+		static bool supports_parallel_shader_compile();
+
 		static const char* get_vendor_str();
 		static const char* get_renderer_str();
 		static const char* get_version_str();
@@ -0,0 +1,81 @@
+#include "Sampler.hpp"
+#include "RenderStateCache.hpp"
+#include "SimpleEngineCore/Log.hpp"
+#include "glad/glad.h"
+
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+
+namespace SimpleEngine {
+
+	namespace {
+
+		std::unordered_map<uint64_t, std::unique_ptr<Sampler>> s_samplers;
+
+		GLenum filter_to_GLenum(const ETextureFilter filter) {
+			switch (filter) {
+			case ETextureFilter::Nearest:				return GL_NEAREST;
+			case ETextureFilter::Linear:				return GL_LINEAR;
+			case ETextureFilter::LinearMipmapNearest:	return GL_LINEAR_MIPMAP_NEAREST;
+			case ETextureFilter::LinearMipmapLinear:	return GL_LINEAR_MIPMAP_LINEAR;
+			default:
+				LOG_ERROR("filter_to_GLenum: unknown ETextureFilter!");
+				return GL_LINEAR;
+			}
+		}
+
+		GLenum wrap_to_GLenum(const ETextureWrap wrap) {
+			switch (wrap) {
+			case ETextureWrap::Repeat:			return GL_REPEAT;
+			case ETextureWrap::MirroredRepeat:	return GL_MIRRORED_REPEAT;
+			case ETextureWrap::ClampToEdge:		return GL_CLAMP_TO_EDGE;
+			default:
+				LOG_ERROR("wrap_to_GLenum: unknown ETextureWrap!");
+				return GL_REPEAT;
+			}
+		}
+
+	}
+
+	uint64_t SamplerDescription::get_key() const {
+		uint32_t anisotropy_bits = 0;
+		std::memcpy(&anisotropy_bits, &max_anisotropy, sizeof(anisotropy_bits));
+		return static_cast<uint64_t>(min_filter)
+			| static_cast<uint64_t>(mag_filter) << 4
+			| static_cast<uint64_t>(wrap_s) << 8
+			| static_cast<uint64_t>(wrap_t) << 12
+			| static_cast<uint64_t>(anisotropy_bits) << 32;
+	}
+
+	const Sampler& Sampler::get(const SamplerDescription& description) {
+		std::unique_ptr<Sampler>& sampler = s_samplers[description.get_key()];
+		if (!sampler)
+			sampler.reset(new Sampler(description));
+		return *sampler;
+	}
+
+	void Sampler::clear_cache() {
+		s_samplers.clear();
+	}
+
+	Sampler::Sampler(const SamplerDescription& description) {
+		glCreateSamplers(1, &m_id);
+		glSamplerParameteri(m_id, GL_TEXTURE_MIN_FILTER, filter_to_GLenum(description.min_filter));
+		glSamplerParameteri(m_id, GL_TEXTURE_MAG_FILTER, filter_to_GLenum(description.mag_filter));
+		glSamplerParameteri(m_id, GL_TEXTURE_WRAP_S, wrap_to_GLenum(description.wrap_s));
+		glSamplerParameteri(m_id, GL_TEXTURE_WRAP_T, wrap_to_GLenum(description.wrap_t));
+		if (description.max_anisotropy > 1.f)
+			glSamplerParameterf(m_id, GL_TEXTURE_MAX_ANISOTROPY, description.max_anisotropy);
+	}
+
+	Sampler::~Sampler() {
+		RenderStateCache::forget_sampler(m_id);
+		glDeleteSamplers(1, &m_id);
+	}
+
+	void Sampler::bind(const unsigned int unit) const {
+		RenderStateCache::bind_sampler(unit, m_id);
+	}
+
+}
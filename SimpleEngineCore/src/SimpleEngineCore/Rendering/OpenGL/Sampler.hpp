@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+
+namespace SimpleEngine {
+
+	enum class ETextureFilter {
+		Nearest,
+		Linear,
+		LinearMipmapNearest,
+		LinearMipmapLinear	// trilinear
+	};
+
+	enum class ETextureWrap {
+		Repeat,
+		MirroredRepeat,
+		ClampToEdge
+	};
+
+	struct SamplerDescription {
+		ETextureFilter min_filter = ETextureFilter::LinearMipmapLinear;
+		ETextureFilter mag_filter = ETextureFilter::Linear;
+		ETextureWrap wrap_s = ETextureWrap::Repeat;
+		ETextureWrap wrap_t = ETextureWrap::Repeat;
+		float max_anisotropy = 1.f;
+
+		uint64_t get_key() const;
+	};
+
+	// Sampler state lives in shared sampler objects instead of per-texture parameters:
+	// every texture sampled the same way uses one object from the cache.
+	class Sampler {
+	public:
+		static const Sampler& get(const SamplerDescription& description);
+		// deletes all cached samplers, must be called while the GL context is alive
+		static void clear_cache();
+
+		~Sampler();
+
+		Sampler(const Sampler&) = delete;
+		Sampler(Sampler&&) = delete;
+		Sampler& operator=(const Sampler&) = delete;
+		Sampler& operator=(Sampler&&) = delete;
+
+		void bind(const unsigned int unit) const;
+		unsigned int get_id() const { return m_id; }
+
+	private:
+		explicit Sampler(const SamplerDescription& description);
+
+		unsigned int m_id = 0;
+	};
+
+}
@@ -0,0 +1,154 @@
+#include "ShaderCache.hpp"
+#include "SimpleEngineCore/Log.hpp"
+#include "SimpleEngineCore/Resources/FileUtils.hpp"
+#include "SimpleEngineCore/Resources/Hash.hpp"
+#include "glad/glad.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace SimpleEngine {
+
+	namespace {
+
+		constexpr uint32_t s_cache_file_magic = 0x42505345; // "ESPB"
+		constexpr uint32_t s_cache_file_version = 1;
+
+		struct CacheFileHeader {
+			uint32_t magic;
+			uint32_t version;
+			uint64_t key;
+			uint32_t binary_format;
+			uint32_t binary_size;
+		};
+
+		std::string s_directory;
+		ShaderCache::Stats s_stats;
+
+		uint64_t hash_bytes(uint64_t hash, const std::string_view bytes) {
+			hash = hash_fnv1a(bytes.data(), bytes.size(), hash);
+			// separator, so "ab" + "c" and "a" + "bc" differ
+			const unsigned char separator = 0xff;
+			return hash_fnv1a(&separator, sizeof(separator), hash);
+		}
+
+		const char* get_gl_string(const GLenum name) {
+			const GLubyte* value = glGetString(name);
+			return value ? reinterpret_cast<const char*>(value) : "";
+		}
+
+		std::filesystem::path get_cache_file_path(const uint64_t key) {
+			char file_name[32];
+			std::snprintf(file_name, sizeof(file_name), "%016llx.bin", static_cast<unsigned long long>(key));
+			return std::filesystem::path(s_directory) / file_name;
+		}
+
+	}
+
+	void ShaderCache::set_directory(std::string directory) {
+		s_directory = std::move(directory);
+	}
+
+	bool ShaderCache::is_enabled() {
+		if (s_directory.empty())
+			return false;
+		static const bool has_binary_formats = []() {
+			GLint formats_count = 0;
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats_count);
+			if (formats_count == 0)
+				LOG_WARN("ShaderCache: driver supports no program binary formats, cache disabled");
+			return formats_count > 0;
+		}();
+		return has_binary_formats;
+	}
+
+	uint64_t ShaderCache::make_key(const std::string_view vertex_shader_src, const std::string_view fragment_shader_src,
+								   const std::string_view defines) {
+		static const uint64_t driver_hash = []() {
+			uint64_t hash = s_fnv1a_offset_basis;
+			hash = hash_bytes(hash, get_gl_string(GL_VENDOR));
+			hash = hash_bytes(hash, get_gl_string(GL_RENDERER));
+			hash = hash_bytes(hash, get_gl_string(GL_VERSION));
+			return hash;
+		}();
+
+		uint64_t hash = driver_hash;
+		hash = hash_bytes(hash, vertex_shader_src);
+		hash = hash_bytes(hash, fragment_shader_src);
+		hash = hash_bytes(hash, defines);
+		return hash;
+	}
+
+	bool ShaderCache::load(const uint64_t key, const unsigned int program_id) {
+		if (!is_enabled())
+			return false;
+
+		std::ifstream file(get_cache_file_path(key), std::ios::binary);
+		CacheFileHeader header{};
+		if (!file || !file.read(reinterpret_cast<char*>(&header), sizeof(header))
+			|| header.magic != s_cache_file_magic || header.version != s_cache_file_version || header.key != key) {
+			++s_stats.misses;
+			return false;
+		}
+
+		std::vector<char> binary(header.binary_size);
+		if (!file.read(binary.data(), binary.size())) {
+			++s_stats.misses;
+			return false;
+		}
+
+		glProgramBinary(program_id, header.binary_format, binary.data(), static_cast<GLsizei>(binary.size()));
+		GLint success = GL_FALSE;
+		glGetProgramiv(program_id, GL_LINK_STATUS, &success);
+		if (success == GL_FALSE) {
+			// e.g. same driver version string with a different build, the entry is rewritten after compilation
+			++s_stats.rejected;
+			++s_stats.misses;
+			return false;
+		}
+
+		++s_stats.hits;
+		return true;
+	}
+
+	void ShaderCache::store(const uint64_t key, const unsigned int program_id) {
+		if (!is_enabled())
+			return;
+
+		GLint binary_size = 0;
+		glGetProgramiv(program_id, GL_PROGRAM_BINARY_LENGTH, &binary_size);
+		if (binary_size <= 0)
+			return;
+
+		std::vector<char> binary(binary_size);
+		GLenum binary_format = 0;
+		glGetProgramBinary(program_id, binary_size, nullptr, &binary_format, binary.data());
+
+		std::error_code error;
+		std::filesystem::create_directories(s_directory, error);
+		if (error) {
+			LOG_ERROR("ShaderCache: can't create directory {0}: {1}", s_directory, error.message());
+			return;
+		}
+
+		const CacheFileHeader header{ s_cache_file_magic, s_cache_file_version, key, binary_format, static_cast<uint32_t>(binary_size) };
+		const bool written = write_file_atomically(get_cache_file_path(key), [&header, &binary](std::ostream& file) {
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(binary.data(), binary.size());
+		});
+		if (!written)
+			return;
+		++s_stats.stored;
+	}
+
+	const ShaderCache::Stats& ShaderCache::get_stats() {
+		return s_stats;
+	}
+
+	void ShaderCache::reset_stats() {
+		s_stats = {};
+	}
+
+}
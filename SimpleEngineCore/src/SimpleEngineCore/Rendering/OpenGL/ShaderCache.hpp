@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace SimpleEngine {
+
+	// On-disk cache of linked program binaries. An entry is keyed by the shader sources, the defines
+	// and the driver (vendor, renderer, version), so a driver update simply misses the cache.
+	// Disabled until a directory is set or if the driver exposes no binary formats.
+	class ShaderCache {
+	public:
+		struct Stats {
+			uint64_t hits = 0;
+			uint64_t misses = 0;
+			uint64_t rejected = 0;	// found on disk, refused by the driver
+			uint64_t stored = 0;
+		};
+
+		// empty directory disables the cache, the directory is created on first store
+		static void set_directory(std::string directory);
+		static bool is_enabled();
+
+		static uint64_t make_key(const std::string_view vertex_shader_src, const std::string_view fragment_shader_src,
+								 const std::string_view defines);
+
+		// loads the binary into program_id and checks its link status, false means the program has to be compiled
+		static bool load(const uint64_t key, const unsigned int program_id);
+		// program_id has to be linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set
+		static void store(const uint64_t key, const unsigned int program_id);
+
+		static const Stats& get_stats();
+		static void reset_stats();
+	};
+
+}
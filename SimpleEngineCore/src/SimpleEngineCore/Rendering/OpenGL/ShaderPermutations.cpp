@@ -0,0 +1,96 @@
+#include "ShaderPermutations.hpp"
+#include "Renderer_OpenGL.hpp"
+#include "SimpleEngineCore/Log.hpp"
+
+#include <algorithm>
+
+namespace SimpleEngine {
+
+	ShaderPermutations::ShaderPermutations(std::string vertex_shader_src, std::string fragment_shader_src,
+										   std::vector<std::string> features, const ShaderFeatureMask fallback_features)
+		: m_vertex_shader_src(std::move(vertex_shader_src)),
+		  m_fragment_shader_src(std::move(fragment_shader_src)),
+		  m_features(std::move(features)),
+		  m_fallback_features(fallback_features)
+	{
+		if (m_features.size() > s_max_features) {
+			LOG_ERROR("ShaderPermutations: {0} features, only the first {1} are used", m_features.size(), s_max_features);
+			m_features.resize(s_max_features);
+		}
+		m_fallback_features = normalize(m_fallback_features);
+
+		// the fallback has to be there from the first frame
+		m_variants.emplace(m_fallback_features, std::make_unique<ShaderProgram>(
+			m_vertex_shader_src.c_str(), m_fragment_shader_src.c_str(), make_defines(m_fallback_features), EShaderCompileMode::Blocking));
+		if (!m_variants[m_fallback_features]->is_compiled())
+			LOG_CRITICAL("ShaderPermutations: fallback variant {0:#x} failed to compile", m_fallback_features);
+	}
+
+	ShaderProgram* ShaderPermutations::get(ShaderFeatureMask features) {
+		features = normalize(features);
+		ShaderProgram* variant = find_variant(features);
+		if (!variant) {
+			prepare(features);
+			variant = find_variant(features);
+		}
+		if (variant->is_compiled())
+			return variant;
+
+		ShaderProgram* fallback = find_variant(m_fallback_features);
+		return fallback->is_compiled() ? fallback : nullptr;
+	}
+
+	void ShaderPermutations::prepare(ShaderFeatureMask features) {
+		features = normalize(features);
+		if (find_variant(features))
+			return;
+
+		m_variants.emplace(features, std::make_unique<ShaderProgram>(
+			m_vertex_shader_src.c_str(), m_fragment_shader_src.c_str(), make_defines(features), EShaderCompileMode::NonBlocking));
+		// a variant loaded from the program binary cache is finished right away
+		if (find_variant(features)->is_compile_pending())
+			m_pending.push_back(features);
+	}
+
+	void ShaderPermutations::update(const unsigned int max_blocking_finishes) {
+		const bool is_parallel = Renderer_OpenGL::supports_parallel_shader_compile();
+		unsigned int blocking_finishes = 0;
+
+		m_pending.erase(std::remove_if(m_pending.begin(), m_pending.end(), [&](const ShaderFeatureMask features) {
+			if (!is_parallel && blocking_finishes >= max_blocking_finishes)
+				return false;
+			++blocking_finishes;
+
+			ShaderProgram* variant = find_variant(features);
+			if (!variant->poll_compile())
+				return false;
+			if (!variant->is_compiled())
+				LOG_ERROR("ShaderPermutations: variant {0:#x} failed to compile, the fallback stays in use", features);
+			return true;
+		}), m_pending.end());
+	}
+
+	bool ShaderPermutations::is_ready(const ShaderFeatureMask features) const {
+		const ShaderProgram* variant = find_variant(normalize(features));
+		return variant && variant->is_compiled();
+	}
+
+	std::string ShaderPermutations::make_defines(const ShaderFeatureMask features) const {
+		std::string defines;
+		for (size_t i = 0; i < m_features.size(); ++i) {
+			if (features & (1u << i))
+				defines += "#define " + m_features[i] + " 1\n";
+		}
+		return defines;
+	}
+
+	ShaderFeatureMask ShaderPermutations::normalize(const ShaderFeatureMask features) const {
+		return m_features.size() < s_max_features ? features & ((1u << m_features.size()) - 1) : features;
+	}
+
+	ShaderProgram* ShaderPermutations::find_variant(const ShaderFeatureMask features) const {
+		const auto it = m_variants.find(features);
+		return it != m_variants.end() ? it->second.get() : nullptr;
+	}
+
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include "ShaderProgram.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace SimpleEngine {
+
+	// bit i enables the i-th feature define of the ShaderPermutations
+	using ShaderFeatureMask = uint32_t;
+
+	// Variants of one shader source, one per combination of feature defines.
+	// Variants are compiled on first request without blocking the frame; until a variant
+	// is linked, the fallback variant (compiled up front) is returned in its place.
+	class ShaderPermutations {
+	public:
+		static constexpr size_t s_max_features = 32;
+
+		ShaderPermutations(std::string vertex_shader_src, std::string fragment_shader_src,
+						   std::vector<std::string> features, const ShaderFeatureMask fallback_features = 0);
+
+		ShaderPermutations(const ShaderPermutations&) = delete;
+		ShaderPermutations& operator=(const ShaderPermutations&) = delete;
+
+		// the requested variant if it is linked, the fallback otherwise (nullptr if even the fallback failed)
+		ShaderProgram* get(const ShaderFeatureMask features);
+		// starts compiling a variant ahead of its first use
+		void prepare(const ShaderFeatureMask features);
+		// once per frame: finishes the variants whose compilation is done. Without parallel shader
+		// compile the check blocks, so at most max_blocking_finishes variants are finished per call
+		void update(const unsigned int max_blocking_finishes = 1);
+
+		bool is_ready(const ShaderFeatureMask features) const;
+		size_t get_pending_count() const { return m_pending.size(); }
+		size_t get_variants_count() const { return m_variants.size(); }
+
+		std::string make_defines(const ShaderFeatureMask features) const;
+
+	private:
+		ShaderProgram* find_variant(const ShaderFeatureMask features) const;
+		// drops bits without a feature, so they don't make duplicate variants
+		ShaderFeatureMask normalize(const ShaderFeatureMask features) const;
+
+		std::string m_vertex_shader_src;
+		std::string m_fragment_shader_src;
+		std::vector<std::string> m_features;
+		ShaderFeatureMask m_fallback_features = 0;
+
+		std::unordered_map<ShaderFeatureMask, std::unique_ptr<ShaderProgram>> m_variants;
+		std::vector<ShaderFeatureMask> m_pending;
+	};
+
+}
@@ -1,102 +1,412 @@
 #include "ShaderProgram.hpp"
+#include "RenderStateCache.hpp"
+#include "ShaderCache.hpp"
+#include "Renderer_OpenGL.hpp"
 #include "SimpleEngineCore/Log.hpp"
 #include "glad/glad.h"
 #include "glm/gtc/type_ptr.hpp"
 
 #include <fstream>
+#include <algorithm>
+#include <string>
 
 namespace SimpleEngine {
-	bool createShader(const char* source, GLuint shader_type, GLuint& shader_id) {
-		shader_id = glCreateShader(shader_type);
-		glShaderSource(shader_id, 1, &source, nullptr);
-		glCompileShader(shader_id);
 
-		GLint success;
-		glGetShaderiv(shader_id, GL_COMPILE_STATUS, &success);
-		if (success == GL_FALSE) {
-			char info_log[1024];
-			glGetShaderInfoLog(shader_id, 1024, nullptr, info_log);
-			LOG_CRITICAL("SHADER COMPILATION ERROR:\n{}", info_log);
-			return false;
+	namespace {
+
+		bool is_sampler_type(const GLenum type) {
+			switch (type) {
+			case GL_SAMPLER_1D:
+			case GL_SAMPLER_2D:
+			case GL_SAMPLER_3D:
+			case GL_SAMPLER_CUBE:
+			case GL_SAMPLER_1D_SHADOW:
+			case GL_SAMPLER_2D_SHADOW:
+			case GL_SAMPLER_1D_ARRAY:
+			case GL_SAMPLER_2D_ARRAY:
+			case GL_SAMPLER_1D_ARRAY_SHADOW:
+			case GL_SAMPLER_2D_ARRAY_SHADOW:
+			case GL_SAMPLER_2D_MULTISAMPLE:
+			case GL_SAMPLER_2D_MULTISAMPLE_ARRAY:
+			case GL_SAMPLER_CUBE_SHADOW:
+			case GL_SAMPLER_CUBE_MAP_ARRAY:
+			case GL_SAMPLER_CUBE_MAP_ARRAY_SHADOW:
+			case GL_SAMPLER_BUFFER:
+			case GL_SAMPLER_2D_RECT:
+			case GL_SAMPLER_2D_RECT_SHADOW:
+			case GL_INT_SAMPLER_2D:
+			case GL_INT_SAMPLER_3D:
+			case GL_INT_SAMPLER_CUBE:
+			case GL_INT_SAMPLER_2D_ARRAY:
+			case GL_INT_SAMPLER_BUFFER:
+			case GL_UNSIGNED_INT_SAMPLER_2D:
+			case GL_UNSIGNED_INT_SAMPLER_3D:
+			case GL_UNSIGNED_INT_SAMPLER_CUBE:
+			case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+			case GL_UNSIGNED_INT_SAMPLER_BUFFER:
+				return true;
+			default:
+				return false;
+			}
 		}
-		return true;
+
+		// "lights[0]" -> "lights", "camera.position" stays as is
+		std::string_view strip_array_suffix(const std::string_view name) {
+			if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+				return name.substr(0, name.size() - 3);
+			return name;
+		}
+
+		template<typename T>
+		const T* find_by_hash(const std::vector<T>& table, const uint32_t name_hash) {
+			const auto it = std::lower_bound(table.begin(), table.end(), name_hash,
+				[](const T& info, const uint32_t hash) { return info.name_hash < hash; });
+			if (it == table.end() || it->name_hash != name_hash)
+				return nullptr;
+			return &*it;
+		}
+
+		template<typename T>
+		void sort_by_hash(std::vector<T>& table, const char* table_name) {
+			std::sort(table.begin(), table.end(),
+				[](const T& a, const T& b) { return a.name_hash < b.name_hash; });
+			const auto duplicate = std::adjacent_find(table.begin(), table.end(),
+				[](const T& a, const T& b) { return a.name_hash == b.name_hash; });
+			if (duplicate != table.end())
+				LOG_ERROR("ShaderProgram: {0} name hash collision ({1:#x})", table_name, duplicate->name_hash);
+		}
+
+		bool check_shader(const GLuint shader_id) {
+			GLint success;
+			glGetShaderiv(shader_id, GL_COMPILE_STATUS, &success);
+			if (success == GL_FALSE) {
+				char info_log[1024];
+				glGetShaderInfoLog(shader_id, 1024, nullptr, info_log);
+				LOG_CRITICAL("SHADER COMPILATION ERROR:\n{}", info_log);
+				return false;
+			}
+			return true;
+		}
+
+		// defines go right after the #version line, which has to stay first
+		std::string insert_defines(const char* source, const std::string_view defines) {
+			std::string result(source);
+			if (defines.empty())
+				return result;
+
+			size_t insert_position = 0;
+			const size_t version_position = result.find("#version");
+			if (version_position != std::string::npos) {
+				const size_t line_end = result.find('\n', version_position);
+				insert_position = line_end == std::string::npos ? result.size() : line_end + 1;
+			}
+			std::string block(defines);
+			if (block.back() != '\n')
+				block += '\n';
+			result.insert(insert_position, block);
+			return result;
+		}
+
+		// GL_KHR_parallel_shader_compile
+		constexpr GLenum s_completion_status = 0x91B1;
+
+		bool createShader(const char* source, GLuint shader_type, GLuint& shader_id, const bool check_status) {
+			shader_id = glCreateShader(shader_type);
+			glShaderSource(shader_id, 1, &source, nullptr);
+			glCompileShader(shader_id);
+			return !check_status || check_shader(shader_id);
+		}
+
 	}
 
-	ShaderProgram::ShaderProgram(const char* vertex_shader_src, const char* fragment_shader_src) {
+	ShaderProgram::ShaderProgram(const char* vertex_shader_src, const char* fragment_shader_src, const std::string_view defines,
+								 const EShaderCompileMode compile_mode) {
+		m_cache_key = ShaderCache::is_enabled() ? ShaderCache::make_key(vertex_shader_src, fragment_shader_src, defines) : 0;
+		if (ShaderCache::is_enabled()) {
+			m_id = glCreateProgram();
+			if (ShaderCache::load(m_cache_key, m_id)) {
+				m_isCompiled = true;
+				reflect();
+				return;
+			}
+			// a rejected binary may leave the program in an undefined state, start from a clean one
+			glDeleteProgram(m_id);
+			m_id = 0;
+		}
 
-		GLuint vertex_shader_id = 0;
-		if (!createShader(vertex_shader_src, GL_VERTEX_SHADER, vertex_shader_id)) {
+		const std::string vertex_source = insert_defines(vertex_shader_src, defines);
+		const std::string fragment_source = insert_defines(fragment_shader_src, defines);
+
+		// a blocking compile checks every stage right away, a non-blocking one
+		// leaves all status queries to finish_compile()
+		const bool is_blocking = compile_mode == EShaderCompileMode::Blocking;
+		if (!createShader(vertex_source.c_str(), GL_VERTEX_SHADER, m_pending_shaders[0], is_blocking)) {
 			LOG_CRITICAL("VERTEX SHADER");
-			glDeleteShader(vertex_shader_id);
+			delete_pending_shaders();
 			return;
 		}
-
-		GLuint fragment_shader_id = 0;
-		if (!createShader(fragment_shader_src, GL_FRAGMENT_SHADER, fragment_shader_id)) {
+		if (!createShader(fragment_source.c_str(), GL_FRAGMENT_SHADER, m_pending_shaders[1], is_blocking)) {
 			LOG_WARN("FRAGMENT SHADER");
-			glDeleteShader(vertex_shader_id);
-			glDeleteShader(fragment_shader_id);
+			delete_pending_shaders();
 			return;
 		}
 
 		m_id = glCreateProgram();			   
-		glAttachShader(m_id, vertex_shader_id);
-		glAttachShader(m_id, fragment_shader_id);
+		glAttachShader(m_id, m_pending_shaders[0]);
+		glAttachShader(m_id, m_pending_shaders[1]);
+		if (ShaderCache::is_enabled())
+			glProgramParameteri(m_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 		glLinkProgram(m_id);
+		m_isCompilePending = true;
+
+		if (is_blocking)
+			finish_compile();
+	}
+
+	bool ShaderProgram::poll_compile() {
+		if (!m_isCompilePending)
+			return true;
+		if (Renderer_OpenGL::supports_parallel_shader_compile()) {
+			GLint is_complete = GL_FALSE;
+			glGetProgramiv(m_id, s_completion_status, &is_complete);
+			if (is_complete == GL_FALSE)
+				return false;
+		}
+		finish_compile();
+		return true;
+	}
+
+	void ShaderProgram::finish_compile() {
+		m_isCompilePending = false;
+
+		const bool is_vertex_shader_compiled = check_shader(m_pending_shaders[0]);
+		const bool is_fragment_shader_compiled = check_shader(m_pending_shaders[1]);
+		if (!is_vertex_shader_compiled || !is_fragment_shader_compiled) {
+			if (!is_vertex_shader_compiled)
+				LOG_CRITICAL("VERTEX SHADER");
+			if (!is_fragment_shader_compiled)
+				LOG_WARN("FRAGMENT SHADER");
+			glDeleteProgram(m_id);
+			m_id = 0;
+			delete_pending_shaders();
+			return;
+		}
 
 		GLint success;
-		glGetProgramiv(m_id, GL_COMPILE_STATUS, &success);
+		glGetProgramiv(m_id, GL_LINK_STATUS, &success);
 		if (success == GL_FALSE) {
 			char info_log[1024];
-			glGetShaderInfoLog(m_id, 1024, nullptr, info_log);
+			glGetProgramInfoLog(m_id, 1024, nullptr, info_log);
 			LOG_CRITICAL("SHADER PROGRAM COMPILATION ERROR:\n{}", info_log);
 			glDeleteProgram(m_id);
 			m_id = 0;
-			glDeleteShader(vertex_shader_id);
-			glDeleteShader(fragment_shader_id);
+			delete_pending_shaders();
 			return;
 		}
 		m_isCompiled = true;
-		glDetachShader(m_id, vertex_shader_id);
-		glDetachShader(m_id, fragment_shader_id);
-		glDeleteShader(vertex_shader_id);
-		glDeleteShader(fragment_shader_id);
+		glDetachShader(m_id, m_pending_shaders[0]);
+		glDetachShader(m_id, m_pending_shaders[1]);
+		delete_pending_shaders();
+
+		ShaderCache::store(m_cache_key, m_id);
+		reflect();
+	}
+
+	void ShaderProgram::delete_pending_shaders() {
+		for (unsigned int& shader_id : m_pending_shaders) {
+			glDeleteShader(shader_id);
+			shader_id = 0;
+		}
+	}
+
+	void ShaderProgram::reflect() {
+		m_uniforms.clear();
+		m_uniform_blocks.clear();
+		m_samplers.clear();
+
+		GLint max_name_length = 0;
+		glGetProgramInterfaceiv(m_id, GL_UNIFORM, GL_MAX_NAME_LENGTH, &max_name_length);
+		GLint max_block_name_length = 0;
+		glGetProgramInterfaceiv(m_id, GL_UNIFORM_BLOCK, GL_MAX_NAME_LENGTH, &max_block_name_length);
+		std::string name(std::max(max_name_length, max_block_name_length), '\0');
+
+		GLint uniforms_count = 0;
+		glGetProgramInterfaceiv(m_id, GL_UNIFORM, GL_ACTIVE_RESOURCES, &uniforms_count);
+		m_uniforms.reserve(uniforms_count);
+
+		const GLenum uniform_properties[] = { GL_TYPE, GL_LOCATION, GL_ARRAY_SIZE, GL_BLOCK_INDEX };
+		for (GLint i = 0; i < uniforms_count; ++i) {
+			GLint values[4];
+			glGetProgramResourceiv(m_id, GL_UNIFORM, i, 4, uniform_properties, 4, nullptr, values);
+			// members of uniform blocks have no location, they are reflected through the block
+			if (values[3] != -1)
+				continue;
+
+			GLsizei length = 0;
+			glGetProgramResourceName(m_id, GL_UNIFORM, i, static_cast<GLsizei>(name.size()), &length, name.data());
+			const uint32_t name_hash = hash_uniform_name(strip_array_suffix({ name.data(), static_cast<size_t>(length) }));
+			const GLenum type = static_cast<GLenum>(values[0]);
+
+			m_uniforms.push_back({ name_hash, values[1], type, values[2] });
+
+			if (is_sampler_type(type)) {
+				GLint texture_unit = 0;
+				glGetUniformiv(m_id, values[1], &texture_unit);
+				m_samplers.push_back({ name_hash, values[1], type, texture_unit });
+			}
+		}
+
+		GLint blocks_count = 0;
+		glGetProgramInterfaceiv(m_id, GL_UNIFORM_BLOCK, GL_ACTIVE_RESOURCES, &blocks_count);
+		m_uniform_blocks.reserve(blocks_count);
+
+		const GLenum block_properties[] = { GL_BUFFER_BINDING, GL_BUFFER_DATA_SIZE };
+		for (GLint i = 0; i < blocks_count; ++i) {
+			GLint values[2];
+			glGetProgramResourceiv(m_id, GL_UNIFORM_BLOCK, i, 2, block_properties, 2, nullptr, values);
+
+			GLsizei length = 0;
+			glGetProgramResourceName(m_id, GL_UNIFORM_BLOCK, i, static_cast<GLsizei>(name.size()), &length, name.data());
+			const uint32_t name_hash = hash_uniform_name({ name.data(), static_cast<size_t>(length) });
+
+			m_uniform_blocks.push_back({ name_hash, static_cast<unsigned int>(i), values[0], values[1] });
+		}
+
+		sort_by_hash(m_uniforms, "uniform");
+		sort_by_hash(m_uniform_blocks, "uniform block");
+		sort_by_hash(m_samplers, "sampler");
 	}
 
 	ShaderProgram::~ShaderProgram() {
+		delete_pending_shaders();
+		RenderStateCache::forget_program(m_id);
 		glDeleteProgram(m_id);
 	}
 
 	void ShaderProgram::bind() const{
-		glUseProgram(m_id);
+		RenderStateCache::use_program(m_id);
 	}
 	void ShaderProgram::unbind() {
-		glUseProgram(0);
+		RenderStateCache::use_program(0);
+	}
+
+	const ShaderProgram::UniformInfo* ShaderProgram::find_uniform(const UniformName name) const {
+		return find_by_hash(m_uniforms, name.hash);
+	}
+
+	const ShaderProgram::UniformBlockInfo* ShaderProgram::find_uniform_block(const UniformName name) const {
+		return find_by_hash(m_uniform_blocks, name.hash);
+	}
+
+	UniformHandle ShaderProgram::get_uniform(const UniformName name) const {
+		const UniformInfo* uniform = find_uniform(name);
+		return { uniform ? uniform->location : -1 };
+	}
+
+	void ShaderProgram::set_uniform_block_binding(const UniformName name, const unsigned int binding) {
+		const auto it = std::lower_bound(m_uniform_blocks.begin(), m_uniform_blocks.end(), name.hash,
+			[](const UniformBlockInfo& info, const uint32_t hash) { return info.name_hash < hash; });
+		if (it == m_uniform_blocks.end() || it->name_hash != name.hash)
+			return;
+		glUniformBlockBinding(m_id, it->index, binding);
+		it->binding = static_cast<int>(binding);
+	}
+
+	// glProgramUniform* write straight into the program object, no bind() required
+	void ShaderProgram::set_int(const UniformHandle handle, const int value) {
+		glProgramUniform1i(m_id, handle.location, value);
+	}
+
+	void ShaderProgram::set_float(const UniformHandle handle, const float value) {
+		glProgramUniform1f(m_id, handle.location, value);
+	}
+
+	void ShaderProgram::set_vec2(const UniformHandle handle, const glm::vec2& value) {
+		glProgramUniform2fv(m_id, handle.location, 1, glm::value_ptr(value));
+	}
+
+	void ShaderProgram::set_vec3(const UniformHandle handle, const glm::vec3& value) {
+		glProgramUniform3fv(m_id, handle.location, 1, glm::value_ptr(value));
+	}
+
+	void ShaderProgram::set_vec4(const UniformHandle handle, const glm::vec4& value) {
+		glProgramUniform4fv(m_id, handle.location, 1, glm::value_ptr(value));
+	}
+
+	void ShaderProgram::set_matrix3(const UniformHandle handle, const glm::mat3& matrix) {
+		glProgramUniformMatrix3fv(m_id, handle.location, 1, GL_FALSE, glm::value_ptr(matrix));
+	}
+
+	void ShaderProgram::set_matrix4(const UniformHandle handle, const glm::mat4& matrix) {
+		glProgramUniformMatrix4fv(m_id, handle.location, 1, GL_FALSE, glm::value_ptr(matrix));
+	}
+
+	void ShaderProgram::set_int_array(const UniformHandle handle, const int* values, const int count) {
+		glProgramUniform1iv(m_id, handle.location, count, values);
+	}
+
+	void ShaderProgram::set_float_array(const UniformHandle handle, const float* values, const int count) {
+		glProgramUniform1fv(m_id, handle.location, count, values);
+	}
+
+	void ShaderProgram::set_vec2_array(const UniformHandle handle, const glm::vec2* values, const int count) {
+		glProgramUniform2fv(m_id, handle.location, count, glm::value_ptr(*values));
+	}
+
+	void ShaderProgram::set_vec3_array(const UniformHandle handle, const glm::vec3* values, const int count) {
+		glProgramUniform3fv(m_id, handle.location, count, glm::value_ptr(*values));
+	}
+
+	void ShaderProgram::set_vec4_array(const UniformHandle handle, const glm::vec4* values, const int count) {
+		glProgramUniform4fv(m_id, handle.location, count, glm::value_ptr(*values));
 	}
 
-	void ShaderProgram::set_matrix4(const char* name, glm::mat4& matrix) {
-		glUniformMatrix4fv(glGetUniformLocation(m_id, name), 1, GL_FALSE, glm::value_ptr(matrix));
+	void ShaderProgram::set_matrix3_array(const UniformHandle handle, const glm::mat3* matrices, const int count) {
+		glProgramUniformMatrix3fv(m_id, handle.location, count, GL_FALSE, glm::value_ptr(*matrices));
 	}
 
-	void ShaderProgram::set_int(const char* name, const int value) {
-		glUniform1i(glGetUniformLocation(m_id, name), value);
+	void ShaderProgram::set_matrix4_array(const UniformHandle handle, const glm::mat4* matrices, const int count) {
+		glProgramUniformMatrix4fv(m_id, handle.location, count, GL_FALSE, glm::value_ptr(*matrices));
 	}
 
 	ShaderProgram& ShaderProgram::operator=(ShaderProgram&& shaderprogram) noexcept{
+		delete_pending_shaders();
+		RenderStateCache::forget_program(m_id);
 		glDeleteProgram(m_id);
 		m_id = shaderprogram.m_id;
 		m_isCompiled = shaderprogram.m_isCompiled;
+		m_isCompilePending = shaderprogram.m_isCompilePending;
+		m_pending_shaders[0] = shaderprogram.m_pending_shaders[0];
+		m_pending_shaders[1] = shaderprogram.m_pending_shaders[1];
+		m_cache_key = shaderprogram.m_cache_key;
+		m_uniforms = std::move(shaderprogram.m_uniforms);
+		m_uniform_blocks = std::move(shaderprogram.m_uniform_blocks);
+		m_samplers = std::move(shaderprogram.m_samplers);
 
 		shaderprogram.m_id = 0;
 		shaderprogram.m_isCompiled = false;
+		shaderprogram.m_isCompilePending = false;
+		shaderprogram.m_pending_shaders[0] = 0;
+		shaderprogram.m_pending_shaders[1] = 0;
 		return *this;
 	}
 
-	ShaderProgram::ShaderProgram(ShaderProgram&& shaderprogram) noexcept{
+	ShaderProgram::ShaderProgram(ShaderProgram&& shaderprogram) noexcept
+		: m_uniforms(std::move(shaderprogram.m_uniforms)),
+		  m_uniform_blocks(std::move(shaderprogram.m_uniform_blocks)),
+		  m_samplers(std::move(shaderprogram.m_samplers))
+	{
 		m_id = shaderprogram.m_id;
 		m_isCompiled = shaderprogram.m_isCompiled;
+		m_isCompilePending = shaderprogram.m_isCompilePending;
+		m_pending_shaders[0] = shaderprogram.m_pending_shaders[0];
+		m_pending_shaders[1] = shaderprogram.m_pending_shaders[1];
+		m_cache_key = shaderprogram.m_cache_key;
 
 		shaderprogram.m_id = 0;
 		shaderprogram.m_isCompiled = false;
+		shaderprogram.m_isCompilePending = false;
+		shaderprogram.m_pending_shaders[0] = 0;
+		shaderprogram.m_pending_shaders[1] = 0;
 	}
 }
\ No newline at end of file
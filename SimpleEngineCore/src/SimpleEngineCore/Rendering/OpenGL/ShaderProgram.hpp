@@ -1,14 +1,73 @@
 #pragma once
 //#include <string>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "glm/vec2.hpp"
+#include "glm/vec3.hpp"
+#include "glm/vec4.hpp"
+#include "glm/mat3x3.hpp"
 #include "glm/mat4x4.hpp"
 
-namespace SimpleEngine { 
+namespace SimpleEngine {
 	/*std::string downloadShaderSrc(const char* path);
 	*/
 
+	// FNV-1a, usable at compile time
+	constexpr uint32_t hash_uniform_name(const std::string_view name) {
+		uint32_t hash = 2166136261u;
+		for (const char c : name) {
+			hash ^= static_cast<uint8_t>(c);
+			hash *= 16777619u;
+		}
+		return hash;
+	}
+
+	// constexpr UniformName model_matrix{ "model_matrix" }; - hashed at compile time
+	struct UniformName {
+		constexpr UniformName(const char* name) : hash(hash_uniform_name(name)) {}
+		constexpr UniformName(const std::string_view name) : hash(hash_uniform_name(name)) {}
+		uint32_t hash;
+	};
+
+	// location resolved once, e.g. after the program is linked
+	struct UniformHandle {
+		int location = -1;
+		bool is_valid() const { return location >= 0; }
+	};
+
+	enum class EShaderCompileMode {
+		Blocking,
+		// compile and link are only issued, poll_compile() finishes the program once the driver is done
+		NonBlocking
+	};
+
 	class ShaderProgram {
 	public:
-		ShaderProgram(const char* vertex_shader_src, const char* fragment_shader_src);
+		struct UniformInfo {
+			uint32_t name_hash;
+			int location;
+			unsigned int type;
+			int array_size;
+		};
+
+		struct UniformBlockInfo {
+			uint32_t name_hash;
+			unsigned int index;
+			int binding;
+			int data_size;
+		};
+
+		struct SamplerInfo {
+			uint32_t name_hash;
+			int location;
+			unsigned int type;
+			int texture_unit;
+		};
+
+		// defines - "#define NAME VALUE" lines inserted after #version
+		ShaderProgram(const char* vertex_shader_src, const char* fragment_shader_src, const std::string_view defines = {},
+					  const EShaderCompileMode compile_mode = EShaderCompileMode::Blocking);
 		ShaderProgram(ShaderProgram&&) noexcept;
 		ShaderProgram& operator=(ShaderProgram&&) noexcept;
 		~ShaderProgram();
@@ -20,11 +79,58 @@ namespace SimpleEngine {
 		void bind() const;
 		static void unbind();
 		bool is_compiled() const { return m_isCompiled; }
-		void set_matrix4(const char* name, glm::mat4& matrix);
-		void set_int(const char* name, const int value);
+		bool is_compile_pending() const { return m_isCompilePending; }
+		// true once the program is finished, compiled or not; without parallel shader compile
+		// support the driver may block here until linking is done
+		bool poll_compile();
+		unsigned int get_id() const { return m_id; }
+
+		UniformHandle get_uniform(const UniformName name) const;
+		const UniformInfo* find_uniform(const UniformName name) const;
+		const UniformBlockInfo* find_uniform_block(const UniformName name) const;
+		const std::vector<UniformInfo>& get_uniforms() const { return m_uniforms; }
+		const std::vector<UniformBlockInfo>& get_uniform_blocks() const { return m_uniform_blocks; }
+		const std::vector<SamplerInfo>& get_samplers() const { return m_samplers; }
+		void set_uniform_block_binding(const UniformName name, const unsigned int binding);
+
+		void set_int(const UniformHandle handle, const int value);
+		void set_float(const UniformHandle handle, const float value);
+		void set_vec2(const UniformHandle handle, const glm::vec2& value);
+		void set_vec3(const UniformHandle handle, const glm::vec3& value);
+		void set_vec4(const UniformHandle handle, const glm::vec4& value);
+		void set_matrix3(const UniformHandle handle, const glm::mat3& matrix);
+		void set_matrix4(const UniformHandle handle, const glm::mat4& matrix);
+
+		void set_int_array(const UniformHandle handle, const int* values, const int count);
+		void set_float_array(const UniformHandle handle, const float* values, const int count);
+		void set_vec2_array(const UniformHandle handle, const glm::vec2* values, const int count);
+		void set_vec3_array(const UniformHandle handle, const glm::vec3* values, const int count);
+		void set_vec4_array(const UniformHandle handle, const glm::vec4* values, const int count);
+		void set_matrix3_array(const UniformHandle handle, const glm::mat3* matrices, const int count);
+		void set_matrix4_array(const UniformHandle handle, const glm::mat4* matrices, const int count);
+
+		void set_int(const UniformName name, const int value) { set_int(get_uniform(name), value); }
+		void set_float(const UniformName name, const float value) { set_float(get_uniform(name), value); }
+		void set_vec2(const UniformName name, const glm::vec2& value) { set_vec2(get_uniform(name), value); }
+		void set_vec3(const UniformName name, const glm::vec3& value) { set_vec3(get_uniform(name), value); }
+		void set_vec4(const UniformName name, const glm::vec4& value) { set_vec4(get_uniform(name), value); }
+		void set_matrix3(const UniformName name, const glm::mat3& matrix) { set_matrix3(get_uniform(name), matrix); }
+		void set_matrix4(const UniformName name, const glm::mat4& matrix) { set_matrix4(get_uniform(name), matrix); }
 
 	private:
+		void finish_compile();
+		void delete_pending_shaders();
+		void reflect();
+
 		bool m_isCompiled = false;
+		bool m_isCompilePending = false;
 		unsigned int m_id = 0;
+		unsigned int m_pending_shaders[2] = {};
+		uint64_t m_cache_key = 0;
+
+		// sorted by name_hash
+		std::vector<UniformInfo> m_uniforms;
+		std::vector<UniformBlockInfo> m_uniform_blocks;
+		std::vector<SamplerInfo> m_samplers;
 	};
-}
\ No newline at end of file
+}
@@ -0,0 +1,102 @@
+#include "StreamingBuffer.hpp"
+#include "RenderStateCache.hpp"
+#include "SimpleEngineCore/Log.hpp"
+#include "glad/glad.h"
+
+#include <algorithm>
+
+namespace SimpleEngine {
+
+	StreamingBuffer::StreamingBuffer(const size_t frame_size, const unsigned int frames_count)
+		: m_frame_size(frame_size),
+		  m_frames_count(std::clamp(frames_count, 1u, s_max_frames))
+	{
+		if (frames_count > s_max_frames)
+			LOG_WARN("StreamingBuffer: frames count {0} clamped to {1}", frames_count, s_max_frames);
+
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		const size_t total_size = m_frame_size * m_frames_count;
+
+		glCreateBuffers(1, &m_id);
+		glNamedBufferStorage(m_id, total_size, nullptr, flags);
+		m_mapped_data = static_cast<unsigned char*>(glMapNamedBufferRange(m_id, 0, total_size, flags));
+		if (!m_mapped_data)
+			LOG_CRITICAL("StreamingBuffer: failed to map {0} bytes", total_size);
+	}
+
+	StreamingBuffer::~StreamingBuffer() {
+		for (GLsync& fence : m_fences) {
+			glDeleteSync(fence);
+			fence = nullptr;
+		}
+		if (m_mapped_data)
+			glUnmapNamedBuffer(m_id);
+		RenderStateCache::forget_buffer(m_id);
+		glDeleteBuffers(1, &m_id);
+	}
+
+	StreamingBuffer& StreamingBuffer::operator=(StreamingBuffer&& streaming_buffer) noexcept {
+		std::swap(m_id, streaming_buffer.m_id);
+		std::swap(m_mapped_data, streaming_buffer.m_mapped_data);
+		std::swap(m_frame_size, streaming_buffer.m_frame_size);
+		std::swap(m_frames_count, streaming_buffer.m_frames_count);
+		std::swap(m_current_frame, streaming_buffer.m_current_frame);
+		std::swap(m_frame_offset, streaming_buffer.m_frame_offset);
+		std::swap(m_fences, streaming_buffer.m_fences);
+		std::swap(m_stalls_count, streaming_buffer.m_stalls_count);
+		return *this;
+	}
+
+	StreamingBuffer::StreamingBuffer(StreamingBuffer&& streaming_buffer) noexcept
+		: m_id(streaming_buffer.m_id),
+		  m_mapped_data(streaming_buffer.m_mapped_data),
+		  m_frame_size(streaming_buffer.m_frame_size),
+		  m_frames_count(streaming_buffer.m_frames_count),
+		  m_current_frame(streaming_buffer.m_current_frame),
+		  m_frame_offset(streaming_buffer.m_frame_offset),
+		  m_stalls_count(streaming_buffer.m_stalls_count)
+	{
+		std::copy(std::begin(streaming_buffer.m_fences), std::end(streaming_buffer.m_fences), m_fences);
+		std::fill(std::begin(streaming_buffer.m_fences), std::end(streaming_buffer.m_fences), nullptr);
+		streaming_buffer.m_id = 0;
+		streaming_buffer.m_mapped_data = nullptr;
+	}
+
+	void StreamingBuffer::begin_frame() {
+		m_frame_offset = 0;
+
+		GLsync& fence = m_fences[m_current_frame];
+		if (!fence)
+			return;
+
+		GLenum result = glClientWaitSync(fence, 0, 0);
+		if (result == GL_TIMEOUT_EXPIRED) {
+			++m_stalls_count;
+			do {
+				result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000);
+			} while (result == GL_TIMEOUT_EXPIRED);
+		}
+		if (result == GL_WAIT_FAILED)
+			LOG_ERROR("StreamingBuffer: glClientWaitSync failed");
+
+		glDeleteSync(fence);
+		fence = nullptr;
+	}
+
+	StreamingBuffer::Allocation StreamingBuffer::allocate(const size_t size, const size_t alignment) {
+		const size_t aligned_offset = (m_frame_offset + alignment - 1) / alignment * alignment;
+		if (!m_mapped_data || aligned_offset + size > m_frame_size)
+			return {};
+
+		m_frame_offset = aligned_offset + size;
+		const size_t offset = m_current_frame * m_frame_size + aligned_offset;
+		return { m_mapped_data + offset, offset, size };
+	}
+
+	void StreamingBuffer::end_frame() {
+		glDeleteSync(m_fences[m_current_frame]);
+		m_fences[m_current_frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		m_current_frame = (m_current_frame + 1) % m_frames_count;
+	}
+
+}
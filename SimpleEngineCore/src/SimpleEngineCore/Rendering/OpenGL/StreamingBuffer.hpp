@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+struct __GLsync;
+
+namespace SimpleEngine {
+
+	// Persistently and coherently mapped buffer split into frames_count regions.
+	// The CPU writes into the region of the current frame while the GPU reads the previous ones;
+	// each region is guarded by a fence, so begin_frame() only waits if the GPU is frames_count frames behind.
+	class StreamingBuffer {
+	public:
+		struct Allocation {
+			void* data = nullptr;
+			size_t offset = 0; // from the start of the whole buffer, use it in draw calls and bind ranges
+			size_t size = 0;
+
+			bool is_valid() const { return data != nullptr; }
+		};
+
+		StreamingBuffer(const size_t frame_size, const unsigned int frames_count = 3);
+		~StreamingBuffer();
+
+		StreamingBuffer() = delete;
+		StreamingBuffer(const StreamingBuffer&) = delete;
+		StreamingBuffer& operator=(const StreamingBuffer&) = delete;
+		StreamingBuffer& operator=(StreamingBuffer&& streaming_buffer) noexcept;
+		StreamingBuffer(StreamingBuffer&& streaming_buffer) noexcept;
+
+		void begin_frame();
+		// returns invalid allocation if the current region is full
+		Allocation allocate(const size_t size, const size_t alignment = 16);
+		void end_frame();
+
+		unsigned int get_id() const { return m_id; }
+		size_t get_frame_size() const { return m_frame_size; }
+		unsigned int get_frames_count() const { return m_frames_count; }
+		// how many times begin_frame() had to wait for the GPU
+		uint64_t get_stalls_count() const { return m_stalls_count; }
+
+	private:
+		static constexpr unsigned int s_max_frames = 4;
+
+		unsigned int m_id = 0;
+		unsigned char* m_mapped_data = nullptr;
+		size_t m_frame_size = 0;
+		unsigned int m_frames_count = 0;
+
+		unsigned int m_current_frame = 0;
+		size_t m_frame_offset = 0;
+		__GLsync* m_fences[s_max_frames] = {};
+
+		uint64_t m_stalls_count = 0;
+	};
+
+}
@@ -0,0 +1,164 @@
+#include "Texture2D.hpp"
+#include "RenderStateCache.hpp"
+#include "SimpleEngineCore/Log.hpp"
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace SimpleEngine {
+
+	namespace {
+
+		struct TextureFormatDescription {
+			GLenum internal_format;
+			GLenum pixel_format;
+			GLenum pixel_type;
+			size_t pixel_size;
+		};
+
+		TextureFormatDescription describe_texture_format(const ETextureFormat format) {
+			switch (format) {
+			case ETextureFormat::R8:			return { GL_R8,				GL_RED,		GL_UNSIGNED_BYTE,	1 };
+			case ETextureFormat::RG8:			return { GL_RG8,			GL_RG,		GL_UNSIGNED_BYTE,	2 };
+			case ETextureFormat::RGB8:			return { GL_RGB8,			GL_RGB,		GL_UNSIGNED_BYTE,	3 };
+			case ETextureFormat::RGBA8:			return { GL_RGBA8,			GL_RGBA,	GL_UNSIGNED_BYTE,	4 };
+			case ETextureFormat::SRGB8_ALPHA8:	return { GL_SRGB8_ALPHA8,	GL_RGBA,	GL_UNSIGNED_BYTE,	4 };
+			case ETextureFormat::RGBA16F:		return { GL_RGBA16F,		GL_RGBA,	GL_HALF_FLOAT,		8 };
+			default:
+				LOG_ERROR("describe_texture_format: unknown ETextureFormat!");
+				return { GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 4 };
+			}
+		}
+
+	}
+
+	size_t texture_format_pixel_size(const ETextureFormat format) {
+		return describe_texture_format(format).pixel_size;
+	}
+
+	unsigned int calculate_mip_levels(const unsigned int width, const unsigned int height) {
+		unsigned int levels = 1;
+		for (unsigned int size = std::max(width, height); size > 1; size >>= 1)
+			++levels;
+		return levels;
+	}
+
+	Texture2D::Texture2D(const unsigned int width, const unsigned int height, const ETextureFormat format, const unsigned int mip_levels)
+		: m_width(width),
+		  m_height(height),
+		  m_mip_levels(mip_levels ? std::min(mip_levels, calculate_mip_levels(width, height)) : calculate_mip_levels(width, height)),
+		  m_format(format)
+	{
+		glCreateTextures(GL_TEXTURE_2D, 1, &m_id);
+		glTextureStorage2D(m_id, m_mip_levels, describe_texture_format(m_format).internal_format, m_width, m_height);
+	}
+
+	Texture2D::~Texture2D() {
+		RenderStateCache::forget_texture(m_id);
+		glDeleteTextures(1, &m_id);
+	}
+
+	Texture2D& Texture2D::operator=(Texture2D&& texture) noexcept {
+		std::swap(m_id, texture.m_id);
+		std::swap(m_width, texture.m_width);
+		std::swap(m_height, texture.m_height);
+		std::swap(m_mip_levels, texture.m_mip_levels);
+		std::swap(m_format, texture.m_format);
+		return *this;
+	}
+
+	Texture2D::Texture2D(Texture2D&& texture) noexcept
+		: m_id(texture.m_id),
+		  m_width(texture.m_width),
+		  m_height(texture.m_height),
+		  m_mip_levels(texture.m_mip_levels),
+		  m_format(texture.m_format)
+	{
+		texture.m_id = 0;
+		texture.m_width = 0;
+		texture.m_height = 0;
+		texture.m_mip_levels = 0;
+	}
+
+	void Texture2D::set_data(const void* data, const unsigned int mip_level) {
+		set_sub_data(data, 0, 0, std::max(m_width >> mip_level, 1u), std::max(m_height >> mip_level, 1u), mip_level);
+	}
+
+	void Texture2D::set_sub_data(const void* data, const unsigned int x_offset, const unsigned int y_offset,
+								 const unsigned int width, const unsigned int height, const unsigned int mip_level) {
+		const TextureFormatDescription description = describe_texture_format(m_format);
+		glTextureSubImage2D(m_id, mip_level, x_offset, y_offset, width, height, description.pixel_format, description.pixel_type, data);
+	}
+
+	void Texture2D::generate_mipmaps() {
+		if (m_mip_levels > 1)
+			glGenerateTextureMipmap(m_id);
+	}
+
+	void Texture2D::bind(const unsigned int unit) const {
+		RenderStateCache::bind_texture_unit(unit, m_id);
+	}
+
+	Texture2DArray::Texture2DArray(const unsigned int width, const unsigned int height, const unsigned int layers,
+								   const ETextureFormat format, const unsigned int mip_levels)
+		: m_width(width),
+		  m_height(height),
+		  m_layers(layers),
+		  m_mip_levels(mip_levels ? std::min(mip_levels, calculate_mip_levels(width, height)) : calculate_mip_levels(width, height)),
+		  m_format(format)
+	{
+		glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &m_id);
+		glTextureStorage3D(m_id, m_mip_levels, describe_texture_format(m_format).internal_format, m_width, m_height, m_layers);
+	}
+
+	Texture2DArray::~Texture2DArray() {
+		RenderStateCache::forget_texture(m_id);
+		glDeleteTextures(1, &m_id);
+	}
+
+	Texture2DArray& Texture2DArray::operator=(Texture2DArray&& texture) noexcept {
+		std::swap(m_id, texture.m_id);
+		std::swap(m_width, texture.m_width);
+		std::swap(m_height, texture.m_height);
+		std::swap(m_layers, texture.m_layers);
+		std::swap(m_mip_levels, texture.m_mip_levels);
+		std::swap(m_format, texture.m_format);
+		return *this;
+	}
+
+	Texture2DArray::Texture2DArray(Texture2DArray&& texture) noexcept
+		: m_id(texture.m_id),
+		  m_width(texture.m_width),
+		  m_height(texture.m_height),
+		  m_layers(texture.m_layers),
+		  m_mip_levels(texture.m_mip_levels),
+		  m_format(texture.m_format)
+	{
+		texture.m_id = 0;
+		texture.m_width = 0;
+		texture.m_height = 0;
+		texture.m_layers = 0;
+		texture.m_mip_levels = 0;
+	}
+
+	void Texture2DArray::set_layer_data(const unsigned int layer, const void* data, const unsigned int mip_level) {
+		set_layer_sub_data(layer, data, 0, 0, std::max(m_width >> mip_level, 1u), std::max(m_height >> mip_level, 1u), mip_level);
+	}
+
+	void Texture2DArray::set_layer_sub_data(const unsigned int layer, const void* data, const unsigned int x_offset, const unsigned int y_offset,
+											const unsigned int width, const unsigned int height, const unsigned int mip_level) {
+		const TextureFormatDescription description = describe_texture_format(m_format);
+		glTextureSubImage3D(m_id, mip_level, x_offset, y_offset, layer, width, height, 1, description.pixel_format, description.pixel_type, data);
+	}
+
+	void Texture2DArray::generate_mipmaps() {
+		if (m_mip_levels > 1)
+			glGenerateTextureMipmap(m_id);
+	}
+
+	void Texture2DArray::bind(const unsigned int unit) const {
+		RenderStateCache::bind_texture_unit(unit, m_id);
+	}
+
+}
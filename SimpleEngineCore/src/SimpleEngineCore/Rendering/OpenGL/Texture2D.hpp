@@ -0,0 +1,88 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace SimpleEngine {
+
+	enum class ETextureFormat {
+		R8,
+		RG8,
+		RGB8,
+		RGBA8,
+		SRGB8_ALPHA8,
+		RGBA16F
+	};
+
+	size_t texture_format_pixel_size(const ETextureFormat format);
+	unsigned int calculate_mip_levels(const unsigned int width, const unsigned int height);
+
+	class Texture2D {
+	public:
+		// mip_levels = 0 - full chain down to 1x1
+		Texture2D(const unsigned int width, const unsigned int height, const ETextureFormat format, const unsigned int mip_levels = 0);
+		~Texture2D();
+
+		Texture2D() = delete;
+		Texture2D(const Texture2D&) = delete;
+		Texture2D& operator=(const Texture2D&) = delete;
+		Texture2D& operator=(Texture2D&& texture) noexcept;
+		Texture2D(Texture2D&& texture) noexcept;
+
+		// data is tightly packed pixels of the texture format
+		void set_data(const void* data, const unsigned int mip_level = 0);
+		void set_sub_data(const void* data, const unsigned int x_offset, const unsigned int y_offset,
+						  const unsigned int width, const unsigned int height, const unsigned int mip_level = 0);
+		// fills levels 1..N from level 0
+		void generate_mipmaps();
+		void bind(const unsigned int unit) const;
+
+		unsigned int get_id() const { return m_id; }
+		unsigned int get_width() const { return m_width; }
+		unsigned int get_height() const { return m_height; }
+		unsigned int get_mip_levels() const { return m_mip_levels; }
+		ETextureFormat get_format() const { return m_format; }
+
+	private:
+		unsigned int m_id = 0;
+		unsigned int m_width = 0;
+		unsigned int m_height = 0;
+		unsigned int m_mip_levels = 0;
+		ETextureFormat m_format = ETextureFormat::RGBA8;
+	};
+
+	class Texture2DArray {
+	public:
+		// mip_levels = 0 - full chain down to 1x1
+		Texture2DArray(const unsigned int width, const unsigned int height, const unsigned int layers,
+					   const ETextureFormat format, const unsigned int mip_levels = 0);
+		~Texture2DArray();
+
+		Texture2DArray() = delete;
+		Texture2DArray(const Texture2DArray&) = delete;
+		Texture2DArray& operator=(const Texture2DArray&) = delete;
+		Texture2DArray& operator=(Texture2DArray&& texture) noexcept;
+		Texture2DArray(Texture2DArray&& texture) noexcept;
+
+		void set_layer_data(const unsigned int layer, const void* data, const unsigned int mip_level = 0);
+		void set_layer_sub_data(const unsigned int layer, const void* data, const unsigned int x_offset, const unsigned int y_offset,
+								const unsigned int width, const unsigned int height, const unsigned int mip_level = 0);
+		void generate_mipmaps();
+		void bind(const unsigned int unit) const;
+
+		unsigned int get_id() const { return m_id; }
+		unsigned int get_width() const { return m_width; }
+		unsigned int get_height() const { return m_height; }
+		unsigned int get_layers() const { return m_layers; }
+		unsigned int get_mip_levels() const { return m_mip_levels; }
+		ETextureFormat get_format() const { return m_format; }
+
+	private:
+		unsigned int m_id = 0;
+		unsigned int m_width = 0;
+		unsigned int m_height = 0;
+		unsigned int m_layers = 0;
+		unsigned int m_mip_levels = 0;
+		ETextureFormat m_format = ETextureFormat::RGBA8;
+	};
+
+}
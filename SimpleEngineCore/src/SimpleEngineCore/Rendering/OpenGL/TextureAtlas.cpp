@@ -0,0 +1,140 @@
+#include "TextureAtlas.hpp"
+#include "SimpleEngineCore/Log.hpp"
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace SimpleEngine {
+
+	TextureAtlas::TextureAtlas(const unsigned int layer_width, const unsigned int layer_height, const ETextureFormat format,
+							   const unsigned int max_layers, const unsigned int initial_layers,
+							   const unsigned int padding, const unsigned int mip_levels)
+		: m_texture(layer_width, layer_height, std::clamp(initial_layers, 1u, std::max(max_layers, 1u)), format, mip_levels),
+		  m_packers(m_texture.get_layers(), RectPacker(layer_width, layer_height)),
+		  m_max_layers(std::max(max_layers, 1u)),
+		  m_padding(padding)
+	{
+	}
+
+	TextureAtlas::Handle TextureAtlas::insert(const void* data, const unsigned int width, const unsigned int height) {
+		const unsigned int padded_width = width + 2 * m_padding;
+		const unsigned int padded_height = height + 2 * m_padding;
+		if (width == 0 || height == 0 || padded_width > m_texture.get_width() || padded_height > m_texture.get_height()) {
+			LOG_ERROR("TextureAtlas: image {0}x{1} does not fit into {2}x{3} layer", width, height, m_texture.get_width(), m_texture.get_height());
+			return s_invalid_handle;
+		}
+
+		PackedRect rect;
+		unsigned int layer = 0;
+		while (layer < m_packers.size() && !m_packers[layer].insert(padded_width, padded_height, rect))
+			++layer;
+		if (layer == m_packers.size()) {
+			if (!grow() || !m_packers[layer].insert(padded_width, padded_height, rect)) {
+				LOG_WARN("TextureAtlas: no space left for {0}x{1} image", width, height);
+				return s_invalid_handle;
+			}
+		}
+
+		upload_padded(data, width, height, rect, layer);
+
+		const float layer_width = static_cast<float>(m_texture.get_width());
+		const float layer_height = static_cast<float>(m_texture.get_height());
+		Entry entry;
+		entry.rect = rect;
+		entry.region.u_min = (rect.x + m_padding) / layer_width;
+		entry.region.v_min = (rect.y + m_padding) / layer_height;
+		entry.region.u_max = (rect.x + m_padding + width) / layer_width;
+		entry.region.v_max = (rect.y + m_padding + height) / layer_height;
+		entry.region.layer = layer;
+		entry.is_alive = true;
+
+		if (!m_free_handles.empty()) {
+			const Handle handle = m_free_handles.back();
+			m_free_handles.pop_back();
+			m_entries[handle] = entry;
+			return handle;
+		}
+		m_entries.push_back(entry);
+		return static_cast<Handle>(m_entries.size() - 1);
+	}
+
+	bool TextureAtlas::evict(const Handle handle) {
+		if (!is_valid(handle))
+			return false;
+
+		Entry& entry = m_entries[handle];
+		m_packers[entry.region.layer].free(entry.rect);
+		entry.is_alive = false;
+		m_free_handles.push_back(handle);
+		return true;
+	}
+
+	bool TextureAtlas::is_valid(const Handle handle) const {
+		return handle < m_entries.size() && m_entries[handle].is_alive;
+	}
+
+	void TextureAtlas::bind(const unsigned int unit) const {
+		m_texture.bind(unit);
+	}
+
+	void TextureAtlas::generate_mipmaps() {
+		m_texture.generate_mipmaps();
+	}
+
+	float TextureAtlas::get_occupancy() const {
+		float occupancy = 0.f;
+		for (const RectPacker& packer : m_packers)
+			occupancy += packer.get_occupancy();
+		return occupancy / m_packers.size();
+	}
+
+	bool TextureAtlas::grow() {
+		const unsigned int layers = m_texture.get_layers();
+		if (layers >= m_max_layers)
+			return false;
+
+		const unsigned int new_layers = std::min(layers * 2, m_max_layers);
+		Texture2DArray texture(m_texture.get_width(), m_texture.get_height(), new_layers, m_texture.get_format(), m_texture.get_mip_levels());
+		for (unsigned int level = 0; level < m_texture.get_mip_levels(); ++level) {
+			glCopyImageSubData(m_texture.get_id(), GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+							   texture.get_id(), GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+							   std::max(m_texture.get_width() >> level, 1u), std::max(m_texture.get_height() >> level, 1u), layers);
+		}
+		m_texture = std::move(texture);
+		m_packers.resize(new_layers, RectPacker(m_texture.get_width(), m_texture.get_height()));
+
+		LOG_INFO("TextureAtlas: grown to {0} layers", new_layers);
+		return true;
+	}
+
+	void TextureAtlas::upload_padded(const void* data, const unsigned int width, const unsigned int height, const PackedRect& rect, const unsigned int layer) {
+		if (m_padding == 0) {
+			m_texture.set_layer_sub_data(layer, data, rect.x, rect.y, width, height);
+			return;
+		}
+
+		// extrude the edge pixels into the padding, so linear filtering at the border of the region
+		// samples the image itself instead of its neighbour
+		const size_t pixel_size = texture_format_pixel_size(m_texture.get_format());
+		const size_t source_row_size = width * pixel_size;
+		const size_t row_size = rect.width * pixel_size;
+		m_padded_image.resize(row_size * rect.height);
+
+		const unsigned char* source = static_cast<const unsigned char*>(data);
+		for (unsigned int y = 0; y < rect.height; ++y) {
+			const unsigned int source_y = std::min(y > m_padding ? y - m_padding : 0u, height - 1);
+			const unsigned char* source_row = source + source_y * source_row_size;
+			unsigned char* row = m_padded_image.data() + y * row_size;
+
+			for (unsigned int x = 0; x < m_padding; ++x) {
+				std::memcpy(row + x * pixel_size, source_row, pixel_size);
+				std::memcpy(row + (m_padding + width + x) * pixel_size, source_row + source_row_size - pixel_size, pixel_size);
+			}
+			std::memcpy(row + m_padding * pixel_size, source_row, source_row_size);
+		}
+
+		m_texture.set_layer_sub_data(layer, m_padded_image.data(), rect.x, rect.y, rect.width, rect.height);
+	}
+
+}
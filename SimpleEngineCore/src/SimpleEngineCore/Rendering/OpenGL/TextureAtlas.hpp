@@ -0,0 +1,73 @@
+#pragma once
+#include "Texture2D.hpp"
+#include "SimpleEngineCore/Rendering/RectPacker.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace SimpleEngine {
+
+	struct AtlasRegion {
+		float u_min = 0.f;
+		float v_min = 0.f;
+		float u_max = 0.f;
+		float v_max = 0.f;
+		unsigned int layer = 0;
+	};
+
+	// Packs many small images into the layers of one Texture2DArray, so everything drawn from
+	// the atlas shares a single texture binding and can end up in the same (multi)draw.
+	// Images keep a padding of their own edge pixels against filtering bleed.
+	class TextureAtlas {
+	public:
+		using Handle = uint32_t;
+		static constexpr Handle s_invalid_handle = ~0u;
+
+		// starts with initial_layers and doubles the array, up to max_layers, when an image does not fit
+		TextureAtlas(const unsigned int layer_width, const unsigned int layer_height, const ETextureFormat format,
+					 const unsigned int max_layers = 16, const unsigned int initial_layers = 1,
+					 const unsigned int padding = 1, const unsigned int mip_levels = 1);
+
+		TextureAtlas() = delete;
+		TextureAtlas(const TextureAtlas&) = delete;
+		TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+		// data is tightly packed pixels of the atlas format,
+		// returns s_invalid_handle if the image does not fit even after growing
+		Handle insert(const void* data, const unsigned int width, const unsigned int height);
+		// frees the area of the image, its texels are overwritten by later inserts
+		bool evict(const Handle handle);
+
+		bool is_valid(const Handle handle) const;
+		const AtlasRegion& get_region(const Handle handle) const { return m_entries[handle].region; }
+
+		// the texture object is recreated when the atlas grows, bind it again after inserts
+		void bind(const unsigned int unit) const;
+		void generate_mipmaps();
+		const Texture2DArray& get_texture() const { return m_texture; }
+
+		unsigned int get_layers_count() const { return m_texture.get_layers(); }
+		size_t get_images_count() const { return m_entries.size() - m_free_handles.size(); }
+		float get_occupancy() const;
+
+	private:
+		struct Entry {
+			PackedRect rect; // includes padding
+			AtlasRegion region;
+			bool is_alive = false;
+		};
+
+		bool grow();
+		void upload_padded(const void* data, const unsigned int width, const unsigned int height, const PackedRect& rect, const unsigned int layer);
+
+		Texture2DArray m_texture;
+		std::vector<RectPacker> m_packers; // one per layer
+		std::vector<Entry> m_entries;
+		std::vector<Handle> m_free_handles;
+		std::vector<unsigned char> m_padded_image;
+
+		unsigned int m_max_layers = 0;
+		unsigned int m_padding = 0;
+	};
+
+}
@@ -0,0 +1,44 @@
+#include "TexturePool.hpp"
+
+#include <algorithm>
+
+namespace SimpleEngine {
+
+	uint64_t TexturePool::make_key(const unsigned int width, const unsigned int height, const ETextureFormat format, const unsigned int mip_levels) {
+		const unsigned int levels = mip_levels ? std::min(mip_levels, calculate_mip_levels(width, height)) : calculate_mip_levels(width, height);
+		return static_cast<uint64_t>(width)
+			| static_cast<uint64_t>(height) << 24
+			| static_cast<uint64_t>(levels) << 48
+			| static_cast<uint64_t>(format) << 56;
+	}
+
+	Texture2D TexturePool::acquire(const unsigned int width, const unsigned int height, const ETextureFormat format, const unsigned int mip_levels) {
+		const auto it = m_free_textures.find(make_key(width, height, format, mip_levels));
+		if (it != m_free_textures.end() && !it->second.empty()) {
+			Texture2D texture = std::move(it->second.back());
+			it->second.pop_back();
+			++m_reused_count;
+			return texture;
+		}
+		return Texture2D(width, height, format, mip_levels);
+	}
+
+	void TexturePool::release(Texture2D&& texture) {
+		if (texture.get_id() == 0)
+			return;
+		const uint64_t key = make_key(texture.get_width(), texture.get_height(), texture.get_format(), texture.get_mip_levels());
+		m_free_textures[key].push_back(std::move(texture));
+	}
+
+	void TexturePool::clear() {
+		m_free_textures.clear();
+	}
+
+	size_t TexturePool::get_free_textures_count() const {
+		size_t count = 0;
+		for (const auto& [key, textures] : m_free_textures)
+			count += textures.size();
+		return count;
+	}
+
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "Texture2D.hpp"
+
+#include <unordered_map>
+#include <vector>
+
+namespace SimpleEngine {
+
+	// Keeps released textures and hands their storage out again to requests of the same
+	// format, size and mip count, instead of deleting and reallocating it.
+	class TexturePool {
+	public:
+		TexturePool() = default;
+		TexturePool(const TexturePool&) = delete;
+		TexturePool& operator=(const TexturePool&) = delete;
+
+		// mip_levels = 0 - full chain, contents of a reused texture are undefined
+		Texture2D acquire(const unsigned int width, const unsigned int height, const ETextureFormat format, const unsigned int mip_levels = 0);
+		void release(Texture2D&& texture);
+		// deletes all free textures, must be called while the GL context is alive
+		void clear();
+
+		size_t get_free_textures_count() const;
+		size_t get_reused_count() const { return m_reused_count; }
+
+	private:
+		static uint64_t make_key(const unsigned int width, const unsigned int height, const ETextureFormat format, const unsigned int mip_levels);
+
+		std::unordered_map<uint64_t, std::vector<Texture2D>> m_free_textures;
+		size_t m_reused_count = 0;
+	};
+
+}
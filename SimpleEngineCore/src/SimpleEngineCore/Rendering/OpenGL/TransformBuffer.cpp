@@ -0,0 +1,63 @@
+#include "TransformBuffer.hpp"
+#include "RenderStateCache.hpp"
+#include "StreamingBuffer.hpp"
+#include "SimpleEngineCore/Log.hpp"
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace SimpleEngine {
+
+	TransformBuffer::TransformBuffer() = default;
+
+	TransformBuffer::~TransformBuffer() {
+		if (m_id) {
+			RenderStateCache::forget_buffer(m_id);
+			glDeleteBuffers(1, &m_id);
+		}
+	}
+
+	void TransformBuffer::upload(const glm::mat4* matrices, const size_t first, const size_t count, const size_t total_count) {
+		if (total_count > m_capacity)
+			reserve(std::max<size_t>(total_count, m_capacity * 2));
+		if (count == 0)
+			return;
+
+		const size_t size = count * sizeof(glm::mat4);
+		if (!m_staging_buffer || m_staging_buffer->get_frame_size() < size) {
+			const size_t frame_size = std::max(size * 2, s_min_staging_buffer_size);
+			m_staging_buffer = std::make_unique<StreamingBuffer>(frame_size);
+		}
+
+		m_staging_buffer->begin_frame();
+		const StreamingBuffer::Allocation allocation = m_staging_buffer->allocate(size, sizeof(glm::vec4));
+		if (!allocation.is_valid()) {
+			LOG_ERROR("TransformBuffer: failed to allocate {0} bytes for matrices", size);
+			return;
+		}
+		std::memcpy(allocation.data, matrices, size);
+		glCopyNamedBufferSubData(m_staging_buffer->get_id(), m_id, allocation.offset, first * sizeof(glm::mat4), size);
+		m_staging_buffer->end_frame();
+	}
+
+	void TransformBuffer::bind() const {
+		if (m_id)
+			RenderStateCache::bind_buffer_base(GL_SHADER_STORAGE_BUFFER, s_binding, m_id);
+	}
+
+	void TransformBuffer::reserve(const size_t capacity) {
+		// immutable storage can't grow, the matrices that didn't change are copied into the new buffer
+		unsigned int id = 0;
+		glCreateBuffers(1, &id);
+		glNamedBufferStorage(id, capacity * sizeof(glm::mat4), nullptr, 0);
+		if (m_id) {
+			glCopyNamedBufferSubData(m_id, id, 0, 0, m_capacity * sizeof(glm::mat4));
+			RenderStateCache::forget_buffer(m_id);
+			glDeleteBuffers(1, &m_id);
+		}
+		m_id = id;
+		m_capacity = capacity;
+	}
+
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "glm/mat4x4.hpp"
+
+#include <cstddef>
+#include <memory>
+
+namespace SimpleEngine {
+	class StreamingBuffer;
+
+	// World matrices of a TransformHierarchy in one shader storage buffer, indexed by the node index:
+	//
+	// layout(std430, binding = 1) readonly buffer ModelMatrices {
+	//     mat4 model_matrices[];
+	// };
+	//
+	// Draws pass the index of their node as base instance and read model_matrices[gl_BaseInstance + gl_InstanceID].
+	// Only the range changed by the last update is uploaded: it is written into a StreamingBuffer
+	// and copied into the storage buffer on the GPU.
+	class TransformBuffer {
+	public:
+		static constexpr unsigned int s_binding = 1;
+		static constexpr size_t s_min_staging_buffer_size = 64 * 1024;
+
+		TransformBuffer();
+		~TransformBuffer();
+
+		TransformBuffer(const TransformBuffer&) = delete;
+		TransformBuffer& operator=(const TransformBuffer&) = delete;
+
+		// matrices holds [first, first + count) of total_count matrices; the buffer grows keeping the rest
+		void upload(const glm::mat4* matrices, const size_t first, const size_t count, const size_t total_count);
+		void bind() const;
+
+		unsigned int get_id() const { return m_id; }
+		size_t get_capacity() const { return m_capacity; }
+
+	private:
+		void reserve(const size_t capacity);
+
+		unsigned int m_id = 0;
+		size_t m_capacity = 0;
+		std::unique_ptr<StreamingBuffer> m_staging_buffer;
+	};
+
+}
@@ -0,0 +1,255 @@
+#include "UploadQueue.hpp"
+#include "RenderStateCache.hpp"
+#include "Texture2D.hpp"
+#include "SimpleEngineCore/Log.hpp"
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+namespace SimpleEngine {
+
+	constexpr size_t s_staging_alignment = 16;
+
+	UploadQueue::UploadQueue(const size_t staging_size, const size_t bytes_per_frame)
+		: m_staging_size(staging_size),
+		  m_bytes_per_frame(bytes_per_frame)
+	{
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glCreateBuffers(1, &m_staging_id);
+		glNamedBufferStorage(m_staging_id, m_staging_size, nullptr, flags);
+		m_staging_data = static_cast<unsigned char*>(glMapNamedBufferRange(m_staging_id, 0, m_staging_size, flags));
+		if (!m_staging_data)
+			LOG_CRITICAL("UploadQueue: failed to map {0} bytes of staging memory", m_staging_size);
+	}
+
+	UploadQueue::~UploadQueue() {
+		// running producers write into the staging memory, it can only be unmapped once they are done
+		m_is_stopping.store(true, std::memory_order_relaxed);
+		JobSystem::wait(m_producers);
+
+		for (const std::shared_ptr<Request>& request : m_requests) {
+			glDeleteSync(request->fence);
+			request->state->store(EUploadState::Failed, std::memory_order_release);
+		}
+
+		if (m_staging_data)
+			glUnmapNamedBuffer(m_staging_id);
+		RenderStateCache::forget_buffer(m_staging_id);
+		glDeleteBuffers(1, &m_staging_id);
+	}
+
+	UploadHandle UploadQueue::upload_texture(Texture2D& texture, const unsigned int x_offset, const unsigned int y_offset,
+											 const unsigned int width, const unsigned int height, const unsigned int mip_level,
+											 Producer producer, Callback on_ready) {
+		Request request;
+		request.target = ETarget::Texture2D;
+		request.texture = &texture;
+		request.x_offset = x_offset;
+		request.y_offset = y_offset;
+		request.width = width;
+		request.height = height;
+		request.mip_level = mip_level;
+		request.size = static_cast<size_t>(width) * height * texture_format_pixel_size(texture.get_format());
+		request.producer = std::move(producer);
+		request.on_ready = std::move(on_ready);
+		return submit(std::move(request));
+	}
+
+	UploadHandle UploadQueue::upload_texture_layer(Texture2DArray& texture, const unsigned int layer, const unsigned int x_offset, const unsigned int y_offset,
+												   const unsigned int width, const unsigned int height, const unsigned int mip_level,
+												   Producer producer, Callback on_ready) {
+		Request request;
+		request.target = ETarget::Texture2DArray;
+		request.texture_array = &texture;
+		request.layer = layer;
+		request.x_offset = x_offset;
+		request.y_offset = y_offset;
+		request.width = width;
+		request.height = height;
+		request.mip_level = mip_level;
+		request.size = static_cast<size_t>(width) * height * texture_format_pixel_size(texture.get_format());
+		request.producer = std::move(producer);
+		request.on_ready = std::move(on_ready);
+		return submit(std::move(request));
+	}
+
+	UploadHandle UploadQueue::upload_buffer(const unsigned int buffer_id, const size_t offset, const size_t size,
+											Producer producer, Callback on_ready) {
+		Request request;
+		request.target = ETarget::Buffer;
+		request.buffer_id = buffer_id;
+		request.destination_offset = offset;
+		request.size = size;
+		request.producer = std::move(producer);
+		request.on_ready = std::move(on_ready);
+		return submit(std::move(request));
+	}
+
+	UploadHandle UploadQueue::submit(Request&& request) {
+		auto state = std::make_shared<std::atomic<EUploadState>>(EUploadState::Producing);
+		if (!m_staging_data || request.size == 0 || request.size > m_staging_size) {
+			LOG_ERROR("UploadQueue: can't upload {0} bytes through {1} bytes of staging memory", request.size, m_staging_size);
+			state->store(EUploadState::Failed);
+			return UploadHandle(std::move(state));
+		}
+
+		request.state = state;
+		m_requests.push_back(std::make_shared<Request>(std::move(request)));
+		// producers start in submission order, a request waits for staging memory in update() otherwise
+		if (m_requests.size() == 1 || m_requests[m_requests.size() - 2]->is_staged)
+			allocate_staging(*m_requests.back());
+		return UploadHandle(std::move(state));
+	}
+
+	bool UploadQueue::allocate_staging(Request& request) {
+		const size_t size = (request.size + s_staging_alignment - 1) / s_staging_alignment * s_staging_alignment;
+
+		size_t offset = 0;
+		if (m_staging_regions.empty()) {
+			m_staging_head = 0;
+			m_staging_tail = 0;
+			offset = 0;
+		}
+		else if (m_staging_head > m_staging_tail) {
+			// free space is [head, end) and [0, tail)
+			if (m_staging_head + size <= m_staging_size) {
+				offset = m_staging_head;
+			}
+			else if (size <= m_staging_tail) {
+				// the end of the ring is skipped, it is given back together with the next region
+				m_staging_regions.push_back({ m_staging_head, m_staging_size - m_staging_head, true });
+				offset = 0;
+			}
+			else {
+				return false;
+			}
+		}
+		else if (m_staging_head + size <= m_staging_tail) {
+			offset = m_staging_head;
+		}
+		else {
+			return false;
+		}
+		if (offset + size > m_staging_size)
+			return false;
+
+		m_staging_regions.push_back({ offset, size, false });
+		m_staging_head = offset + size;
+
+		request.staging_offset = offset;
+		request.is_staged = true;
+
+		const std::shared_ptr<Request> job = *std::find_if(m_requests.begin(), m_requests.end(),
+			[&request](const std::shared_ptr<Request>& queued) { return queued.get() == &request; });
+		JobSystem::run([this, job]() { produce(*job); }, &m_producers);
+		return true;
+	}
+
+	void UploadQueue::release_staging(const size_t offset) {
+		const auto it = std::find_if(m_staging_regions.begin(), m_staging_regions.end(),
+			[offset](const StagingRegion& region) { return region.offset == offset && !region.is_released; });
+		if (it != m_staging_regions.end())
+			it->is_released = true;
+
+		while (!m_staging_regions.empty() && m_staging_regions.front().is_released) {
+			m_staging_tail = m_staging_regions.front().offset + m_staging_regions.front().size;
+			m_staging_regions.pop_front();
+		}
+		if (m_staging_tail == m_staging_size)
+			m_staging_tail = 0;
+	}
+
+	void UploadQueue::issue_copy(Request& request) {
+		const void* staging_offset = reinterpret_cast<const void*>(request.staging_offset);
+		switch (request.target) {
+		case ETarget::Texture2D:
+			RenderStateCache::bind_buffer(GL_PIXEL_UNPACK_BUFFER, m_staging_id);
+			request.texture->set_sub_data(staging_offset, request.x_offset, request.y_offset, request.width, request.height, request.mip_level);
+			break;
+		case ETarget::Texture2DArray:
+			RenderStateCache::bind_buffer(GL_PIXEL_UNPACK_BUFFER, m_staging_id);
+			request.texture_array->set_layer_sub_data(request.layer, staging_offset, request.x_offset, request.y_offset,
+													  request.width, request.height, request.mip_level);
+			break;
+		case ETarget::Buffer:
+			glCopyNamedBufferSubData(m_staging_id, request.buffer_id, request.staging_offset, request.destination_offset, request.size);
+			break;
+		}
+		request.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		request.state->store(EUploadState::Copying, std::memory_order_release);
+	}
+
+	void UploadQueue::update() {
+		// start producers for the requests that wait for staging memory
+		for (const std::shared_ptr<Request>& request : m_requests) {
+			if (!request->is_staged && !allocate_staging(*request))
+				break;
+		}
+
+		// issue produced copies, oldest first; the first one always goes,
+		// so a request larger than the budget still makes progress
+		size_t issued_bytes = 0;
+		for (const std::shared_ptr<Request>& request : m_requests) {
+			if (request->state->load(std::memory_order_acquire) != EUploadState::Produced)
+				continue;
+			if (issued_bytes > 0 && issued_bytes + request->size > m_bytes_per_frame)
+				break;
+			issue_copy(*request);
+			issued_bytes += request->size;
+		}
+		if (issued_bytes > 0)
+			RenderStateCache::bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0); // client memory uploads elsewhere
+
+		// retire completed and failed requests
+		for (const std::shared_ptr<Request>& request : m_requests) {
+			const EUploadState state = request->state->load(std::memory_order_acquire);
+			if (state == EUploadState::Copying) {
+				const GLenum result = glClientWaitSync(request->fence, 0, 0);
+				if (result == GL_TIMEOUT_EXPIRED)
+					continue;
+				if (result == GL_WAIT_FAILED)
+					LOG_ERROR("UploadQueue: glClientWaitSync failed");
+				glDeleteSync(request->fence);
+				request->fence = nullptr;
+				release_staging(request->staging_offset);
+				if (request->on_ready)
+					request->on_ready();
+				request->state->store(EUploadState::Ready, std::memory_order_release);
+			}
+			else if (state == EUploadState::Failed) {
+				release_staging(request->staging_offset);
+			}
+		}
+		m_requests.erase(std::remove_if(m_requests.begin(), m_requests.end(), [](const std::shared_ptr<Request>& request) {
+			const EUploadState state = request->state->load(std::memory_order_acquire);
+			return state == EUploadState::Ready || state == EUploadState::Failed;
+		}), m_requests.end());
+	}
+
+	void UploadQueue::flush() {
+		const size_t bytes_per_frame = m_bytes_per_frame;
+		m_bytes_per_frame = std::numeric_limits<size_t>::max();
+		while (!m_requests.empty()) {
+			update();
+			glFlush();
+			// this thread runs the pending producers instead of idling
+			JobSystem::wait(m_producers);
+			std::this_thread::yield();
+		}
+		m_bytes_per_frame = bytes_per_frame;
+	}
+
+	void UploadQueue::produce(Request& request) {
+		if (m_is_stopping.load(std::memory_order_relaxed)) {
+			request.state->store(EUploadState::Failed, std::memory_order_release);
+			return;
+		}
+		const bool is_produced = request.producer(m_staging_data + request.staging_offset, request.size);
+		if (!is_produced)
+			LOG_ERROR("UploadQueue: producer of {0} bytes failed", request.size);
+		request.state->store(is_produced ? EUploadState::Produced : EUploadState::Failed, std::memory_order_release);
+	}
+
+}
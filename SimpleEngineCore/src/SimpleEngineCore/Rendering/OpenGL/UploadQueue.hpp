@@ -0,0 +1,133 @@
+#pragma once
+#include "SimpleEngineCore/Jobs/JobSystem.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+
+struct __GLsync;
+
+namespace SimpleEngine {
+	class Texture2D;
+	class Texture2DArray;
+
+	enum class EUploadState : uint8_t {
+		Producing,	// producer is running as a JobSystem job
+		Produced,	// data is in the staging buffer, the copy is not issued yet
+		Copying,	// copy is issued, waiting for its fence
+		Ready,
+		Failed
+	};
+
+	// Shared with the queue; stays valid after the queue is destroyed.
+	class UploadHandle {
+	public:
+		UploadHandle() = default;
+
+		bool is_valid() const { return m_state != nullptr; }
+		bool is_ready() const { return m_state && m_state->load(std::memory_order_acquire) == EUploadState::Ready; }
+		bool is_failed() const { return !m_state || m_state->load(std::memory_order_acquire) == EUploadState::Failed; }
+		EUploadState get_state() const { return m_state ? m_state->load(std::memory_order_acquire) : EUploadState::Failed; }
+
+	private:
+		friend class UploadQueue;
+		explicit UploadHandle(std::shared_ptr<std::atomic<EUploadState>> state) : m_state(std::move(state)) {}
+
+		std::shared_ptr<std::atomic<EUploadState>> m_state;
+	};
+
+	// Asynchronous uploads through a persistently mapped staging buffer.
+	// Producers write the data straight into staging memory as JobSystem jobs, update() issues
+	// the GL copies on the GL thread within a per-frame byte budget and fences them.
+	// All methods except the producers must be called from the GL thread.
+	class UploadQueue {
+	public:
+		// producer writes exactly the requested number of bytes to destination, returns false on failure
+		using Producer = std::function<bool(void* destination, size_t size)>;
+		// called from update() on the GL thread after the copy has completed, e.g. to generate mipmaps
+		using Callback = std::function<void()>;
+
+		UploadQueue(const size_t staging_size = 32 * 1024 * 1024, const size_t bytes_per_frame = 4 * 1024 * 1024);
+		~UploadQueue();
+
+		UploadQueue(const UploadQueue&) = delete;
+		UploadQueue& operator=(const UploadQueue&) = delete;
+
+		// the destination objects must stay alive (and not be moved) until the handle is ready or failed
+		UploadHandle upload_texture(Texture2D& texture, const unsigned int x_offset, const unsigned int y_offset,
+									const unsigned int width, const unsigned int height, const unsigned int mip_level,
+									Producer producer, Callback on_ready = nullptr);
+		UploadHandle upload_texture_layer(Texture2DArray& texture, const unsigned int layer, const unsigned int x_offset, const unsigned int y_offset,
+										  const unsigned int width, const unsigned int height, const unsigned int mip_level,
+										  Producer producer, Callback on_ready = nullptr);
+		UploadHandle upload_buffer(const unsigned int buffer_id, const size_t offset, const size_t size,
+								   Producer producer, Callback on_ready = nullptr);
+
+		// once per frame: starts queued producers, issues produced copies and retires completed ones
+		void update();
+		// blocks until every submitted upload is ready or failed
+		void flush();
+
+		size_t get_pending_count() const { return m_requests.size(); }
+		size_t get_bytes_per_frame() const { return m_bytes_per_frame; }
+
+	private:
+		enum class ETarget : uint8_t {
+			Texture2D,
+			Texture2DArray,
+			Buffer
+		};
+
+		struct Request {
+			ETarget target;
+			Texture2D* texture = nullptr;
+			Texture2DArray* texture_array = nullptr;
+			unsigned int buffer_id = 0;
+			unsigned int layer = 0;
+			unsigned int x_offset = 0;
+			unsigned int y_offset = 0;
+			unsigned int width = 0;
+			unsigned int height = 0;
+			unsigned int mip_level = 0;
+			size_t destination_offset = 0;
+			size_t size = 0;
+
+			size_t staging_offset = 0;
+			bool is_staged = false;
+			__GLsync* fence = nullptr;
+
+			Producer producer;
+			Callback on_ready;
+			std::shared_ptr<std::atomic<EUploadState>> state;
+		};
+
+		struct StagingRegion {
+			size_t offset;
+			size_t size;
+			bool is_released;
+		};
+
+		UploadHandle submit(Request&& request);
+		bool allocate_staging(Request& request);
+		void release_staging(const size_t offset);
+		void issue_copy(Request& request);
+		void produce(Request& request);
+
+		unsigned int m_staging_id = 0;
+		unsigned char* m_staging_data = nullptr;
+		size_t m_staging_size = 0;
+		size_t m_staging_head = 0;
+		size_t m_staging_tail = 0;
+		std::deque<StagingRegion> m_staging_regions; // in allocation order
+
+		size_t m_bytes_per_frame = 0;
+		std::deque<std::shared_ptr<Request>> m_requests; // in submission order
+
+		JobCounter m_producers;
+		std::atomic<bool> m_is_stopping{ false }; // producers that have not started yet fail right away
+	};
+
+}
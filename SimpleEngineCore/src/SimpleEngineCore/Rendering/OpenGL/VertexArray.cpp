@@ -1,58 +1,132 @@
 #include "SimpleEngineCore/Rendering/OpenGL/VertexArray.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/RenderStateCache.hpp"
+#include "SimpleEngineCore/Log.hpp"
 #include "glad/glad.h"
 
+#include <algorithm>
+
 namespace SimpleEngine {
 	VertexArray::VertexArray() {
-		glGenVertexArrays(1, &m_id);
+		glCreateVertexArrays(1, &m_id);
 	}
 
 	VertexArray::~VertexArray() {
+		RenderStateCache::forget_vertex_array(m_id);
 		glDeleteVertexArrays(1, &m_id);
 	}
 
 	VertexArray& VertexArray::operator=(VertexArray&& vertex_array) noexcept {
 		m_id = vertex_array.m_id;
 		m_elements_count = vertex_array.m_elements_count;
+		m_bindings_count = vertex_array.m_bindings_count;
+		std::copy(vertex_array.m_buffer_slots, vertex_array.m_buffer_slots + vertex_array.m_buffer_slots_count, m_buffer_slots);
+		m_buffer_slots_count = vertex_array.m_buffer_slots_count;
+		m_indecis_count = vertex_array.m_indecis_count;
+		m_index_type = vertex_array.m_index_type;
 		vertex_array.m_id = 0;
 		vertex_array.m_elements_count = 0;
+		vertex_array.m_bindings_count = 0;
+		vertex_array.m_indecis_count = 0;
+		vertex_array.m_buffer_slots_count = 0;
 		return *this;
 	}
 
-	VertexArray::VertexArray(VertexArray&& vertex_array) noexcept {
+	VertexArray::VertexArray(VertexArray&& vertex_array) noexcept
+	{
+		std::copy(vertex_array.m_buffer_slots, vertex_array.m_buffer_slots + vertex_array.m_buffer_slots_count, m_buffer_slots);
+		m_buffer_slots_count = vertex_array.m_buffer_slots_count;
 		m_id = vertex_array.m_id;
 		m_elements_count = vertex_array.m_elements_count;
+		m_bindings_count = vertex_array.m_bindings_count;
+		m_indecis_count = vertex_array.m_indecis_count;
+		m_index_type = vertex_array.m_index_type;
 		vertex_array.m_id = 0;
 		vertex_array.m_elements_count = 0;
+		vertex_array.m_bindings_count = 0;
+		vertex_array.m_indecis_count = 0;
+		vertex_array.m_buffer_slots_count = 0;
 	}
 
 	void VertexArray::bind() const {
-		glBindVertexArray(m_id);
+		RenderStateCache::bind_vertex_array(m_id);
 	}
 
 	void VertexArray::unbind() {
-		glBindVertexArray(0);
+		RenderStateCache::bind_vertex_array(0);
 	}
 
 	void VertexArray::add_vertex_buffer(const VertexBuffer& vertex_buffer) {
-		bind();
-		vertex_buffer.bind();
-
-		for (auto& current_element : vertex_buffer.get_layout().get_elements()) {
-			glEnableVertexAttribArray(m_elements_count);
-			glVertexAttribPointer(m_elements_count,
-				current_element.components_count,
-				current_element.component_type,
-				GL_FALSE,
-				vertex_buffer.get_layout().get_stride(),
-				reinterpret_cast<const void*> (current_element.offset)
-			);
-			++m_elements_count;
+		if (m_buffer_slots_count == s_max_buffer_slots) {
+			LOG_ERROR("VertexArray::add_vertex_buffer: all {0} buffer slots are used", s_max_buffer_slots);
+			return;
+		}
+		const BufferLayout& layout = vertex_buffer.get_layout();
+
+		unsigned int step_rates[BufferLayout::s_max_elements];
+		size_t step_rates_count = 0;
+		for (const BufferElement& current_element : layout) {
+			if (std::find(step_rates, step_rates + step_rates_count, current_element.step_rate) == step_rates + step_rates_count)
+				step_rates[step_rates_count++] = current_element.step_rate;
+		}
+
+		const BufferSlot buffer_slot{ m_bindings_count, static_cast<unsigned int>(step_rates_count), layout.get_stride() };
+		for (size_t i = 0; i < step_rates_count; ++i) {
+			const unsigned int binding = buffer_slot.first_binding + static_cast<unsigned int>(i);
+			glVertexArrayVertexBuffer(m_id, binding, vertex_buffer.get_id(), 0, buffer_slot.stride);
+			glVertexArrayBindingDivisor(m_id, binding, step_rates[i]);
+		}
+
+		for (const BufferElement& current_element : layout) {
+			const unsigned int binding = buffer_slot.first_binding + static_cast<unsigned int>(
+				std::find(step_rates, step_rates + step_rates_count, current_element.step_rate) - step_rates);
+			const GLenum component_type = shader_data_type_to_component_type(current_element.type);
+
+			const size_t slot_size = current_element.size / current_element.slots_count;
+			for (size_t slot = 0; slot < current_element.slots_count; ++slot) {
+				const GLuint relative_offset = static_cast<GLuint>(current_element.offset + slot * slot_size);
+				glEnableVertexArrayAttrib(m_id, m_elements_count);
+				if (current_element.integer) {
+					glVertexArrayAttribIFormat(m_id, m_elements_count,
+						current_element.components_count,
+						component_type,
+						relative_offset
+					);
+				}
+				else {
+					glVertexArrayAttribFormat(m_id, m_elements_count,
+						current_element.components_count,
+						component_type,
+						current_element.normalized ? GL_TRUE : GL_FALSE,
+						relative_offset
+					);
+				}
+				glVertexArrayAttribBinding(m_id, m_elements_count, binding);
+				++m_elements_count;
+			}
+		}
+
+		m_bindings_count += buffer_slot.bindings_count;
+		m_buffer_slots[m_buffer_slots_count++] = buffer_slot;
+	}
+
+	void VertexArray::set_vertex_buffer(const size_t buffer_slot, const VertexBuffer& vertex_buffer, const size_t offset) {
+		set_vertex_buffer(buffer_slot, vertex_buffer.get_id(), offset);
+	}
+
+	void VertexArray::set_vertex_buffer(const size_t buffer_slot, const unsigned int buffer_id, const size_t offset) {
+		if (buffer_slot >= m_buffer_slots_count) {
+			LOG_ERROR("VertexArray::set_vertex_buffer: slot {0} has no format, call add_vertex_buffer first", buffer_slot);
+			return;
 		}
+		const BufferSlot& slot = m_buffer_slots[buffer_slot];
+		for (unsigned int binding = slot.first_binding; binding < slot.first_binding + slot.bindings_count; ++binding)
+			glVertexArrayVertexBuffer(m_id, binding, buffer_id, offset, slot.stride);
 	}
+
 	void VertexArray::set_index_buffer(const IndexBuffer& index_buffer)
 	{
-		bind();
-		index_buffer.bind();
+		glVertexArrayElementBuffer(m_id, index_buffer.get_id());
 		m_indecis_count = index_buffer.get_count();
+		m_index_type = index_buffer.get_type();
 	}
 }
@@ -15,14 +15,35 @@ namespace SimpleEngine {
 
 		void bind() const;
 		static void unbind();
+		unsigned int get_id() const { return m_id; }
+
+		// describes the attribute format of the buffer layout and attaches the buffer to a new slot
 		void add_vertex_buffer(const VertexBuffer& vertex_buffer);
+		// the format is set once, only the buffer is swapped: one vertex array serves every mesh of a vertex format
+		void set_vertex_buffer(const size_t buffer_slot, const VertexBuffer& vertex_buffer, const size_t offset = 0);
+		void set_vertex_buffer(const size_t buffer_slot, const unsigned int buffer_id, const size_t offset);
+		size_t get_vertex_buffers_count() const { return m_buffer_slots_count; }
 
 		void set_index_buffer(const IndexBuffer& index_buffer);
 		size_t get_indeces_count() const { return m_indecis_count; }
+		EIndexType get_index_type() const { return m_index_type; }
 
 	private:
+		static constexpr size_t s_max_buffer_slots = 8;
+
+		// elements with different step rates read the same buffer through separate binding points
+		struct BufferSlot {
+			unsigned int first_binding;
+			unsigned int bindings_count;
+			int stride;
+		};
+
 		unsigned int m_id = 0;
 		unsigned int m_elements_count = 0;
+		unsigned int m_bindings_count = 0;
+		BufferSlot m_buffer_slots[s_max_buffer_slots] = {};
+		size_t m_buffer_slots_count = 0;
 		size_t m_indecis_count = 0;
+		EIndexType m_index_type = EIndexType::UInt32;
 	};
-}
\ No newline at end of file
+}
@@ -1,100 +1,76 @@
 #include "VertexBuffer.hpp"
 #include "SimpleEngineCore/Log.hpp"
+#include "RenderStateCache.hpp"
 #include "glad/glad.h"
 
-namespace SimpleEngine {
-
-	constexpr GLuint shader_data_type_to_components_count(const ShaderDataType& type) {
-		switch (type) {
-		case ShaderDataType::Float:
-		case ShaderDataType::Int:
-			return 1;
-
-		case ShaderDataType::Float2:
-		case ShaderDataType::Int2:
-			return 2;
-
-		case ShaderDataType::Float3:
-		case ShaderDataType::Int3:
-			return 3;
+#include <utility>
 
-		case ShaderDataType::Float4:
-		case ShaderDataType::Int4:
-			return 4;
-		default:
-			LOG_ERROR("shader_data_type_to_components_count: unknown ShaderDataType!");
-			return 0;
-		}
-	}
-
-	constexpr size_t shader_data_type_size(const ShaderDataType& type) {
-		switch (type)
-		{
-		case ShaderDataType::Float:
-		case ShaderDataType::Float2:
-		case ShaderDataType::Float3:
-		case ShaderDataType::Float4:
-			return sizeof(GLfloat) * shader_data_type_to_components_count(type);
-		case ShaderDataType::Int:
-		case ShaderDataType::Int2:
-		case ShaderDataType::Int3:
-		case ShaderDataType::Int4:
-			return sizeof(GLint) * shader_data_type_to_components_count(type);
-		default:
-			LOG_ERROR("shader_data_type_size: unknown ShaderDataType!");
-			return 0;
-		}
-	}
+namespace SimpleEngine {
 
-	constexpr GLuint shader_data_type_to_component_type(const ShaderDataType& type) {
+	unsigned int shader_data_type_to_component_type(const ShaderDataType type) {
 		switch (type)
 		{
 		case ShaderDataType::Float:
 		case ShaderDataType::Float2:
 		case ShaderDataType::Float3:
 		case ShaderDataType::Float4:
+		case ShaderDataType::Mat3:
+		case ShaderDataType::Mat4:
 			return GL_FLOAT;
 		case ShaderDataType::Int:
 		case ShaderDataType::Int2:
 		case ShaderDataType::Int3:
 		case ShaderDataType::Int4:
 			return GL_INT;
+		case ShaderDataType::UByte4:
+		case ShaderDataType::UByte4Norm:
+			return GL_UNSIGNED_BYTE;
+		case ShaderDataType::Half2:
+		case ShaderDataType::Half4:
+			return GL_HALF_FLOAT;
+		case ShaderDataType::Byte4Norm:
+			return GL_BYTE;
+		case ShaderDataType::Short2Norm:
+		case ShaderDataType::Short4Norm:
+			return GL_SHORT;
+		case ShaderDataType::UShort2Norm:
+		case ShaderDataType::UShort4Norm:
+			return GL_UNSIGNED_SHORT;
+		case ShaderDataType::Int2_10_10_10_Norm:
+			return GL_INT_2_10_10_10_REV;
 		default:
 			LOG_ERROR("shader_data_type_to_component_type: unknown ShaderDataType!");
 			return GL_FLOAT;
 		}
 	}
 
-	constexpr GLenum usage_to_GLenum(const VertexBuffer::EUsage usage) {
+	// immutable storage: only Dynamic/Stream buffers may be updated with set_data
+	unsigned int usage_to_storage_flags(const VertexBuffer::EUsage usage) {
 		switch (usage)
 		{
-		case VertexBuffer::EUsage::Static: return GL_STATIC_DRAW;
-		case VertexBuffer::EUsage::Dynamic: return GL_DYNAMIC_DRAW;
-		case VertexBuffer::EUsage::Stream: return GL_STREAM_DRAW;
+		case VertexBuffer::EUsage::Static: return 0;
+		case VertexBuffer::EUsage::Dynamic: return GL_DYNAMIC_STORAGE_BIT;
+		case VertexBuffer::EUsage::Stream: return GL_DYNAMIC_STORAGE_BIT;
 		default:
 			LOG_INFO("Unknown VertexBuffer usage");
-			return GL_STREAM_DRAW;
+			return GL_DYNAMIC_STORAGE_BIT;
 		}
 	}
 
-	BufferElement::BufferElement(const ShaderDataType& _type)
-		: type(_type),
-		component_type(shader_data_type_to_component_type(_type)),
-		components_count(shader_data_type_to_components_count(_type)),
-		size(shader_data_type_size(_type)),
-		offset(0)
-	{
-	}
-
 	VertexBuffer::VertexBuffer(const void* data, const size_t size, BufferLayout buffer_layout, const EUsage usage)
 		: m_buffer_layout(std::move(buffer_layout))
 	{
-		glGenBuffers(1, &m_id);
-		glBindBuffer(GL_ARRAY_BUFFER, m_id);
-		glBufferData(GL_ARRAY_BUFFER, size, data, usage_to_GLenum(usage));
+		if (m_buffer_layout.get_dropped_elements_count() > 0)
+			LOG_ERROR("VertexBuffer: layout has {0} elements more than the {1} supported, they are ignored",
+				m_buffer_layout.get_dropped_elements_count(), BufferLayout::s_max_elements);
+		else if (!m_buffer_layout.is_valid())
+			LOG_ERROR("VertexBuffer: layout elements overlap or do not fit into the stride");
+		glCreateBuffers(1, &m_id);
+		glNamedBufferStorage(m_id, size, data, usage_to_storage_flags(usage));
 	}
 
 	SimpleEngine::VertexBuffer::~VertexBuffer() {
+		RenderStateCache::forget_buffer(m_id);
 		glDeleteBuffers(1, &m_id);
 	}
 
@@ -113,10 +89,14 @@ namespace SimpleEngine {
 	}
 
 	void VertexBuffer::bind() const {
-		glBindBuffer(GL_ARRAY_BUFFER, m_id);
+		RenderStateCache::bind_buffer(GL_ARRAY_BUFFER, m_id);
 	}
 
 	void VertexBuffer::unbind() {
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		RenderStateCache::bind_buffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	void VertexBuffer::set_data(const void* data, const size_t size, const size_t offset) {
+		glNamedBufferSubData(m_id, offset, size, data);
 	}
 }
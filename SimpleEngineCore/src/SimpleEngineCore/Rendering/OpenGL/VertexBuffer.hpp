@@ -1,5 +1,7 @@
 #pragma once
-#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
 
 namespace SimpleEngine {
 	enum class ShaderDataType {
@@ -8,43 +10,233 @@ namespace SimpleEngine {
 		Float3,
 		Float4,
 
+		// integer attributes, read by ivec/uvec inputs without conversion
 		Int,
 		Int2,
 		Int3,
-		Int4
+		Int4,
+		UByte4,
+
+		// occupy one attribute slot per column
+		Mat3,
+		Mat4,
+
+		// compact formats, read as float/vec inputs
+		Half2,
+		Half4,
+		Byte4Norm,				// [-1, 1]
+		UByte4Norm,				// [0, 1]
+		Short2Norm,
+		Short4Norm,
+		UShort2Norm,
+		UShort4Norm,
+		Int2_10_10_10_Norm		// xyz 10 bits, w 2 bits, [-1, 1]
 	};
 
+	constexpr size_t shader_data_type_to_components_count(const ShaderDataType type) {
+		switch (type) {
+		case ShaderDataType::Float:
+		case ShaderDataType::Int:
+			return 1;
+
+		case ShaderDataType::Float2:
+		case ShaderDataType::Int2:
+		case ShaderDataType::Half2:
+		case ShaderDataType::Short2Norm:
+		case ShaderDataType::UShort2Norm:
+			return 2;
+
+		case ShaderDataType::Float3:
+		case ShaderDataType::Int3:
+		case ShaderDataType::Mat3:
+			return 3;
+
+		default:
+			return 4;
+		}
+	}
+
+	constexpr size_t shader_data_type_to_slots_count(const ShaderDataType type) {
+		switch (type) {
+		case ShaderDataType::Mat3:
+			return 3;
+		case ShaderDataType::Mat4:
+			return 4;
+		default:
+			return 1;
+		}
+	}
+
+	constexpr size_t shader_data_type_to_component_size(const ShaderDataType type) {
+		switch (type) {
+		case ShaderDataType::UByte4:
+		case ShaderDataType::Byte4Norm:
+		case ShaderDataType::UByte4Norm:
+			return 1;
+		case ShaderDataType::Half2:
+		case ShaderDataType::Half4:
+		case ShaderDataType::Short2Norm:
+		case ShaderDataType::Short4Norm:
+		case ShaderDataType::UShort2Norm:
+		case ShaderDataType::UShort4Norm:
+			return 2;
+		default:
+			return 4;
+		}
+	}
+
+	constexpr size_t shader_data_type_size(const ShaderDataType type) {
+		// packed formats hold all components in one 32-bit word
+		if (type == ShaderDataType::Int2_10_10_10_Norm)
+			return 4;
+		return shader_data_type_to_component_size(type) * shader_data_type_to_components_count(type) * shader_data_type_to_slots_count(type);
+	}
+
+	constexpr bool shader_data_type_is_normalized(const ShaderDataType type) {
+		switch (type) {
+		case ShaderDataType::Byte4Norm:
+		case ShaderDataType::UByte4Norm:
+		case ShaderDataType::Short2Norm:
+		case ShaderDataType::Short4Norm:
+		case ShaderDataType::UShort2Norm:
+		case ShaderDataType::UShort4Norm:
+		case ShaderDataType::Int2_10_10_10_Norm:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	constexpr bool shader_data_type_is_integer(const ShaderDataType type) {
+		switch (type) {
+		case ShaderDataType::Int:
+		case ShaderDataType::Int2:
+		case ShaderDataType::Int3:
+		case ShaderDataType::Int4:
+		case ShaderDataType::UByte4:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	// GL enum of the components, defined next to the other GL code
+	unsigned int shader_data_type_to_component_type(const ShaderDataType type);
+
 	struct BufferElement {
-		ShaderDataType type;
-		uint32_t component_type;
-		size_t components_count;
-		size_t size;
-		size_t offset;
+		ShaderDataType type = ShaderDataType::Float;
+		size_t components_count = 0; // per slot
+		size_t slots_count = 0;
+		bool normalized = false;
+		bool integer = false;
+		size_t size = 0;
+		size_t offset = 0;
+		// 0 - advances per vertex, N - advances once every N instances
+		unsigned int step_rate = 0;
 
-		BufferElement(const ShaderDataType& _type);
+		constexpr BufferElement() = default;
+		constexpr BufferElement(const ShaderDataType _type, const unsigned int _step_rate = 0, const size_t _offset = 0)
+			: type(_type),
+			  components_count(shader_data_type_to_components_count(_type)),
+			  slots_count(shader_data_type_to_slots_count(_type)),
+			  normalized(shader_data_type_is_normalized(_type)),
+			  integer(shader_data_type_is_integer(_type)),
+			  size(shader_data_type_size(_type)),
+			  offset(_offset),
+			  step_rate(_step_rate)
+		{
+		}
 	};
 
+	// Fixed capacity, so layouts are plain values: copying one or building one at compile time allocates nothing.
 	class BufferLayout {
 	public:
-		BufferLayout(std::initializer_list<BufferElement> elements)
-			: m_elements(std::move(elements))
-		{
+		static constexpr size_t s_max_elements = 16;
+
+		constexpr BufferLayout() = default;
+		// elements are packed one after another in the given order; the ones beyond s_max_elements are dropped
+		// and counted, VertexBuffer reports them
+		constexpr BufferLayout(std::initializer_list<BufferElement> elements) {
 			size_t offset = 0;
-			for (auto& element : m_elements) {
-				element.offset = offset;
+			for (const BufferElement& element : elements) {
+				if (m_elements_count == s_max_elements) {
+					++m_dropped_elements_count;
+					continue;
+				}
+				BufferElement& packed = m_elements[m_elements_count++];
+				packed = element;
+				packed.offset = offset;
 				offset += element.size;
 			}
-			m_stride = offset;
+			m_stride = static_cast<int>(offset);
 		}
 
-		const std::vector<BufferElement>& get_elements() const { return m_elements; }
-		int get_stride() const { return m_stride; }
+		// elements keep their offsets, for structs with padding
+		constexpr BufferLayout(const BufferElement* elements, const size_t elements_count, const int stride)
+			: m_stride(stride)
+		{
+			for (size_t i = 0; i < elements_count; ++i) {
+				if (m_elements_count == s_max_elements)
+					++m_dropped_elements_count;
+				else
+					m_elements[m_elements_count++] = elements[i];
+			}
+		}
+
+		constexpr const BufferElement* begin() const { return m_elements; }
+		constexpr const BufferElement* end() const { return m_elements + m_elements_count; }
+		constexpr size_t get_elements_count() const { return m_elements_count; }
+		constexpr size_t get_dropped_elements_count() const { return m_dropped_elements_count; }
+		constexpr int get_stride() const { return m_stride; }
+
+		// no element was dropped, elements are in ascending order, do not overlap and fit into the stride
+		constexpr bool is_valid() const {
+			if (m_dropped_elements_count > 0)
+				return false;
+			size_t end_of_previous = 0;
+			for (size_t i = 0; i < m_elements_count; ++i) {
+				if (m_elements[i].offset < end_of_previous)
+					return false;
+				end_of_previous = m_elements[i].offset + m_elements[i].size;
+			}
+			return end_of_previous <= static_cast<size_t>(m_stride);
+		}
 
 	private:
-		std::vector<BufferElement> m_elements;
+		BufferElement m_elements[s_max_elements] = {};
+		size_t m_elements_count = 0;
+		size_t m_dropped_elements_count = 0;
 		int m_stride = 0;
 	};
 
+	// One attribute of a vertex struct, see VERTEX_ATTRIBUTE
+	template<ShaderDataType Type, size_t Offset, size_t MemberSize, unsigned int StepRate = 0>
+	struct VertexAttribute {
+		static_assert(MemberSize == shader_data_type_size(Type), "vertex member size does not match its ShaderDataType");
+
+		static constexpr BufferElement s_element{ Type, StepRate, Offset };
+	};
+
+	// Layout computed at compile time from the vertex struct itself:
+	//	using MyLayout = VertexLayout<MyVertex,
+	//		VERTEX_ATTRIBUTE(MyVertex, position, ShaderDataType::Float3),
+	//		VERTEX_ATTRIBUTE(MyVertex, uv, ShaderDataType::Half2)>;
+	//	VertexBuffer vbo(vertices, sizeof(vertices), MyLayout::s_layout);
+	// The stride is sizeof(Vertex), a member of the wrong size or out of order does not compile.
+	template<typename Vertex, typename... Attributes>
+	struct VertexLayout {
+		static_assert(sizeof...(Attributes) > 0, "vertex layout has no attributes");
+		static_assert(sizeof...(Attributes) <= BufferLayout::s_max_elements, "too many vertex attributes");
+
+		static constexpr BufferElement s_elements[] = { Attributes::s_element... };
+		static constexpr BufferLayout s_layout{ s_elements, sizeof...(Attributes), static_cast<int>(sizeof(Vertex)) };
+
+		static_assert(s_layout.is_valid(), "vertex attributes must be declared in member order and fit into the vertex");
+	};
+
+#define VERTEX_ATTRIBUTE(vertex, member, type) \
+	::SimpleEngine::VertexAttribute<type, offsetof(vertex, member), sizeof(vertex::member)>
+
 	class VertexBuffer {
 	public:
 		enum class EUsage {
@@ -64,10 +256,16 @@ namespace SimpleEngine {
 
 		void bind() const;
 		static void unbind();
+		// overwrites part of the buffer in place, for Dynamic/Stream buffers
+		void set_data(const void* data, const size_t size, const size_t offset = 0);
 
 		const BufferLayout& get_layout() const { return m_buffer_layout; }
+		unsigned int get_id() const { return m_id; }
 	private:
 		unsigned int m_id = 0;
 		BufferLayout m_buffer_layout;
 	};
+
+	// GL storage flags of a buffer with the given usage, shared by the buffer classes
+	unsigned int usage_to_storage_flags(const VertexBuffer::EUsage usage);
 }
\ No newline at end of file
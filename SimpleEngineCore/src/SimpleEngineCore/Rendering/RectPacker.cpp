@@ -0,0 +1,156 @@
+#include "RectPacker.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace SimpleEngine {
+
+	namespace {
+
+		bool intersects(const PackedRect& a, const PackedRect& b) {
+			return a.x < b.x + b.width && b.x < a.x + a.width
+				&& a.y < b.y + b.height && b.y < a.y + a.height;
+		}
+
+		bool contains(const PackedRect& outer, const PackedRect& inner) {
+			return inner.x >= outer.x && inner.y >= outer.y
+				&& inner.x + inner.width <= outer.x + outer.width
+				&& inner.y + inner.height <= outer.y + outer.height;
+		}
+
+	}
+
+	RectPacker::RectPacker(const unsigned int width, const unsigned int height)
+		: m_width(width),
+		  m_height(height)
+	{
+		reset();
+	}
+
+	void RectPacker::reset() {
+		m_free_rects.clear();
+		m_free_rects.push_back({ 0, 0, m_width, m_height });
+		m_used_rects.clear();
+		m_used_area = 0;
+		m_free_rects_dirty = false;
+	}
+
+	bool RectPacker::insert(const unsigned int width, const unsigned int height, PackedRect& rect) {
+		const unsigned long long area = static_cast<unsigned long long>(width) * height;
+		if (area == 0 || m_used_area + area > static_cast<unsigned long long>(m_width) * m_height)
+			return false;
+
+		const PackedRect* best = find_position(width, height);
+		if (!best && m_free_rects_dirty) {
+			rebuild_free_rects();
+			best = find_position(width, height);
+		}
+		if (!best)
+			return false;
+
+		rect = { best->x, best->y, width, height };
+		split_free_rects(rect);
+		prune_free_rects();
+		m_used_rects.push_back(rect);
+		m_used_area += area;
+		return true;
+	}
+
+	const PackedRect* RectPacker::find_position(const unsigned int width, const unsigned int height) const {
+		unsigned int best_short_side = std::numeric_limits<unsigned int>::max();
+		unsigned int best_long_side = std::numeric_limits<unsigned int>::max();
+		const PackedRect* best = nullptr;
+		for (const PackedRect& free_rect : m_free_rects) {
+			if (free_rect.width < width || free_rect.height < height)
+				continue;
+			const unsigned int leftover_x = free_rect.width - width;
+			const unsigned int leftover_y = free_rect.height - height;
+			const unsigned int short_side = std::min(leftover_x, leftover_y);
+			const unsigned int long_side = std::max(leftover_x, leftover_y);
+			if (short_side < best_short_side || (short_side == best_short_side && long_side < best_long_side)) {
+				best_short_side = short_side;
+				best_long_side = long_side;
+				best = &free_rect;
+			}
+		}
+		return best;
+	}
+
+	void RectPacker::free(const PackedRect& rect) {
+		const auto it = std::find_if(m_used_rects.begin(), m_used_rects.end(), [&rect](const PackedRect& used) {
+			return used.x == rect.x && used.y == rect.y && used.width == rect.width && used.height == rect.height;
+		});
+		if (it == m_used_rects.end())
+			return;
+
+		m_used_area -= static_cast<unsigned long long>(rect.width) * rect.height;
+		*it = m_used_rects.back();
+		m_used_rects.pop_back();
+		if (m_used_rects.empty()) {
+			reset();
+			return;
+		}
+		// the freed area is usable right away, but it is not joined with the free space around it
+		// until the free list is rebuilt, which is postponed until an insert does not fit
+		m_free_rects.push_back(rect);
+		m_free_rects_dirty = true;
+	}
+
+	float RectPacker::get_occupancy() const {
+		const unsigned long long area = static_cast<unsigned long long>(m_width) * m_height;
+		return area ? static_cast<float>(m_used_area) / area : 0.f;
+	}
+
+	void RectPacker::split_free_rects(const PackedRect& used) {
+		m_first_new_free_rect = m_free_rects.size();
+		for (size_t i = 0; i < m_first_new_free_rect; ++i) {
+			const PackedRect free_rect = m_free_rects[i];
+			if (!intersects(free_rect, used))
+				continue;
+
+			// every part of the free rectangle outside of the used one becomes a maximal free rectangle
+			if (used.x > free_rect.x)
+				m_free_rects.push_back({ free_rect.x, free_rect.y, used.x - free_rect.x, free_rect.height });
+			if (used.x + used.width < free_rect.x + free_rect.width)
+				m_free_rects.push_back({ used.x + used.width, free_rect.y, free_rect.x + free_rect.width - used.x - used.width, free_rect.height });
+			if (used.y > free_rect.y)
+				m_free_rects.push_back({ free_rect.x, free_rect.y, free_rect.width, used.y - free_rect.y });
+			if (used.y + used.height < free_rect.y + free_rect.height)
+				m_free_rects.push_back({ free_rect.x, used.y + used.height, free_rect.width, free_rect.y + free_rect.height - used.y - used.height });
+
+			m_free_rects[i].width = 0; // removed by prune_free_rects()
+		}
+	}
+
+	void RectPacker::rebuild_free_rects() {
+		m_free_rects.clear();
+		m_free_rects.push_back({ 0, 0, m_width, m_height });
+		for (const PackedRect& used : m_used_rects) {
+			split_free_rects(used);
+			prune_free_rects();
+		}
+		m_free_rects_dirty = false;
+	}
+
+	void RectPacker::prune_free_rects() {
+		// the old rectangles were maximal before the split and a new one is a part of an old one,
+		// so only the new rectangles can be contained in another rectangle
+		const size_t count = m_free_rects.size();
+		for (size_t i = m_first_new_free_rect; i < count; ++i) {
+			PackedRect& rect = m_free_rects[i];
+			for (size_t j = 0; j < count; ++j) {
+				const PackedRect& other = m_free_rects[j];
+				if (i == j || other.width == 0)
+					continue;
+				if (contains(other, rect)) {
+					rect.width = 0;
+					break;
+				}
+			}
+		}
+
+		m_free_rects.erase(std::remove_if(m_free_rects.begin(), m_free_rects.end(),
+			[](const PackedRect& rect) { return rect.width == 0 || rect.height == 0; }), m_free_rects.end());
+	}
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+namespace SimpleEngine {
+
+	struct PackedRect {
+		unsigned int x = 0;
+		unsigned int y = 0;
+		unsigned int width = 0;
+		unsigned int height = 0;
+	};
+
+	// MaxRects packer (best short side fit). Keeps the maximal free rectangles of the bin,
+	// so rectangles can be inserted one by one. Rectangles can be freed in any order: the free list
+	// is rebuilt from the remaining used rectangles once an insert does not fit without it.
+	class RectPacker {
+	public:
+		RectPacker(const unsigned int width, const unsigned int height);
+
+		// false if there is no free rectangle large enough
+		bool insert(const unsigned int width, const unsigned int height, PackedRect& rect);
+		// rect must have been returned by insert() and not freed yet
+		void free(const PackedRect& rect);
+		void reset();
+
+		unsigned int get_width() const { return m_width; }
+		unsigned int get_height() const { return m_height; }
+		// occupied area / bin area
+		float get_occupancy() const;
+
+	private:
+		const PackedRect* find_position(const unsigned int width, const unsigned int height) const;
+		void split_free_rects(const PackedRect& used);
+		void rebuild_free_rects();
+		void prune_free_rects();
+
+		unsigned int m_width = 0;
+		unsigned int m_height = 0;
+		unsigned long long m_used_area = 0;
+		std::vector<PackedRect> m_free_rects;
+		std::vector<PackedRect> m_used_rects;
+		size_t m_first_new_free_rect = 0;
+		bool m_free_rects_dirty = false;
+	};
+
+}
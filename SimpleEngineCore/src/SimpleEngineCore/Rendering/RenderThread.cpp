@@ -0,0 +1,78 @@
+#include "RenderThread.hpp"
+#include "SimpleEngineCore/Log.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace SimpleEngine {
+
+	RenderThread::RenderThread(Function on_start, Function on_stop, const unsigned int max_frame_latency)
+		: m_buffers(std::max(max_frame_latency, 1u) + 1)
+		, m_on_start(std::move(on_start))
+		, m_on_stop(std::move(on_stop)) {
+		m_thread = std::thread(&RenderThread::thread_loop, this);
+		LOG_INFO("RenderThread: started, up to {0} frames of latency", get_max_frame_latency());
+	}
+
+	RenderThread::~RenderThread() {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_is_stopping = true;
+		}
+		m_submitted_condition.notify_one();
+		m_thread.join();
+	}
+
+	void RenderThread::submit_frame() {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			++m_submitted_frames_count;
+		}
+		m_submitted_condition.notify_one();
+
+		// the next buffer is free once the frame recorded into it a ring ago has been replayed
+		const uint64_t max_frame_latency = get_max_frame_latency();
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_replayed_condition.wait(lock, [this, max_frame_latency]() {
+			return m_submitted_frames_count - m_replayed_frames_count <= max_frame_latency;
+		});
+	}
+
+	void RenderThread::flush() {
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_replayed_condition.wait(lock, [this]() { return m_replayed_frames_count == m_submitted_frames_count; });
+	}
+
+	void RenderThread::thread_loop() {
+		if (m_on_start)
+			m_on_start();
+
+		while (true) {
+			uint64_t frame = 0;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_submitted_condition.wait(lock, [this]() {
+					return m_replayed_frames_count < m_submitted_frames_count || m_is_stopping;
+				});
+				// submitted frames are replayed even when stopping, they may own resources being released
+				if (m_replayed_frames_count == m_submitted_frames_count)
+					break;
+				frame = m_replayed_frames_count;
+			}
+
+			RenderCommandBuffer& buffer = m_buffers[frame % m_buffers.size()];
+			buffer.execute();
+			buffer.clear();
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				++m_replayed_frames_count;
+			}
+			m_replayed_condition.notify_one();
+		}
+
+		if (m_on_stop)
+			m_on_stop();
+	}
+
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include "SimpleEngineCore/Jobs/CommandBuffer.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace SimpleEngine {
+
+	// Commands recorded by one thread and replayed in order by another, in chunks that are reused from frame to frame.
+	// Closures must capture by value whatever the recording thread changes afterwards; arrays are copied
+	// into the same chunks with push_data, so per-frame data doesn't allocate either.
+	using RenderCommandBuffer = CommandBuffer<>;
+
+	// Owns the thread that replays recorded frames, so that recording frame N + 1 overlaps with replaying frame N.
+	// Frames go through a ring of max_frame_latency + 1 command buffers: the recording thread blocks in submit_frame
+	// while max_frame_latency frames are still waiting or being replayed, which bounds how far the
+	// replayed image lags behind the simulation.
+	class RenderThread {
+	public:
+		using Function = std::function<void()>;
+
+		// on_start and on_stop run on the render thread before the first and after the last frame,
+		// e.g. to make the GL context current there and release it again
+		RenderThread(Function on_start, Function on_stop, const unsigned int max_frame_latency = 1);
+		// replays the submitted frames and joins the thread, unsubmitted commands are dropped
+		~RenderThread();
+
+		RenderThread(const RenderThread&) = delete;
+		RenderThread& operator=(const RenderThread&) = delete;
+
+		// recording thread only
+		RenderCommandBuffer& get_recording_buffer() { return m_buffers[m_submitted_frames_count % m_buffers.size()]; }
+		// hands the recorded frame over, waits for a free buffer to record the next one into
+		void submit_frame();
+		// waits until every submitted frame has been replayed
+		void flush();
+
+		unsigned int get_max_frame_latency() const { return static_cast<unsigned int>(m_buffers.size()) - 1; }
+
+	private:
+		void thread_loop();
+
+		std::vector<RenderCommandBuffer> m_buffers;
+		Function m_on_start;
+		Function m_on_stop;
+
+		std::mutex m_mutex;
+		std::condition_variable m_submitted_condition;
+		std::condition_variable m_replayed_condition;
+		// written by the recording thread under the mutex, so it reads it without locking
+		uint64_t m_submitted_frames_count = 0;
+		uint64_t m_replayed_frames_count = 0;
+		bool m_is_stopping = false;
+
+		std::thread m_thread;
+	};
+
+}
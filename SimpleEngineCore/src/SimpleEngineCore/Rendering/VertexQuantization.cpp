@@ -0,0 +1,156 @@
+#include "VertexQuantization.hpp"
+#include "SimpleEngineCore/Math/SIMD.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace SimpleEngine {
+
+	namespace {
+
+		// round to nearest even, overflow to infinity, NaN stays NaN
+		Int4 float4_to_half4(const Float4 value) {
+			const Int4 sign_mask(static_cast<int32_t>(0x80000000u));
+			const Int4 f32_infinity(0x7f800000);
+			const Int4 f16_max(0x477fffff);			// last float rounding below the half infinity
+			const Int4 f16_min_normal(0x38800000);	// 2^-14
+			const Float4 denorm_magic(0.5f);		// moves denormals' mantissa into the low bits
+			const Int4 denorm_magic_bits(0x3f000000);
+			const Int4 rebias(static_cast<int32_t>(0xc8000fffu)); // (15 - 127) << 23 plus rounding bias
+
+			Int4 bits = as_int4(value);
+			const Int4 sign = bits & sign_mask;
+			bits = bits ^ sign;
+
+			const Int4 inf_nan = select(bits > f32_infinity, Int4(0x7e00), Int4(0x7c00));
+			const Int4 denormal = as_int4(as_float4(bits) + denorm_magic) - denorm_magic_bits;
+			const Int4 mantissa_odd = (bits >> 13) & Int4(1);
+			const Int4 normal = (bits + rebias + mantissa_odd) >> 13;
+
+			const Int4 half = select(bits > f16_max, inf_nan, select(f16_min_normal > bits, denormal, normal));
+			return half | (sign >> 16);
+		}
+
+	}
+
+	uint16_t VertexQuantization::float_to_half(const float value) {
+		int32_t lanes[4];
+		float4_to_half4(Float4(value)).store(lanes);
+		return static_cast<uint16_t>(lanes[0]);
+	}
+
+	float VertexQuantization::half_to_float(const uint16_t value) {
+		const uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+		const uint32_t exponent = (value >> 10) & 0x1f;
+		const uint32_t mantissa = value & 0x3ff;
+
+		uint32_t bits = 0;
+		if (exponent == 0x1f) {
+			bits = sign | 0x7f800000 | (mantissa << 13);
+		}
+		else if (exponent != 0) {
+			bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+		}
+		else if (mantissa != 0) {
+			// denormal half is a normal float
+			const float magnitude = static_cast<float>(mantissa) * (1.f / 16777216.f);
+			std::memcpy(&bits, &magnitude, sizeof(bits));
+			bits |= sign;
+		}
+		else {
+			bits = sign;
+		}
+
+		float result;
+		std::memcpy(&result, &bits, sizeof(result));
+		return result;
+	}
+
+	namespace {
+
+		// the kernel turns four floats into four integers, T is the stored component type
+		template<typename T, typename Kernel>
+		void convert(void* destination, const size_t destination_stride,
+					 const float* source, const size_t source_stride, const size_t count, const size_t components,
+					 const Kernel& kernel) {
+			unsigned char* output = static_cast<unsigned char*>(destination);
+			const unsigned char* input = reinterpret_cast<const unsigned char*>(source);
+			const size_t components_count = std::min<size_t>(components, 4);
+
+			float padded[4] = { 0.f, 0.f, 0.f, 0.f };
+			int32_t lanes[4];
+			T converted[4];
+			for (size_t i = 0; i < count; ++i) {
+				const float* element = reinterpret_cast<const float*>(input + i * source_stride);
+				if (components_count == 4) {
+					kernel(Float4::load(element)).store(lanes);
+				}
+				else {
+					std::memcpy(padded, element, components_count * sizeof(float));
+					kernel(Float4::load(padded)).store(lanes);
+				}
+				for (size_t c = 0; c < components_count; ++c)
+					converted[c] = static_cast<T>(lanes[c]);
+				std::memcpy(output + i * destination_stride, converted, components_count * sizeof(T));
+			}
+		}
+
+		Int4 quantize(const Float4 value, const float min_value, const float scale) {
+			const Float4 clamped = min(max(value, Float4(min_value)), Float4(1.f));
+			return to_int4(floor(clamped * Float4(scale) + Float4(0.5f)));
+		}
+
+	}
+
+	void VertexQuantization::to_half(void* destination, const size_t destination_stride,
+									 const float* source, const size_t source_stride, const size_t count, const size_t components) {
+		convert<uint16_t>(destination, destination_stride, source, source_stride, count, components, float4_to_half4);
+	}
+
+	void VertexQuantization::to_snorm8(void* destination, const size_t destination_stride,
+									   const float* source, const size_t source_stride, const size_t count, const size_t components) {
+		convert<int8_t>(destination, destination_stride, source, source_stride, count, components,
+			[](const Float4 value) { return quantize(value, -1.f, 127.f); });
+	}
+
+	void VertexQuantization::to_unorm8(void* destination, const size_t destination_stride,
+									   const float* source, const size_t source_stride, const size_t count, const size_t components) {
+		convert<uint8_t>(destination, destination_stride, source, source_stride, count, components,
+			[](const Float4 value) { return quantize(value, 0.f, 255.f); });
+	}
+
+	void VertexQuantization::to_snorm16(void* destination, const size_t destination_stride,
+										const float* source, const size_t source_stride, const size_t count, const size_t components) {
+		convert<int16_t>(destination, destination_stride, source, source_stride, count, components,
+			[](const Float4 value) { return quantize(value, -1.f, 32767.f); });
+	}
+
+	void VertexQuantization::to_unorm16(void* destination, const size_t destination_stride,
+										const float* source, const size_t source_stride, const size_t count, const size_t components) {
+		convert<uint16_t>(destination, destination_stride, source, source_stride, count, components,
+			[](const Float4 value) { return quantize(value, 0.f, 65535.f); });
+	}
+
+	void VertexQuantization::to_snorm_2_10_10_10(void* destination, const size_t destination_stride,
+												 const float* source, const size_t source_stride, const size_t count, const size_t components) {
+		unsigned char* output = static_cast<unsigned char*>(destination);
+		const unsigned char* input = reinterpret_cast<const unsigned char*>(source);
+		const size_t components_count = std::min<size_t>(components, 4);
+		const Float4 scale(511.f, 511.f, 511.f, 1.f);
+
+		float padded[4] = { 0.f, 0.f, 0.f, 0.f };
+		int32_t lanes[4];
+		for (size_t i = 0; i < count; ++i) {
+			std::memcpy(padded, input + i * source_stride, components_count * sizeof(float));
+			const Float4 clamped = min(max(Float4::load(padded), Float4(-1.f)), Float4(1.f));
+			to_int4(floor(clamped * scale + Float4(0.5f))).store(lanes);
+
+			const uint32_t packed = (static_cast<uint32_t>(lanes[0]) & 0x3ff)
+				| ((static_cast<uint32_t>(lanes[1]) & 0x3ff) << 10)
+				| ((static_cast<uint32_t>(lanes[2]) & 0x3ff) << 20)
+				| ((static_cast<uint32_t>(lanes[3]) & 0x3) << 30);
+			std::memcpy(output + i * destination_stride, &packed, sizeof(packed));
+		}
+	}
+
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace SimpleEngine {
+
+	// Converts float vertex attributes into the compact ShaderDataType formats.
+	// count elements of components (1..4) floats are read every source_stride bytes and written
+	// every destination_stride bytes, so one attribute of interleaved vertices is converted per call.
+	// Values are clamped into the range of the format and rounded to nearest.
+	class VertexQuantization {
+	public:
+		static uint16_t float_to_half(const float value);
+		static float half_to_float(const uint16_t value);
+
+		// Half2/Half4
+		static void to_half(void* destination, const size_t destination_stride,
+							const float* source, const size_t source_stride, const size_t count, const size_t components);
+		// Byte4Norm, [-1, 1]
+		static void to_snorm8(void* destination, const size_t destination_stride,
+							  const float* source, const size_t source_stride, const size_t count, const size_t components);
+		// UByte4Norm, [0, 1]
+		static void to_unorm8(void* destination, const size_t destination_stride,
+							  const float* source, const size_t source_stride, const size_t count, const size_t components);
+		// Short2Norm/Short4Norm, [-1, 1]
+		static void to_snorm16(void* destination, const size_t destination_stride,
+							   const float* source, const size_t source_stride, const size_t count, const size_t components);
+		// UShort2Norm/UShort4Norm, [0, 1]
+		static void to_unorm16(void* destination, const size_t destination_stride,
+							   const float* source, const size_t source_stride, const size_t count, const size_t components);
+		// Int2_10_10_10_Norm, missing components are written as 0
+		static void to_snorm_2_10_10_10(void* destination, const size_t destination_stride,
+										const float* source, const size_t source_stride, const size_t count, const size_t components);
+	};
+
+}
@@ -0,0 +1,41 @@
+#include "FileData.hpp"
+
+#include <utility>
+
+namespace SimpleEngine {
+
+	FileData::FileData(const unsigned char* data, const size_t size)
+		: m_data(data),
+		  m_size(size) {
+	}
+
+	FileData::FileData(MappedFile file)
+		: m_data(file.get_data()),
+		  m_size(file.get_size()),
+		  m_file(std::move(file)) {
+	}
+
+	FileData::FileData(std::vector<unsigned char> buffer)
+		: m_size(buffer.size()),
+		  m_buffer(std::move(buffer)) {
+		m_data = m_buffer.data();
+	}
+
+	FileData& FileData::operator=(FileData&& file_data) noexcept {
+		std::swap(m_data, file_data.m_data);
+		std::swap(m_size, file_data.m_size);
+		std::swap(m_file, file_data.m_file);
+		std::swap(m_buffer, file_data.m_buffer);
+		return *this;
+	}
+
+	FileData::FileData(FileData&& file_data) noexcept
+		: m_data(file_data.m_data),
+		  m_size(file_data.m_size),
+		  m_file(std::move(file_data.m_file)),
+		  m_buffer(std::move(file_data.m_buffer)) {
+		file_data.m_data = nullptr;
+		file_data.m_size = 0;
+	}
+
+}
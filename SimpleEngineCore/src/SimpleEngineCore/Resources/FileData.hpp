@@ -0,0 +1,36 @@
+#pragma once
+#include "MappedFile.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace SimpleEngine {
+
+	// Read-only contents of a file returned by FileSystem. The bytes are either a view into a mounted
+	// archive (valid while the archive stays mounted), a mapping of a loose file or a decompressed buffer,
+	// the storage is owned by the FileData in the last two cases. Data is at least 16-byte aligned.
+	class FileData {
+	public:
+		FileData() = default;
+		// view of memory owned by someone else
+		FileData(const unsigned char* data, const size_t size);
+		explicit FileData(MappedFile file);
+		explicit FileData(std::vector<unsigned char> buffer);
+
+		FileData(const FileData&) = delete;
+		FileData& operator=(const FileData&) = delete;
+		FileData& operator=(FileData&& file_data) noexcept;
+		FileData(FileData&& file_data) noexcept;
+
+		bool is_valid() const { return m_data != nullptr; }
+		const unsigned char* get_data() const { return m_data; }
+		size_t get_size() const { return m_size; }
+
+	private:
+		const unsigned char* m_data = nullptr;
+		size_t m_size = 0;
+		MappedFile m_file;
+		std::vector<unsigned char> m_buffer;
+	};
+
+}
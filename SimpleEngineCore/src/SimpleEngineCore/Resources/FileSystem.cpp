@@ -0,0 +1,113 @@
+#include "FileSystem.hpp"
+#include "PackArchive.hpp"
+#include "SimpleEngineCore/Log.hpp"
+
+#include <filesystem>
+
+namespace SimpleEngine {
+
+	class FileSource {
+	public:
+		virtual ~FileSource() = default;
+		// path is normalized
+		virtual bool exists(const std::string& path) const = 0;
+		virtual FileData read(const std::string& path) const = 0;
+	};
+
+	// one open per read: fine for development, many small files are better packed
+	class DirectorySource final : public FileSource {
+	public:
+		explicit DirectorySource(std::filesystem::path directory)
+			: m_directory(std::move(directory)) {
+		}
+
+		virtual bool exists(const std::string& path) const override {
+			std::error_code error;
+			return std::filesystem::is_regular_file(m_directory / path, error);
+		}
+
+		virtual FileData read(const std::string& path) const override {
+			const std::filesystem::path file_path = m_directory / path;
+			std::error_code error;
+			if (!std::filesystem::is_regular_file(file_path, error))
+				return FileData();
+
+			MappedFile file;
+			if (!file.open(file_path.string()))
+				return FileData();
+			return FileData(std::move(file));
+		}
+
+	private:
+		std::filesystem::path m_directory;
+	};
+
+	class ArchiveSource final : public FileSource {
+	public:
+		explicit ArchiveSource(PackArchive archive)
+			: m_archive(std::move(archive)) {
+		}
+
+		virtual bool exists(const std::string& path) const override {
+			return m_archive.find(path) != nullptr;
+		}
+
+		virtual FileData read(const std::string& path) const override {
+			const PackArchiveEntry* entry = m_archive.find(path);
+			return entry ? m_archive.read(*entry) : FileData();
+		}
+
+	private:
+		PackArchive m_archive;
+	};
+
+	FileSystem::FileSystem() = default;
+	FileSystem::~FileSystem() = default;
+
+	bool FileSystem::mount_directory(const std::string& directory) {
+		std::error_code error;
+		if (!std::filesystem::is_directory(directory, error)) {
+			LOG_ERROR("FileSystem: directory {0} does not exist", directory);
+			return false;
+		}
+		m_sources.push_back(std::make_unique<DirectorySource>(directory));
+		return true;
+	}
+
+	bool FileSystem::mount_archive(const std::string& path) {
+		PackArchive archive;
+		if (!archive.open(path))
+			return false;
+		m_sources.push_back(std::make_unique<ArchiveSource>(std::move(archive)));
+		return true;
+	}
+
+	void FileSystem::unmount_all() {
+		m_sources.clear();
+	}
+
+	bool FileSystem::exists(const std::string& path) const {
+		const std::string normalized_path = PackArchive::normalize_path(path);
+		if (normalized_path.empty())
+			return false;
+		for (auto it = m_sources.rbegin(); it != m_sources.rend(); ++it) {
+			if ((*it)->exists(normalized_path))
+				return true;
+		}
+		return false;
+	}
+
+	FileData FileSystem::read(const std::string& path) const {
+		const std::string normalized_path = PackArchive::normalize_path(path);
+		if (normalized_path.empty()) {
+			LOG_ERROR("FileSystem: {0} is not a relative path inside the mounted sources", path);
+			return FileData();
+		}
+		for (auto it = m_sources.rbegin(); it != m_sources.rend(); ++it) {
+			if ((*it)->exists(normalized_path))
+				return (*it)->read(normalized_path);
+		}
+		return FileData();
+	}
+
+}
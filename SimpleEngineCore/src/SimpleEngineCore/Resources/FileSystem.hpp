@@ -0,0 +1,38 @@
+#pragma once
+#include "FileData.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace SimpleEngine {
+
+	class FileSource;
+
+	// Virtual file system over loose directories and packed archives. Paths are relative and '/' separated,
+	// a path is looked up in the sources from the last mounted to the first, so later mounts override
+	// earlier ones (e.g. a directory of loose files over the shipped archive).
+	// Mounting is not thread-safe, reading from any number of threads is.
+	class FileSystem {
+	public:
+		FileSystem();
+		~FileSystem();
+
+		FileSystem(const FileSystem&) = delete;
+		FileSystem& operator=(const FileSystem&) = delete;
+
+		// false if the directory does not exist
+		bool mount_directory(const std::string& directory);
+		// false if the archive can't be opened, the archive stays mapped until unmount_all()
+		bool mount_archive(const std::string& path);
+		void unmount_all();
+
+		bool exists(const std::string& path) const;
+		// invalid if no source has the file
+		FileData read(const std::string& path) const;
+
+	private:
+		std::vector<std::unique_ptr<FileSource>> m_sources;
+	};
+
+}
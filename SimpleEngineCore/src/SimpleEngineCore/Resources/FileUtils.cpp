@@ -0,0 +1,33 @@
+#include "FileUtils.hpp"
+#include "SimpleEngineCore/Log.hpp"
+
+#include <fstream>
+
+namespace SimpleEngine {
+
+	bool write_file_atomically(const std::filesystem::path& path, const std::function<void(std::ostream& file)>& write) {
+		std::filesystem::path temporary_path = path;
+		temporary_path += ".tmp";
+		std::error_code error;
+		{
+			std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+			if (file)
+				write(file);
+			file.flush();
+			if (!file) {
+				LOG_ERROR("FileUtils: can't write {0}", temporary_path.string());
+				file.close();
+				std::filesystem::remove(temporary_path, error);
+				return false;
+			}
+		}
+		std::filesystem::rename(temporary_path, path, error);
+		if (error) {
+			LOG_ERROR("FileUtils: can't write {0}: {1}", path.string(), error.message());
+			std::filesystem::remove(temporary_path, error);
+			return false;
+		}
+		return true;
+	}
+
+}
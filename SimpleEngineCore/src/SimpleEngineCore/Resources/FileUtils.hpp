@@ -0,0 +1,19 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <ostream>
+
+namespace SimpleEngine {
+
+	// size bytes at offset lie within a file of file_size bytes, checked without overflowing
+	constexpr bool is_within_file(const uint64_t offset, const uint64_t size, const size_t file_size) {
+		return offset <= file_size && size <= file_size - offset;
+	}
+
+	// write fills a binary stream under a temporary name that then replaces path, so an interrupted
+	// write never leaves a truncated file behind. False and an error logged if any step failed.
+	bool write_file_atomically(const std::filesystem::path& path, const std::function<void(std::ostream& file)>& write);
+
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace SimpleEngine {
+
+	constexpr uint64_t s_fnv1a_offset_basis = 14695981039346656037ull;
+	constexpr uint64_t s_fnv1a_prime = 1099511628211ull;
+
+	// FNV-1a 64: fast and stable across runs and platforms, so the result may be stored in files.
+	// Continues hash, so data in several pieces hashes like the concatenation.
+	inline uint64_t hash_fnv1a(const void* data, const size_t size, uint64_t hash = s_fnv1a_offset_basis) {
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		for (size_t i = 0; i < size; ++i) {
+			hash ^= bytes[i];
+			hash *= s_fnv1a_prime;
+		}
+		return hash;
+	}
+
+}
@@ -0,0 +1,172 @@
+#include "LZ4.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace SimpleEngine {
+
+	namespace {
+
+		constexpr size_t s_lz4_min_match = 4;
+		constexpr size_t s_lz4_last_literals = 5;	// the last bytes of a block are always literals
+		constexpr size_t s_lz4_match_limit = 12;	// no match may start in the last bytes of a block
+		constexpr size_t s_lz4_max_offset = 65535;
+		constexpr unsigned int s_lz4_hash_bits = 12;
+
+		uint32_t lz4_read32(const unsigned char* data) {
+			uint32_t value;
+			std::memcpy(&value, data, sizeof(value));
+			return value;
+		}
+
+		uint32_t lz4_hash(const uint32_t sequence) {
+			return (sequence * 2654435761u) >> (32 - s_lz4_hash_bits);
+		}
+
+		// 15 in the token, the rest as a run of 255 bytes and the remainder
+		unsigned char* lz4_write_length(unsigned char* output, size_t length) {
+			for (length -= 15; length >= 255; length -= 255)
+				*output++ = 255;
+			*output++ = static_cast<unsigned char>(length);
+			return output;
+		}
+
+	}
+
+	size_t LZ4::compress_bound(const size_t size) {
+		return size + size / 255 + 16;
+	}
+
+	size_t LZ4::compress(const void* source, const size_t size, void* destination, const size_t capacity) {
+		const unsigned char* input = static_cast<const unsigned char*>(source);
+		unsigned char* output = static_cast<unsigned char*>(destination);
+		unsigned char* const output_end = output + capacity;
+		// positions are stored in 32 bits
+		if (size > UINT32_MAX)
+			return 0;
+
+		size_t anchor = 0;
+		if (size > s_lz4_match_limit) {
+			uint32_t table[1 << s_lz4_hash_bits] = {};
+			const size_t match_start_limit = size - s_lz4_match_limit;
+			const size_t match_end_limit = size - s_lz4_last_literals;
+
+			size_t position = 0;
+			while (position < match_start_limit) {
+				const uint32_t sequence = lz4_read32(input + position);
+				const uint32_t hash = lz4_hash(sequence);
+				const size_t candidate = table[hash];
+				table[hash] = static_cast<uint32_t>(position);
+				if (candidate >= position || position - candidate > s_lz4_max_offset || lz4_read32(input + candidate) != sequence) {
+					++position;
+					continue;
+				}
+
+				size_t match_length = s_lz4_min_match;
+				while (position + match_length < match_end_limit && input[candidate + match_length] == input[position + match_length])
+					++match_length;
+
+				const size_t literals_length = position - anchor;
+				if (static_cast<size_t>(output_end - output) < 1 + literals_length / 255 + 1 + literals_length + 2 + (match_length - s_lz4_min_match) / 255 + 1)
+					return 0;
+
+				unsigned char* token = output++;
+				*token = static_cast<unsigned char>(std::min<size_t>(literals_length, 15) << 4);
+				if (literals_length >= 15)
+					output = lz4_write_length(output, literals_length);
+				std::memcpy(output, input + anchor, literals_length);
+				output += literals_length;
+
+				const size_t offset = position - candidate;
+				*output++ = static_cast<unsigned char>(offset);
+				*output++ = static_cast<unsigned char>(offset >> 8);
+
+				*token |= static_cast<unsigned char>(std::min<size_t>(match_length - s_lz4_min_match, 15));
+				if (match_length - s_lz4_min_match >= 15)
+					output = lz4_write_length(output, match_length - s_lz4_min_match);
+
+				position += match_length;
+				anchor = position;
+				// the middle of the match is indexed too, so repetitive data keeps matching
+				if (position - 2 < match_start_limit)
+					table[lz4_hash(lz4_read32(input + position - 2))] = static_cast<uint32_t>(position - 2);
+			}
+		}
+
+		const size_t literals_length = size - anchor;
+		if (static_cast<size_t>(output_end - output) < 1 + literals_length / 255 + 1 + literals_length)
+			return 0;
+		*output++ = static_cast<unsigned char>(std::min<size_t>(literals_length, 15) << 4);
+		if (literals_length >= 15)
+			output = lz4_write_length(output, literals_length);
+		std::memcpy(output, input + anchor, literals_length);
+		output += literals_length;
+
+		return output - static_cast<unsigned char*>(destination);
+	}
+
+	bool LZ4::decompress(const void* source, const size_t source_size, void* destination, const size_t size) {
+		const unsigned char* input = static_cast<const unsigned char*>(source);
+		const unsigned char* const input_end = input + source_size;
+		unsigned char* const output_begin = static_cast<unsigned char*>(destination);
+		unsigned char* output = output_begin;
+		unsigned char* const output_end = output_begin + size;
+
+		// false on a truncated length
+		auto read_length = [&input, input_end](size_t& length) {
+			unsigned char value;
+			do {
+				if (input == input_end)
+					return false;
+				value = *input++;
+				length += value;
+			} while (value == 255);
+			return true;
+		};
+
+		while (input < input_end) {
+			const unsigned char token = *input++;
+
+			size_t literals_length = token >> 4;
+			if (literals_length == 15 && !read_length(literals_length))
+				return false;
+			if (literals_length > static_cast<size_t>(input_end - input) || literals_length > static_cast<size_t>(output_end - output))
+				return false;
+			std::memcpy(output, input, literals_length);
+			input += literals_length;
+			output += literals_length;
+
+			// the last sequence has no match
+			if (input == input_end)
+				break;
+
+			if (input_end - input < 2)
+				return false;
+			const size_t offset = input[0] | (input[1] << 8);
+			input += 2;
+			if (offset == 0 || offset > static_cast<size_t>(output - output_begin))
+				return false;
+
+			size_t match_length = token & 15;
+			if (match_length == 15 && !read_length(match_length))
+				return false;
+			match_length += s_lz4_min_match;
+			if (match_length > static_cast<size_t>(output_end - output))
+				return false;
+
+			const unsigned char* match = output - offset;
+			if (offset >= match_length) {
+				std::memcpy(output, match, match_length);
+				output += match_length;
+			}
+			else {
+				// overlapping copy repeats the last offset bytes
+				for (size_t i = 0; i < match_length; ++i)
+					*output++ = match[i];
+			}
+		}
+		return output == output_end;
+	}
+
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <cstddef>
+
+namespace SimpleEngine {
+
+	// LZ4 block format (no frame, no checksums), compatible with the reference LZ4_compress_default
+	// and LZ4_decompress_safe. Compression is a single-probe greedy matcher: fast, not the best ratio.
+	class LZ4 {
+	public:
+		// worst case compressed size of size bytes
+		static size_t compress_bound(const size_t size);
+
+		// number of bytes written, 0 if the result does not fit into capacity
+		static size_t compress(const void* source, const size_t size, void* destination, const size_t capacity);
+
+		// false if the data is corrupted or does not decompress into exactly size bytes,
+		// never reads or writes outside of the buffers
+		static bool decompress(const void* source, const size_t source_size, void* destination, const size_t size);
+	};
+
+}
@@ -0,0 +1,139 @@
+#include "MappedFile.hpp"
+#include "SimpleEngineCore/Log.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <utility>
+
+namespace SimpleEngine {
+
+	MappedFile::~MappedFile() {
+		close();
+	}
+
+	MappedFile& MappedFile::operator=(MappedFile&& mapped_file) noexcept {
+		std::swap(m_data, mapped_file.m_data);
+		std::swap(m_size, mapped_file.m_size);
+#ifdef _WIN32
+		std::swap(m_file_handle, mapped_file.m_file_handle);
+		std::swap(m_mapping_handle, mapped_file.m_mapping_handle);
+#endif
+		return *this;
+	}
+
+	MappedFile::MappedFile(MappedFile&& mapped_file) noexcept
+		: m_data(mapped_file.m_data),
+		  m_size(mapped_file.m_size)
+#ifdef _WIN32
+		  , m_file_handle(mapped_file.m_file_handle),
+		  m_mapping_handle(mapped_file.m_mapping_handle)
+#endif
+	{
+		mapped_file.m_data = nullptr;
+		mapped_file.m_size = 0;
+#ifdef _WIN32
+		mapped_file.m_file_handle = nullptr;
+		mapped_file.m_mapping_handle = nullptr;
+#endif
+	}
+
+#ifdef _WIN32
+
+	bool MappedFile::open(const std::string& path) {
+		close();
+
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+								  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+		if (file == INVALID_HANDLE_VALUE) {
+			LOG_ERROR("MappedFile: can not open {0}", path);
+			return false;
+		}
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+			LOG_ERROR("MappedFile: {0} is empty", path);
+			CloseHandle(file);
+			return false;
+		}
+
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		const void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		if (!data) {
+			LOG_ERROR("MappedFile: can not map {0}", path);
+			if (mapping)
+				CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+
+		m_file_handle = file;
+		m_mapping_handle = mapping;
+		m_data = static_cast<const unsigned char*>(data);
+		m_size = static_cast<size_t>(size.QuadPart);
+		return true;
+	}
+
+	void MappedFile::close() {
+		if (m_data)
+			UnmapViewOfFile(m_data);
+		if (m_mapping_handle)
+			CloseHandle(m_mapping_handle);
+		if (m_file_handle)
+			CloseHandle(m_file_handle);
+		m_data = nullptr;
+		m_size = 0;
+		m_file_handle = nullptr;
+		m_mapping_handle = nullptr;
+	}
+
+#else
+
+	bool MappedFile::open(const std::string& path) {
+		close();
+
+		const int file = ::open(path.c_str(), O_RDONLY);
+		if (file < 0) {
+			LOG_ERROR("MappedFile: can not open {0}", path);
+			return false;
+		}
+
+		struct stat file_stat;
+		if (fstat(file, &file_stat) != 0 || file_stat.st_size == 0) {
+			LOG_ERROR("MappedFile: {0} is empty", path);
+			::close(file);
+			return false;
+		}
+
+		const size_t size = static_cast<size_t>(file_stat.st_size);
+		void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+		// the mapping keeps its own reference to the file
+		::close(file);
+		if (data == MAP_FAILED) {
+			LOG_ERROR("MappedFile: can not map {0}", path);
+			return false;
+		}
+
+		m_data = static_cast<const unsigned char*>(data);
+		m_size = size;
+		return true;
+	}
+
+	void MappedFile::close() {
+		if (m_data)
+			munmap(const_cast<unsigned char*>(m_data), m_size);
+		m_data = nullptr;
+		m_size = 0;
+	}
+
+#endif
+
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+namespace SimpleEngine {
+
+	// Read-only memory mapping of a whole file. The pages are loaded by the OS on first access,
+	// so opening a large file costs nothing until its data is read.
+	class MappedFile {
+	public:
+		MappedFile() = default;
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile& operator=(MappedFile&& mapped_file) noexcept;
+		MappedFile(MappedFile&& mapped_file) noexcept;
+
+		// closes the previous mapping, false if the file can not be mapped or is empty
+		bool open(const std::string& path);
+		void close();
+
+		bool is_open() const { return m_data != nullptr; }
+		const unsigned char* get_data() const { return m_data; }
+		size_t get_size() const { return m_size; }
+
+	private:
+		const unsigned char* m_data = nullptr;
+		size_t m_size = 0;
+#ifdef _WIN32
+		void* m_file_handle = nullptr;
+		void* m_mapping_handle = nullptr;
+#endif
+	};
+
+}
@@ -0,0 +1,197 @@
+#include "MeshFile.hpp"
+#include "FileSystem.hpp"
+#include "FileUtils.hpp"
+#include "SimpleEngineCore/Log.hpp"
+
+#include <utility>
+
+namespace SimpleEngine {
+
+	namespace {
+
+		size_t align_up(const size_t value, const size_t alignment) {
+			return (value + alignment - 1) / alignment * alignment;
+		}
+
+		// Int2_10_10_10_Norm is the last ShaderDataType
+		constexpr uint8_t s_max_shader_data_type = static_cast<uint8_t>(ShaderDataType::Int2_10_10_10_Norm);
+
+		bool is_valid_header(const MeshFileHeader& header, const size_t file_size) {
+			if (header.magic != s_mesh_file_magic || header.version != s_mesh_file_version)
+				return false;
+			if (header.vertex_stride == 0 || header.attributes_count == 0 || header.attributes_count > BufferLayout::s_max_elements)
+				return false;
+			if (header.index_type > static_cast<uint32_t>(EIndexType::UInt32) || header.lods_count > s_mesh_max_lods)
+				return false;
+			for (uint32_t i = 0; i < header.attributes_count; ++i) {
+				if (header.attributes[i].type > s_max_shader_data_type)
+					return false;
+			}
+			if (header.vertices_offset % s_mesh_file_alignment != 0 || header.indices_offset % s_mesh_file_alignment != 0)
+				return false;
+
+			const uint64_t vertices_size = static_cast<uint64_t>(header.vertices_count) * header.vertex_stride;
+			const uint64_t indices_size = static_cast<uint64_t>(header.indices_count) * index_type_size(static_cast<EIndexType>(header.index_type));
+			if (header.vertices_offset < sizeof(MeshFileHeader) || !is_within_file(header.vertices_offset, vertices_size, file_size)
+				|| header.indices_offset < sizeof(MeshFileHeader) || !is_within_file(header.indices_offset, indices_size, file_size)) {
+				return false;
+			}
+
+			for (uint32_t i = 0; i < header.lods_count; ++i) {
+				if (static_cast<uint64_t>(header.lods[i].first_index) + header.lods[i].indices_count > header.indices_count)
+					return false;
+			}
+			return true;
+		}
+
+		// the GL does not check indices, one past the vertices reads outside of the vertex buffer
+		template<typename T>
+		bool are_indices_within(const unsigned char* data, const uint32_t indices_count, const uint32_t vertices_count) {
+			const T* indices = reinterpret_cast<const T*>(data);
+			for (uint32_t i = 0; i < indices_count; ++i) {
+				if (indices[i] >= vertices_count)
+					return false;
+			}
+			return true;
+		}
+
+		bool are_valid_indices(const MeshFileHeader& header, const unsigned char* file_data) {
+			const unsigned char* indices = file_data + header.indices_offset;
+			switch (static_cast<EIndexType>(header.index_type)) {
+			case EIndexType::UInt16:	return are_indices_within<uint16_t>(indices, header.indices_count, header.vertices_count);
+			case EIndexType::UInt32:	return are_indices_within<uint32_t>(indices, header.indices_count, header.vertices_count);
+			}
+			return false;
+		}
+
+		template<typename T>
+		std::vector<unsigned char> pack_indices(const std::vector<uint32_t>& indices) {
+			std::vector<unsigned char> packed(indices.size() * sizeof(T));
+			T* output = reinterpret_cast<T*>(packed.data());
+			for (size_t i = 0; i < indices.size(); ++i)
+				output[i] = static_cast<T>(indices[i]);
+			return packed;
+		}
+
+	}
+
+	bool MeshFile::open(const std::string& path) {
+		MappedFile file;
+		if (!file.open(path))
+			return false;
+		return open(FileData(std::move(file)), path);
+	}
+
+	bool MeshFile::open(const FileSystem& file_system, const std::string& path) {
+		FileData file = file_system.read(path);
+		if (!file.is_valid()) {
+			LOG_ERROR("MeshFile: {0} is not found", path);
+			return false;
+		}
+		return open(std::move(file), path);
+	}
+
+	bool MeshFile::open(FileData file, const std::string& path) {
+		close();
+		m_file = std::move(file);
+
+		const MeshFileHeader* header = reinterpret_cast<const MeshFileHeader*>(m_file.get_data());
+		if (m_file.get_size() < sizeof(MeshFileHeader) || !is_valid_header(*header, m_file.get_size())) {
+			LOG_ERROR("MeshFile: {0} is not a valid mesh file of version {1}", path, s_mesh_file_version);
+			m_file = FileData();
+			return false;
+		}
+
+		if (!are_valid_indices(*header, m_file.get_data())) {
+			LOG_ERROR("MeshFile: {0} has indices out of its {1} vertices", path, header->vertices_count);
+			m_file = FileData();
+			return false;
+		}
+
+		m_header = header;
+		if (!get_layout().is_valid()) {
+			LOG_ERROR("MeshFile: {0} has an invalid vertex layout", path);
+			close();
+			return false;
+		}
+		return true;
+	}
+
+	void MeshFile::close() {
+		m_header = nullptr;
+		m_file = FileData();
+	}
+
+	BufferLayout MeshFile::get_layout() const {
+		BufferElement elements[BufferLayout::s_max_elements];
+		for (uint32_t i = 0; i < m_header->attributes_count; ++i) {
+			const MeshFileAttribute& attribute = m_header->attributes[i];
+			elements[i] = BufferElement(static_cast<ShaderDataType>(attribute.type), 0, attribute.offset);
+		}
+		return BufferLayout(elements, m_header->attributes_count, static_cast<int>(m_header->vertex_stride));
+	}
+
+	bool MeshFile::write(const std::string& path, const MeshData& mesh) {
+		if (mesh.layout.get_elements_count() == 0 || mesh.lods.size() > s_mesh_max_lods
+			|| mesh.vertices.size() != static_cast<size_t>(mesh.vertices_count) * mesh.layout.get_stride()) {
+			LOG_ERROR("MeshFile: mesh written to {0} is inconsistent", path);
+			return false;
+		}
+		// checked before the indices are narrowed, where they would wrap around silently
+		for (const uint32_t index : mesh.indices) {
+			if (index >= mesh.vertices_count) {
+				LOG_ERROR("MeshFile: mesh written to {0} has index {1} out of {2} vertices", path, index, mesh.vertices_count);
+				return false;
+			}
+		}
+		for (const MeshLod& lod : mesh.lods) {
+			if (static_cast<uint64_t>(lod.first_index) + lod.indices_count > mesh.indices.size()) {
+				LOG_ERROR("MeshFile: mesh written to {0} has a LOD out of its indices", path);
+				return false;
+			}
+		}
+
+		MeshFileHeader header{};
+		header.magic = s_mesh_file_magic;
+		header.version = s_mesh_file_version;
+		header.vertex_stride = static_cast<uint32_t>(mesh.layout.get_stride());
+		header.attributes_count = static_cast<uint32_t>(mesh.layout.get_elements_count());
+		size_t attribute_index = 0;
+		for (const BufferElement& element : mesh.layout) {
+			MeshFileAttribute& attribute = header.attributes[attribute_index++];
+			attribute.type = static_cast<uint8_t>(element.type);
+			attribute.offset = static_cast<uint32_t>(element.offset);
+		}
+		header.vertices_count = mesh.vertices_count;
+
+		const EIndexType index_type = select_index_type(mesh.vertices_count);
+		std::vector<unsigned char> indices;
+		switch (index_type) {
+		case EIndexType::UInt16:	indices = pack_indices<uint16_t>(mesh.indices); break;
+		case EIndexType::UInt32:	indices = pack_indices<uint32_t>(mesh.indices); break;
+		}
+		header.index_type = static_cast<uint32_t>(index_type);
+		header.indices_count = static_cast<uint32_t>(mesh.indices.size());
+
+		header.lods_count = static_cast<uint32_t>(mesh.lods.size());
+		std::copy(mesh.lods.begin(), mesh.lods.end(), header.lods);
+		if (mesh.lods.empty()) {
+			header.lods_count = 1;
+			header.lods[0] = { 0, header.indices_count, 0.f };
+		}
+
+		header.vertices_offset = align_up(sizeof(MeshFileHeader), s_mesh_file_alignment);
+		header.indices_offset = align_up(header.vertices_offset + mesh.vertices.size(), s_mesh_file_alignment);
+		header.bounds = mesh.bounds;
+
+		return write_file_atomically(path, [&header, &mesh, &indices](std::ostream& file) {
+			const char padding[s_mesh_file_alignment] = {};
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(padding, header.vertices_offset - sizeof(header));
+			file.write(reinterpret_cast<const char*>(mesh.vertices.data()), mesh.vertices.size());
+			file.write(padding, header.indices_offset - header.vertices_offset - mesh.vertices.size());
+			file.write(reinterpret_cast<const char*>(indices.data()), indices.size());
+		});
+	}
+
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include "FileData.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/VertexBuffer.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/IndexBuffer.hpp"
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace SimpleEngine {
+
+	class FileSystem;
+
+	// Engine mesh file (.mesh): a header followed by the vertex and the index blobs,
+	// each aligned so the mapped pointers can be handed to the GL as they are.
+	// All LODs share the vertices, each one is a range of the index blob. Little endian.
+
+	constexpr uint32_t s_mesh_file_magic = 0x48534d45; // "EMSH"
+	constexpr uint32_t s_mesh_file_version = 2; // 2 - EIndexType without UInt8
+	constexpr size_t s_mesh_file_alignment = 16;
+	constexpr size_t s_mesh_max_lods = 8;
+
+	struct MeshLod {
+		uint32_t first_index = 0;
+		uint32_t indices_count = 0;
+		float error = 0.f; // simplification cell size relative to the mesh size, 0 for the source mesh
+	};
+
+	struct MeshBounds {
+		float min[3] = { 0.f, 0.f, 0.f };
+		float max[3] = { 0.f, 0.f, 0.f };
+		float center[3] = { 0.f, 0.f, 0.f };
+		float radius = 0.f;
+	};
+
+	struct MeshFileAttribute {
+		uint8_t type; // ShaderDataType
+		uint8_t reserved[3];
+		uint32_t offset;
+	};
+
+	struct MeshFileHeader {
+		uint32_t magic;
+		uint32_t version;
+
+		uint32_t vertex_stride;
+		uint32_t attributes_count;
+		MeshFileAttribute attributes[BufferLayout::s_max_elements];
+		uint32_t vertices_count;
+
+		uint32_t index_type; // EIndexType
+		uint32_t indices_count;
+		uint32_t lods_count;
+		MeshLod lods[s_mesh_max_lods];
+
+		// from the start of the file
+		uint64_t vertices_offset;
+		uint64_t indices_offset;
+
+		MeshBounds bounds;
+	};
+	static_assert(std::is_trivially_copyable_v<MeshFileHeader>, "mesh file header is read straight from the mapping");
+	static_assert(sizeof(MeshFileHeader) % alignof(uint64_t) == 0, "mesh file header must not need tail padding");
+
+	// mesh in memory, produced by the importers and written by MeshFile::write
+	struct MeshData {
+		BufferLayout layout;
+		std::vector<unsigned char> vertices;
+		uint32_t vertices_count = 0;
+		std::vector<uint32_t> indices; // narrowed to the smallest index type on write
+		std::vector<MeshLod> lods;
+		MeshBounds bounds;
+	};
+
+	// Maps a mesh file and validates its header, the data is used in place without parsing.
+	class MeshFile {
+	public:
+		bool open(const std::string& path);
+		bool open(const FileSystem& file_system, const std::string& path);
+		void close();
+		bool is_open() const { return m_header != nullptr; }
+
+		const MeshFileHeader& get_header() const { return *m_header; }
+		BufferLayout get_layout() const;
+		const void* get_vertices() const { return m_file.get_data() + m_header->vertices_offset; }
+		size_t get_vertices_size() const { return static_cast<size_t>(m_header->vertices_count) * m_header->vertex_stride; }
+		const void* get_indices() const { return m_file.get_data() + m_header->indices_offset; }
+		uint32_t get_indices_count() const { return m_header->indices_count; }
+		EIndexType get_index_type() const { return static_cast<EIndexType>(m_header->index_type); }
+
+		static bool write(const std::string& path, const MeshData& mesh);
+
+	private:
+		bool open(FileData file, const std::string& path);
+
+		FileData m_file;
+		const MeshFileHeader* m_header = nullptr;
+	};
+
+}
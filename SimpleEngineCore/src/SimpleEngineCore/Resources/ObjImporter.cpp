@@ -0,0 +1,370 @@
+#include "ObjImporter.hpp"
+#include "SimpleEngineCore/Log.hpp"
+#include "SimpleEngineCore/Rendering/MeshOptimizer.hpp"
+#include "SimpleEngineCore/Rendering/VertexQuantization.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace SimpleEngine {
+
+	namespace {
+
+		constexpr unsigned int s_max_lod_grid_size = 1024;
+		// a LOD is kept only if it drops at least this share of the previous one's triangles
+		constexpr float s_min_lod_reduction = 0.05f;
+
+		struct ObjCorner {
+			int position;
+			int texture_coord;	// -1 - missing
+			int normal;			// -1 - missing
+		};
+
+		struct CellTriangle {
+			uint32_t cells[3];
+
+			bool operator==(const CellTriangle& other) const {
+				return cells[0] == other.cells[0] && cells[1] == other.cells[1] && cells[2] == other.cells[2];
+			}
+		};
+
+		struct CellTriangleHash {
+			size_t operator()(const CellTriangle& triangle) const {
+				uint64_t hash = triangle.cells[0];
+				hash = hash * 0x9e3779b97f4a7c15ull + triangle.cells[1];
+				hash = hash * 0x9e3779b97f4a7c15ull + triangle.cells[2];
+				return static_cast<size_t>(hash ^ (hash >> 32));
+			}
+		};
+
+		const char* skip_spaces(const char* text) {
+			while (*text == ' ' || *text == '\t')
+				++text;
+			return text;
+		}
+
+		const char* next_line(const char* text) {
+			while (*text && *text != '\n')
+				++text;
+			return *text ? text + 1 : text;
+		}
+
+		const char* parse_floats(const char* text, float* values, const size_t count) {
+			for (size_t i = 0; i < count; ++i) {
+				char* end = nullptr;
+				values[i] = std::strtof(text, &end);
+				text = end;
+			}
+			return text;
+		}
+
+		// 1-based, negative values count from the last element; -1 if invalid
+		int resolve_index(const long index, const size_t elements_count) {
+			const long resolved = index > 0 ? index - 1 : static_cast<long>(elements_count) + index;
+			return resolved >= 0 && resolved < static_cast<long>(elements_count) ? static_cast<int>(resolved) : -1;
+		}
+
+		// "v", "v/vt", "v//vn" or "v/vt/vn"
+		bool parse_corner(const char*& text, ObjCorner& corner,
+						  const size_t positions_count, const size_t texture_coords_count, const size_t normals_count) {
+			char* end = nullptr;
+			corner = { resolve_index(std::strtol(text, &end, 10), positions_count), -1, -1 };
+			if (end == text)
+				return false;
+			text = end;
+			if (*text == '/') {
+				++text;
+				if (*text != '/') {
+					corner.texture_coord = resolve_index(std::strtol(text, &end, 10), texture_coords_count);
+					text = end;
+				}
+				if (*text == '/') {
+					++text;
+					corner.normal = resolve_index(std::strtol(text, &end, 10), normals_count);
+					text = end;
+				}
+			}
+			return corner.position >= 0;
+		}
+
+		void compute_bounds(const std::vector<StaticMeshVertex>& vertices, MeshBounds& bounds) {
+			bounds = {};
+			if (vertices.empty())
+				return;
+
+			for (size_t k = 0; k < 3; ++k) {
+				bounds.min[k] = vertices[0].position[k];
+				bounds.max[k] = vertices[0].position[k];
+			}
+			for (const StaticMeshVertex& vertex : vertices) {
+				for (size_t k = 0; k < 3; ++k) {
+					bounds.min[k] = std::min(bounds.min[k], vertex.position[k]);
+					bounds.max[k] = std::max(bounds.max[k], vertex.position[k]);
+				}
+			}
+			for (size_t k = 0; k < 3; ++k)
+				bounds.center[k] = (bounds.min[k] + bounds.max[k]) * 0.5f;
+
+			float radius_squared = 0.f;
+			for (const StaticMeshVertex& vertex : vertices) {
+				float distance_squared = 0.f;
+				for (size_t k = 0; k < 3; ++k)
+					distance_squared += (vertex.position[k] - bounds.center[k]) * (vertex.position[k] - bounds.center[k]);
+				radius_squared = std::max(radius_squared, distance_squared);
+			}
+			bounds.radius = std::sqrt(radius_squared);
+		}
+
+		// Vertex clustering: vertices falling into one cell of a grid_size^3 grid collapse into the vertex
+		// nearest to the cell centroid, triangles that become degenerate or duplicate are dropped
+		void simplify_by_clustering(const std::vector<uint32_t>& indices, const std::vector<StaticMeshVertex>& vertices,
+									const MeshBounds& bounds, const unsigned int grid_size, std::vector<uint32_t>& simplified) {
+			const float extent = std::max({ bounds.max[0] - bounds.min[0], bounds.max[1] - bounds.min[1], bounds.max[2] - bounds.min[2] });
+			const float scale = extent > 0.f ? grid_size / extent : 0.f;
+
+			std::unordered_map<uint64_t, uint32_t> cells;
+			std::vector<uint32_t> vertex_cells(vertices.size());
+			std::vector<float> cell_centroids;
+			std::vector<uint32_t> cell_counts;
+			for (size_t v = 0; v < vertices.size(); ++v) {
+				uint64_t key = 0;
+				for (size_t k = 0; k < 3; ++k) {
+					const unsigned int cell = std::min(grid_size - 1, static_cast<unsigned int>((vertices[v].position[k] - bounds.min[k]) * scale));
+					key = key * grid_size + cell;
+				}
+				const auto [it, inserted] = cells.emplace(key, static_cast<uint32_t>(cell_counts.size()));
+				if (inserted) {
+					cell_centroids.insert(cell_centroids.end(), { 0.f, 0.f, 0.f });
+					cell_counts.push_back(0);
+				}
+				vertex_cells[v] = it->second;
+				for (size_t k = 0; k < 3; ++k)
+					cell_centroids[it->second * 3 + k] += vertices[v].position[k];
+				++cell_counts[it->second];
+			}
+
+			for (size_t c = 0; c < cell_counts.size(); ++c) {
+				for (size_t k = 0; k < 3; ++k)
+					cell_centroids[c * 3 + k] /= cell_counts[c];
+			}
+
+			std::vector<uint32_t> representatives(cell_counts.size(), ~0u);
+			std::vector<float> representative_distances(cell_counts.size());
+			for (size_t v = 0; v < vertices.size(); ++v) {
+				const uint32_t cell = vertex_cells[v];
+				float distance = 0.f;
+				for (size_t k = 0; k < 3; ++k)
+					distance += (vertices[v].position[k] - cell_centroids[cell * 3 + k]) * (vertices[v].position[k] - cell_centroids[cell * 3 + k]);
+				if (representatives[cell] == ~0u || distance < representative_distances[cell]) {
+					representatives[cell] = static_cast<uint32_t>(v);
+					representative_distances[cell] = distance;
+				}
+			}
+
+			simplified.clear();
+			std::unordered_set<CellTriangle, CellTriangleHash> emitted_triangles;
+			for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+				const uint32_t a = vertex_cells[indices[t]];
+				const uint32_t b = vertex_cells[indices[t + 1]];
+				const uint32_t c = vertex_cells[indices[t + 2]];
+				if (a == b || b == c || a == c)
+					continue;
+
+				// the same cells in any rotation are the same triangle
+				const uint32_t first = std::min({ a, b, c });
+				const CellTriangle triangle{ {
+					first,
+					first == a ? b : (first == b ? c : a),
+					first == a ? c : (first == b ? a : b)
+				} };
+				if (!emitted_triangles.insert(triangle).second)
+					continue;
+
+				simplified.insert(simplified.end(), { representatives[a], representatives[b], representatives[c] });
+			}
+		}
+
+		// finest grid that brings the triangles count down to target_triangles
+		unsigned int find_lod_grid_size(const std::vector<uint32_t>& indices, const std::vector<StaticMeshVertex>& vertices,
+										const MeshBounds& bounds, const size_t target_triangles, std::vector<uint32_t>& simplified) {
+			unsigned int low = 1;
+			unsigned int high = s_max_lod_grid_size;
+			unsigned int best = 0;
+			std::vector<uint32_t> candidate;
+			while (low <= high) {
+				const unsigned int grid_size = (low + high) / 2;
+				simplify_by_clustering(indices, vertices, bounds, grid_size, candidate);
+				if (candidate.size() / 3 <= target_triangles) {
+					best = grid_size;
+					simplified.swap(candidate);
+					low = grid_size + 1;
+				}
+				else {
+					high = grid_size - 1;
+				}
+			}
+			return best;
+		}
+
+	}
+
+	bool ObjImporter::import(const std::string& path, MeshData& mesh, const ObjImportSettings& settings) {
+		std::ifstream file(path, std::ios::binary);
+		if (!file) {
+			LOG_ERROR("ObjImporter: can't open {0}", path);
+			return false;
+		}
+		std::stringstream buffer;
+		buffer << file.rdbuf();
+		const std::string text = buffer.str();
+		if (!import_from_memory(text.data(), text.size(), mesh, settings)) {
+			LOG_ERROR("ObjImporter: {0} has no triangles", path);
+			return false;
+		}
+		return true;
+	}
+
+	bool ObjImporter::import_from_memory(const char* text, const size_t size, MeshData& mesh, const ObjImportSettings& settings) {
+		// strtof/strtol need a terminated string
+		const std::string source(text, size);
+
+		std::vector<float> positions;
+		std::vector<float> texture_coords;
+		std::vector<float> normals;
+		std::vector<ObjCorner> corners;
+		std::vector<ObjCorner> face;
+
+		for (const char* line = source.c_str(); *line; line = next_line(line)) {
+			const char* cursor = skip_spaces(line);
+			if (cursor[0] == 'v' && (cursor[1] == ' ' || cursor[1] == '\t')) {
+				float values[3];
+				parse_floats(cursor + 1, values, 3);
+				positions.insert(positions.end(), values, values + 3);
+			}
+			else if (cursor[0] == 'v' && cursor[1] == 't') {
+				float values[2];
+				parse_floats(cursor + 2, values, 2);
+				texture_coords.insert(texture_coords.end(), values, values + 2);
+			}
+			else if (cursor[0] == 'v' && cursor[1] == 'n') {
+				float values[3];
+				parse_floats(cursor + 2, values, 3);
+				normals.insert(normals.end(), values, values + 3);
+			}
+			else if (cursor[0] == 'f' && (cursor[1] == ' ' || cursor[1] == '\t')) {
+				face.clear();
+				cursor = skip_spaces(cursor + 1);
+				ObjCorner corner;
+				while (*cursor && *cursor != '\n' && *cursor != '\r'
+					&& parse_corner(cursor, corner, positions.size() / 3, texture_coords.size() / 2, normals.size() / 3)) {
+					face.push_back(corner);
+					cursor = skip_spaces(cursor);
+				}
+				for (size_t i = 2; i < face.size(); ++i)
+					corners.insert(corners.end(), { face[0], face[i - 1], face[i] });
+			}
+		}
+
+		if (corners.empty())
+			return false;
+
+		// smooth normals for the corners without one, area weighted
+		std::vector<float> generated_normals;
+		const bool has_missing_normals = std::any_of(corners.begin(), corners.end(), [](const ObjCorner& corner) { return corner.normal < 0; });
+		if (has_missing_normals) {
+			generated_normals.assign(positions.size(), 0.f);
+			for (size_t t = 0; t < corners.size(); t += 3) {
+				const float* p0 = &positions[corners[t].position * 3];
+				const float* p1 = &positions[corners[t + 1].position * 3];
+				const float* p2 = &positions[corners[t + 2].position * 3];
+				const float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+				const float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+				const float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+				for (size_t c = 0; c < 3; ++c) {
+					for (size_t k = 0; k < 3; ++k)
+						generated_normals[corners[t + c].position * 3 + k] += n[k];
+				}
+			}
+		}
+
+		// unquantized vertex per corner: position 3, normal 3, texture coordinates 2
+		constexpr size_t corner_floats = 8;
+		std::vector<float> corner_vertices(corners.size() * corner_floats, 0.f);
+		for (size_t i = 0; i < corners.size(); ++i) {
+			const ObjCorner& corner = corners[i];
+			float* vertex = &corner_vertices[i * corner_floats];
+			std::copy_n(&positions[corner.position * 3], 3, vertex);
+
+			const float* normal = corner.normal >= 0 ? &normals[corner.normal * 3] : &generated_normals[corner.position * 3];
+			const float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			const float inverse_length = length > 0.f ? 1.f / length : 0.f;
+			for (size_t k = 0; k < 3; ++k)
+				vertex[3 + k] = normal[k] * inverse_length;
+
+			if (corner.texture_coord >= 0)
+				std::copy_n(&texture_coords[corner.texture_coord * 2], 2, vertex + 6);
+		}
+
+		std::vector<StaticMeshVertex> quantized(corners.size());
+		constexpr size_t source_stride = corner_floats * sizeof(float);
+		for (size_t i = 0; i < corners.size(); ++i)
+			std::memcpy(quantized[i].position, &corner_vertices[i * corner_floats], sizeof(quantized[i].position));
+		VertexQuantization::to_snorm_2_10_10_10(&quantized[0].normal, sizeof(StaticMeshVertex), corner_vertices.data() + 3, source_stride, corners.size(), 3);
+		VertexQuantization::to_half(quantized[0].texture_coord, sizeof(StaticMeshVertex), corner_vertices.data() + 6, source_stride, corners.size(), 2);
+
+		// corners equal after quantization become one vertex
+		std::vector<uint32_t> remap;
+		const size_t vertices_count = MeshOptimizer::generate_vertex_remap(remap, nullptr, 0, quantized.data(), quantized.size(), sizeof(StaticMeshVertex));
+		std::vector<StaticMeshVertex> vertices(vertices_count);
+		MeshOptimizer::remap_vertex_buffer(vertices.data(), quantized.data(), quantized.size(), sizeof(StaticMeshVertex), remap);
+		std::vector<uint32_t> indices(remap.begin(), remap.end());
+
+		if (settings.optimize) {
+			MeshOptimizer::optimize_vertex_cache(indices.data(), indices.data(), indices.size(), vertices.size());
+			MeshOptimizer::optimize_overdraw(indices.data(), indices.data(), indices.size(),
+				vertices[0].position, vertices.size(), sizeof(StaticMeshVertex));
+
+			std::vector<StaticMeshVertex> fetch_ordered(vertices.size());
+			const size_t used_count = MeshOptimizer::optimize_vertex_fetch(fetch_ordered.data(), indices.data(), indices.size(),
+				vertices.data(), vertices.size(), sizeof(StaticMeshVertex));
+			fetch_ordered.resize(used_count);
+			vertices.swap(fetch_ordered);
+		}
+
+		mesh.layout = StaticMeshVertexLayout::s_layout;
+		mesh.vertices_count = static_cast<uint32_t>(vertices.size());
+		mesh.vertices.resize(vertices.size() * sizeof(StaticMeshVertex));
+		std::memcpy(mesh.vertices.data(), vertices.data(), mesh.vertices.size());
+		compute_bounds(vertices, mesh.bounds);
+
+		mesh.indices = indices;
+		mesh.lods.assign(1, { 0, static_cast<uint32_t>(indices.size()), 0.f });
+
+		const unsigned int lods_count = std::clamp(settings.lods_count, 1u, static_cast<unsigned int>(s_mesh_max_lods));
+		size_t previous_triangles = indices.size() / 3;
+		std::vector<uint32_t> lod_indices;
+		for (unsigned int lod = 1; lod < lods_count; ++lod) {
+			const size_t target_triangles = static_cast<size_t>(indices.size() / 3 * std::pow(settings.lod_reduction, static_cast<float>(lod)));
+			const unsigned int grid_size = find_lod_grid_size(indices, vertices, mesh.bounds, target_triangles, lod_indices);
+			const size_t lod_triangles = lod_indices.size() / 3;
+			if (grid_size == 0 || lod_triangles == 0 || lod_triangles > previous_triangles * (1.f - s_min_lod_reduction))
+				break;
+
+			if (settings.optimize)
+				MeshOptimizer::optimize_vertex_cache(lod_indices.data(), lod_indices.data(), lod_indices.size(), vertices.size());
+			mesh.lods.push_back({ static_cast<uint32_t>(mesh.indices.size()), static_cast<uint32_t>(lod_indices.size()), 1.f / grid_size });
+			mesh.indices.insert(mesh.indices.end(), lod_indices.begin(), lod_indices.end());
+			previous_triangles = lod_triangles;
+		}
+
+		LOG_INFO("ObjImporter: {0} vertices, {1} triangles, {2} LODs", mesh.vertices_count, indices.size() / 3, mesh.lods.size());
+		return true;
+	}
+
+}
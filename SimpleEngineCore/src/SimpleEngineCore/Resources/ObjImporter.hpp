@@ -0,0 +1,37 @@
+#pragma once
+#include "MeshFile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace SimpleEngine {
+
+	// vertex of imported static meshes, 20 bytes
+	struct StaticMeshVertex {
+		float position[3];
+		uint32_t normal;			// Int2_10_10_10_Norm
+		uint16_t texture_coord[2];	// Half2
+	};
+
+	using StaticMeshVertexLayout = VertexLayout<StaticMeshVertex,
+		VERTEX_ATTRIBUTE(StaticMeshVertex, position, ShaderDataType::Float3),
+		VERTEX_ATTRIBUTE(StaticMeshVertex, normal, ShaderDataType::Int2_10_10_10_Norm),
+		VERTEX_ATTRIBUTE(StaticMeshVertex, texture_coord, ShaderDataType::Half2)>;
+
+	struct ObjImportSettings {
+		bool optimize = true;			// vertex cache, overdraw and vertex fetch passes
+		unsigned int lods_count = 4;	// including the source mesh
+		float lod_reduction = 0.5f;		// target triangles ratio between two LODs
+	};
+
+	// Wavefront OBJ to MeshData: polygons are triangulated as fans, all groups and objects are merged,
+	// missing normals are generated smooth. Duplicate vertices are merged after quantization,
+	// LODs are made by vertex clustering and reuse the vertices of the source mesh.
+	class ObjImporter {
+	public:
+		static bool import(const std::string& path, MeshData& mesh, const ObjImportSettings& settings = {});
+		static bool import_from_memory(const char* text, const size_t size, MeshData& mesh, const ObjImportSettings& settings = {});
+	};
+
+}
@@ -0,0 +1,230 @@
+#include "PackArchive.hpp"
+#include "FileUtils.hpp"
+#include "Hash.hpp"
+#include "LZ4.hpp"
+#include "SimpleEngineCore/Log.hpp"
+
+#include <algorithm>
+#include <filesystem>
+
+namespace SimpleEngine {
+
+	namespace {
+
+		// the largest expansion of an LZ4 block is about 255x, plus a few bytes for the tiniest blocks
+		constexpr uint64_t s_lz4_max_ratio = 255;
+		constexpr uint64_t s_lz4_max_ratio_slack = 16;
+
+		bool is_valid_header(const PackArchiveHeader& header, const size_t file_size) {
+			if (header.magic != s_pack_archive_magic || header.version != s_pack_archive_version)
+				return false;
+			if (header.entries_offset % alignof(PackArchiveEntry) != 0 || header.entries_offset < sizeof(PackArchiveHeader)
+				|| header.entries_offset > file_size
+				|| header.entries_count > (file_size - header.entries_offset) / sizeof(PackArchiveEntry)
+				|| header.paths_offset < sizeof(PackArchiveHeader) || !is_within_file(header.paths_offset, header.paths_size, file_size)) {
+				return false;
+			}
+
+			const PackArchiveEntry* entries = reinterpret_cast<const PackArchiveEntry*>(
+				reinterpret_cast<const unsigned char*>(&header) + header.entries_offset);
+			for (uint32_t i = 0; i < header.entries_count; ++i) {
+				const PackArchiveEntry& entry = entries[i];
+				if (entry.offset % s_pack_archive_alignment != 0 || !is_within_file(entry.offset, entry.stored_size, file_size)
+					|| entry.path_offset > header.paths_size || entry.path_size > header.paths_size - entry.path_offset)
+					return false;
+				if (entry.compression > static_cast<uint32_t>(EPackCompression::LZ4)
+					|| (entry.compression == static_cast<uint32_t>(EPackCompression::None) && entry.stored_size != entry.size))
+					return false;
+				// read() allocates the decompressed size up front
+				if (entry.compression == static_cast<uint32_t>(EPackCompression::LZ4)
+					&& (entry.size > s_pack_archive_max_compressed_entry_size
+						|| entry.size > entry.stored_size * s_lz4_max_ratio + s_lz4_max_ratio_slack))
+					return false;
+				// find() relies on the order
+				if (i > 0 && entries[i - 1].path_hash > entry.path_hash)
+					return false;
+			}
+			return true;
+		}
+
+	}
+
+	bool PackArchive::open(const std::string& path) {
+		close();
+		if (!m_file.open(path))
+			return false;
+
+		const PackArchiveHeader* header = reinterpret_cast<const PackArchiveHeader*>(m_file.get_data());
+		if (m_file.get_size() < sizeof(PackArchiveHeader) || !is_valid_header(*header, m_file.get_size())) {
+			LOG_ERROR("PackArchive: {0} is not a valid archive of version {1}", path, s_pack_archive_version);
+			m_file.close();
+			return false;
+		}
+
+		m_header = header;
+		m_entries = reinterpret_cast<const PackArchiveEntry*>(m_file.get_data() + header->entries_offset);
+		m_paths = reinterpret_cast<const char*>(m_file.get_data() + header->paths_offset);
+		return true;
+	}
+
+	void PackArchive::close() {
+		m_header = nullptr;
+		m_entries = nullptr;
+		m_paths = nullptr;
+		m_file.close();
+	}
+
+	const PackArchiveEntry* PackArchive::find(const std::string& path) const {
+		const uint64_t hash = hash_path(path);
+		const PackArchiveEntry* entries_end = m_entries + m_header->entries_count;
+		const PackArchiveEntry* entry = std::lower_bound(m_entries, entries_end, hash,
+			[](const PackArchiveEntry& entry, const uint64_t hash) { return entry.path_hash < hash; });
+		for (; entry != entries_end && entry->path_hash == hash; ++entry) {
+			if (path.size() == entry->path_size && path.compare(0, path.size(), m_paths + entry->path_offset, entry->path_size) == 0)
+				return entry;
+		}
+		return nullptr;
+	}
+
+	FileData PackArchive::read(const PackArchiveEntry& entry) const {
+		const unsigned char* data = m_file.get_data() + entry.offset;
+		if (entry.compression == static_cast<uint32_t>(EPackCompression::None))
+			return FileData(data, entry.size);
+
+		std::vector<unsigned char> buffer(entry.size);
+		if (!LZ4::decompress(data, entry.stored_size, buffer.data(), buffer.size())) {
+			LOG_ERROR("PackArchive: {0} is corrupted", get_entry_path(entry));
+			return FileData();
+		}
+		return FileData(std::move(buffer));
+	}
+
+	std::string PackArchive::get_entry_path(const PackArchiveEntry& entry) const {
+		return std::string(m_paths + entry.path_offset, entry.path_size);
+	}
+
+	bool PackArchive::write(const std::string& path, std::vector<PackArchiveSource> sources) {
+		struct PendingEntry {
+			PackArchiveEntry entry;
+			std::string path;
+			MappedFile file;
+			std::vector<unsigned char> compressed;
+		};
+
+		std::vector<PendingEntry> pending(sources.size());
+		for (size_t i = 0; i < sources.size(); ++i) {
+			PendingEntry& item = pending[i];
+			item.path = normalize_path(sources[i].path);
+			if (item.path.empty()) {
+				LOG_ERROR("PackArchive: {0} is not a relative path inside the archive", sources[i].path);
+				return false;
+			}
+			item.entry = {};
+			item.entry.path_hash = hash_path(item.path);
+
+			// empty files can't be mapped, they are stored without data
+			std::error_code error;
+			if (std::filesystem::file_size(sources[i].file_path, error) != 0 || error) {
+				if (!item.file.open(sources[i].file_path)) {
+					LOG_ERROR("PackArchive: can't read {0}", sources[i].file_path);
+					return false;
+				}
+			}
+			item.entry.size = item.file.get_size();
+			item.entry.stored_size = item.entry.size;
+
+			if (sources[i].compress && item.entry.size > 0 && item.entry.size <= s_pack_archive_max_compressed_entry_size) {
+				item.compressed.resize(LZ4::compress_bound(item.file.get_size()));
+				const size_t compressed_size = LZ4::compress(item.file.get_data(), item.file.get_size(), item.compressed.data(), item.compressed.size());
+				if (compressed_size != 0 && compressed_size <= item.entry.size - item.entry.size / 8) {
+					item.compressed.resize(compressed_size);
+					item.entry.stored_size = compressed_size;
+					item.entry.compression = static_cast<uint32_t>(EPackCompression::LZ4);
+				}
+				else {
+					item.compressed = {};
+				}
+			}
+		}
+
+		std::sort(pending.begin(), pending.end(), [](const PendingEntry& a, const PendingEntry& b) {
+			return a.entry.path_hash != b.entry.path_hash ? a.entry.path_hash < b.entry.path_hash : a.path < b.path;
+		});
+		for (size_t i = 1; i < pending.size(); ++i) {
+			if (pending[i].path == pending[i - 1].path) {
+				LOG_ERROR("PackArchive: {0} is added twice", pending[i].path);
+				return false;
+			}
+		}
+
+		PackArchiveHeader header{};
+		header.magic = s_pack_archive_magic;
+		header.version = s_pack_archive_version;
+		header.entries_count = static_cast<uint32_t>(pending.size());
+		header.entries_offset = sizeof(PackArchiveHeader);
+		header.paths_offset = header.entries_offset + pending.size() * sizeof(PackArchiveEntry);
+
+		std::string paths;
+		for (PendingEntry& item : pending) {
+			item.entry.path_offset = static_cast<uint32_t>(paths.size());
+			item.entry.path_size = static_cast<uint32_t>(item.path.size());
+			paths += item.path;
+		}
+		header.paths_size = static_cast<uint32_t>(paths.size());
+
+		uint64_t offset = header.paths_offset + paths.size();
+		for (PendingEntry& item : pending) {
+			offset = (offset + s_pack_archive_alignment - 1) / s_pack_archive_alignment * s_pack_archive_alignment;
+			item.entry.offset = offset;
+			offset += item.entry.stored_size;
+		}
+
+		return write_file_atomically(path, [&header, &pending, &paths](std::ostream& file) {
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			for (const PendingEntry& item : pending)
+				file.write(reinterpret_cast<const char*>(&item.entry), sizeof(item.entry));
+			file.write(paths.data(), paths.size());
+
+			const char padding[s_pack_archive_alignment] = {};
+			uint64_t written = header.paths_offset + paths.size();
+			for (const PendingEntry& item : pending) {
+				file.write(padding, item.entry.offset - written);
+				if (item.entry.compression == static_cast<uint32_t>(EPackCompression::LZ4))
+					file.write(reinterpret_cast<const char*>(item.compressed.data()), item.compressed.size());
+				else
+					file.write(reinterpret_cast<const char*>(item.file.get_data()), item.entry.stored_size);
+				written = item.entry.offset + item.entry.stored_size;
+			}
+		});
+	}
+
+	std::string PackArchive::normalize_path(const std::string& path) {
+		// rooted paths and drive letters would replace the mounted directory
+		if (path.empty() || path[0] == '/' || path[0] == '\\' || path.find(':') != std::string::npos)
+			return std::string();
+
+		std::string normalized;
+		normalized.reserve(path.size());
+		size_t begin = 0;
+		while (begin <= path.size()) {
+			size_t end = path.find_first_of("/\\", begin);
+			if (end == std::string::npos)
+				end = path.size();
+			const size_t length = end - begin;
+			if (length == 2 && path[begin] == '.' && path[begin + 1] == '.')
+				return std::string();
+			if (length != 0 && !(length == 1 && path[begin] == '.')) {
+				if (!normalized.empty())
+					normalized += '/';
+				normalized.append(path, begin, length);
+			}
+			begin = end + 1;
+		}
+		return normalized;
+	}
+
+	uint64_t PackArchive::hash_path(const std::string& normalized_path) {
+		return hash_fnv1a(normalized_path.data(), normalized_path.size());
+	}
+
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include "FileData.hpp"
+#include "MappedFile.hpp"
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace SimpleEngine {
+
+	// Packed archive file (.pak): a header, the entries sorted by path hash, the path strings
+	// and the aligned data of every entry, either stored or LZ4 compressed. Little endian.
+	// The whole archive is mapped once, stored entries are returned without copying.
+
+	constexpr uint32_t s_pack_archive_magic = 0x4B415045; // "EPAK"
+	constexpr uint32_t s_pack_archive_version = 1;
+	constexpr size_t s_pack_archive_alignment = 16;
+	// a compressed entry is decompressed into memory, bigger ones are stored
+	constexpr uint64_t s_pack_archive_max_compressed_entry_size = 1ull << 30;
+
+	enum class EPackCompression : uint32_t {
+		None,
+		LZ4
+	};
+
+	struct PackArchiveEntry {
+		uint64_t path_hash;	// FNV-1a of the normalized path
+		uint64_t offset;	// from the start of the archive
+		uint64_t stored_size;
+		uint64_t size;		// after decompression
+		uint32_t path_offset; // into the path strings
+		uint32_t path_size;
+		uint32_t compression; // EPackCompression
+		uint32_t reserved;
+	};
+	static_assert(std::is_trivially_copyable_v<PackArchiveEntry>, "archive entries are read straight from the mapping");
+
+	struct PackArchiveHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t entries_count;
+		uint32_t paths_size;
+		uint64_t entries_offset;
+		uint64_t paths_offset;
+	};
+	static_assert(std::is_trivially_copyable_v<PackArchiveHeader>, "archive header is read straight from the mapping");
+
+	// file added by PackArchive::write
+	struct PackArchiveSource {
+		std::string path;		// inside the archive
+		std::string file_path;	// on disk
+		bool compress = true;	// kept only if it saves at least an eighth
+	};
+
+	class PackArchive {
+	public:
+		bool open(const std::string& path);
+		void close();
+		bool is_open() const { return m_header != nullptr; }
+
+		// nullptr if there is no such path, path must be normalized
+		const PackArchiveEntry* find(const std::string& path) const;
+		// stored entries are views into the archive, compressed ones are decompressed into a new buffer;
+		// invalid if the entry is corrupted
+		FileData read(const PackArchiveEntry& entry) const;
+
+		uint32_t get_entries_count() const { return m_header->entries_count; }
+		const PackArchiveEntry& get_entry(const uint32_t index) const { return m_entries[index]; }
+		std::string get_entry_path(const PackArchiveEntry& entry) const;
+
+		static bool write(const std::string& path, std::vector<PackArchiveSource> sources);
+
+		// '/' separated, without "." segments and repeated separators, so equal paths hash equally;
+		// empty if the path is absolute or has ".." segments, so it can't leave the mounted directory
+		static std::string normalize_path(const std::string& path);
+		static uint64_t hash_path(const std::string& normalized_path);
+
+	private:
+		MappedFile m_file;
+		const PackArchiveHeader* m_header = nullptr;
+		const PackArchiveEntry* m_entries = nullptr;
+		const char* m_paths = nullptr;
+	};
+
+}
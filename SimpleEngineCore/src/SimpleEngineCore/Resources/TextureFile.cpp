@@ -0,0 +1,122 @@
+#include "TextureFile.hpp"
+#include "FileSystem.hpp"
+#include "FileUtils.hpp"
+#include "SimpleEngineCore/Log.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace SimpleEngine {
+
+	namespace {
+
+		bool is_valid_header(const TextureFileHeader& header, const size_t file_size) {
+			if (header.magic != s_texture_file_magic || header.version != s_texture_file_version)
+				return false;
+			if (header.width == 0 || header.height == 0 || header.width > s_texture_max_size || header.height > s_texture_max_size)
+				return false;
+			if (header.format > static_cast<uint32_t>(ETextureFormat::RGBA16F))
+				return false;
+			if (header.mip_levels == 0 || header.mip_levels > s_texture_max_mip_levels
+				|| header.mip_levels > calculate_mip_levels(header.width, header.height)) {
+				return false;
+			}
+
+			const size_t pixel_size = texture_format_pixel_size(static_cast<ETextureFormat>(header.format));
+			for (uint32_t i = 0; i < header.mip_levels; ++i) {
+				const TextureFileMipLevel& level = header.levels[i];
+				const uint32_t width = std::max(header.width >> i, 1u);
+				const uint32_t height = std::max(header.height >> i, 1u);
+				if (level.width != width || level.height != height || level.size != static_cast<uint64_t>(width) * height * pixel_size)
+					return false;
+				if (level.offset < sizeof(TextureFileHeader) || level.offset % s_texture_file_alignment != 0
+					|| !is_within_file(level.offset, level.size, file_size)) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+	}
+
+	bool TextureFile::open(const std::string& path) {
+		MappedFile file;
+		if (!file.open(path))
+			return false;
+		return open(FileData(std::move(file)), path);
+	}
+
+	bool TextureFile::open(const FileSystem& file_system, const std::string& path) {
+		FileData file = file_system.read(path);
+		if (!file.is_valid()) {
+			LOG_ERROR("TextureFile: {0} is not found", path);
+			return false;
+		}
+		return open(std::move(file), path);
+	}
+
+	bool TextureFile::open(FileData file, const std::string& path) {
+		close();
+		m_file = std::move(file);
+
+		const TextureFileHeader* header = reinterpret_cast<const TextureFileHeader*>(m_file.get_data());
+		if (m_file.get_size() < sizeof(TextureFileHeader) || !is_valid_header(*header, m_file.get_size())) {
+			LOG_ERROR("TextureFile: {0} is not a valid texture file of version {1}", path, s_texture_file_version);
+			m_file = FileData();
+			return false;
+		}
+		m_header = header;
+		return true;
+	}
+
+	void TextureFile::close() {
+		m_header = nullptr;
+		m_file = FileData();
+	}
+
+	bool TextureFile::write(const std::string& path, const TextureData& texture) {
+		if (texture.levels.empty() || texture.levels.size() > s_texture_max_mip_levels) {
+			LOG_ERROR("TextureFile: texture written to {0} has {1} mip levels", path, texture.levels.size());
+			return false;
+		}
+		if (texture.width == 0 || texture.height == 0 || texture.width > s_texture_max_size || texture.height > s_texture_max_size) {
+			LOG_ERROR("TextureFile: texture written to {0} is {1}x{2}, at most {3}x{3} is supported", path, texture.width, texture.height, s_texture_max_size);
+			return false;
+		}
+
+		TextureFileHeader header{};
+		header.magic = s_texture_file_magic;
+		header.version = s_texture_file_version;
+		header.width = texture.width;
+		header.height = texture.height;
+		header.format = static_cast<uint32_t>(texture.format);
+		header.mip_levels = static_cast<uint32_t>(texture.levels.size());
+
+		const size_t pixel_size = texture_format_pixel_size(texture.format);
+		uint64_t offset = sizeof(TextureFileHeader);
+		for (uint32_t i = 0; i < header.mip_levels; ++i) {
+			TextureFileMipLevel& level = header.levels[i];
+			level.width = std::max(texture.width >> i, 1u);
+			level.height = std::max(texture.height >> i, 1u);
+			level.size = static_cast<uint64_t>(level.width) * level.height * pixel_size;
+			if (texture.levels[i].size() != level.size) {
+				LOG_ERROR("TextureFile: mip level {0} of {1} has {2} bytes instead of {3}", i, path, texture.levels[i].size(), level.size);
+				return false;
+			}
+			level.offset = (offset + s_texture_file_alignment - 1) / s_texture_file_alignment * s_texture_file_alignment;
+			offset = level.offset + level.size;
+		}
+
+		return write_file_atomically(path, [&header, &texture](std::ostream& file) {
+			const char padding[s_texture_file_alignment] = {};
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			uint64_t written = sizeof(header);
+			for (uint32_t i = 0; i < header.mip_levels; ++i) {
+				file.write(padding, header.levels[i].offset - written);
+				file.write(reinterpret_cast<const char*>(texture.levels[i].data()), texture.levels[i].size());
+				written = header.levels[i].offset + header.levels[i].size;
+			}
+		});
+	}
+
+}
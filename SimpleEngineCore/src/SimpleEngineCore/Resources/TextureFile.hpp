@@ -0,0 +1,72 @@
+#pragma once
+#include "FileData.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/Texture2D.hpp"
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace SimpleEngine {
+
+	class FileSystem;
+
+	// Cooked texture file (.tex): a header followed by the tightly packed pixels of every mip level,
+	// largest first, each level aligned so it can be copied into staging memory as it is. Little endian.
+
+	constexpr uint32_t s_texture_file_magic = 0x58455445; // "ETEX"
+	constexpr uint32_t s_texture_file_version = 1;
+	constexpr size_t s_texture_file_alignment = 16;
+	constexpr size_t s_texture_max_mip_levels = 16;
+	// like GL_MAX_TEXTURE_SIZE of current hardware; also keeps the level size computations far from overflowing
+	constexpr uint32_t s_texture_max_size = 16384;
+
+	struct TextureFileMipLevel {
+		uint64_t offset; // from the start of the file
+		uint64_t size;
+		uint32_t width;
+		uint32_t height;
+	};
+
+	struct TextureFileHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t width;
+		uint32_t height;
+		uint32_t format; // ETextureFormat
+		uint32_t mip_levels;
+		TextureFileMipLevel levels[s_texture_max_mip_levels];
+	};
+	static_assert(std::is_trivially_copyable_v<TextureFileHeader>, "texture file header is read straight from the mapping");
+
+	struct TextureData {
+		unsigned int width = 0;
+		unsigned int height = 0;
+		ETextureFormat format = ETextureFormat::RGBA8;
+		std::vector<std::vector<unsigned char>> levels; // largest first
+	};
+
+	class TextureFile {
+	public:
+		bool open(const std::string& path);
+		bool open(const FileSystem& file_system, const std::string& path);
+		void close();
+		bool is_open() const { return m_header != nullptr; }
+
+		const TextureFileHeader& get_header() const { return *m_header; }
+		unsigned int get_width() const { return m_header->width; }
+		unsigned int get_height() const { return m_header->height; }
+		ETextureFormat get_format() const { return static_cast<ETextureFormat>(m_header->format); }
+		unsigned int get_mip_levels() const { return m_header->mip_levels; }
+		const void* get_level_data(const unsigned int level) const { return m_file.get_data() + m_header->levels[level].offset; }
+
+		static bool write(const std::string& path, const TextureData& texture);
+
+	private:
+		bool open(FileData file, const std::string& path);
+
+		FileData m_file;
+		const TextureFileHeader* m_header = nullptr;
+	};
+
+}
@@ -0,0 +1,140 @@
+#include "Archetype.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace SimpleEngine {
+
+	namespace {
+
+		// chunks start on a cache line, so do the columns of components that ask for it
+		constexpr size_t s_archetype_chunk_alignment = 64;
+
+		size_t align_archetype_offset(const size_t offset, const size_t alignment) {
+			return (offset + alignment - 1) / alignment * alignment;
+		}
+
+	}
+
+	Archetype::Archetype(const ComponentMask mask)
+		: m_mask(mask) {
+		for (ComponentId id = 0; id < s_max_component_types; ++id) {
+			if (mask & component_bit(id))
+				m_components.push_back(id);
+		}
+
+		size_t row_size = sizeof(Entity);
+		for (const ComponentId id : m_components)
+			row_size += ComponentRegistry::get_info(id).size;
+
+		// the padding between the columns can push the estimate past the chunk, it shrinks until it fits
+		const auto layout_size = [this](const size_t capacity) {
+			size_t offset = capacity * sizeof(Entity);
+			for (const ComponentId id : m_components) {
+				const ComponentInfo& info = ComponentRegistry::get_info(id);
+				offset = align_archetype_offset(offset, info.alignment);
+				m_columns[id] = { static_cast<uint32_t>(offset), static_cast<uint32_t>(info.size) };
+				offset += capacity * info.size;
+			}
+			return offset;
+		};
+		size_t capacity = std::max<size_t>(1, s_chunk_size / row_size);
+		while (capacity > 1 && layout_size(capacity) > s_chunk_size)
+			--capacity;
+		m_chunk_capacity = static_cast<uint32_t>(capacity);
+		// a single huge entity gets a chunk as big as it needs
+		m_chunk_bytes = std::max(s_chunk_size, align_archetype_offset(layout_size(capacity), s_archetype_chunk_alignment));
+	}
+
+	Archetype::~Archetype() {
+		for (ArchetypeChunk& chunk : m_chunks) {
+			for (const ComponentId id : m_components) {
+				const ComponentInfo& info = ComponentRegistry::get_info(id);
+				if (!info.destroy)
+					continue;
+				unsigned char* column = static_cast<unsigned char*>(get_column(chunk, id));
+				for (uint32_t i = 0; i < chunk.count; ++i)
+					info.destroy(column + i * info.size);
+			}
+			::operator delete(chunk.data, std::align_val_t(s_archetype_chunk_alignment));
+		}
+	}
+
+	Entity Archetype::get_entity(const uint32_t row) const {
+		const ArchetypeChunk& chunk = m_chunks[row / m_chunk_capacity];
+		return get_entities(chunk)[row % m_chunk_capacity];
+	}
+
+	void* Archetype::get_component(const uint32_t row, const ComponentId id) {
+		const ArchetypeChunk& chunk = m_chunks[row / m_chunk_capacity];
+		return chunk.data + m_columns[id].offset + static_cast<size_t>(row % m_chunk_capacity) * m_columns[id].size;
+	}
+
+	uint32_t Archetype::allocate_row(const Entity entity) {
+		if (m_chunks.empty() || m_chunks.back().count == m_chunk_capacity) {
+			void* data = ::operator new(m_chunk_bytes, std::align_val_t(s_archetype_chunk_alignment));
+			m_chunks.push_back({ static_cast<unsigned char*>(data), 0 });
+		}
+		ArchetypeChunk& chunk = m_chunks.back();
+		reinterpret_cast<Entity*>(chunk.data)[chunk.count] = entity;
+		++chunk.count;
+		return static_cast<uint32_t>(m_entities_count++);
+	}
+
+	Entity Archetype::remove_row(const uint32_t row) {
+		for (const ComponentId id : m_components) {
+			const ComponentInfo& info = ComponentRegistry::get_info(id);
+			if (info.destroy)
+				info.destroy(get_component(row, id));
+		}
+		return fill_row(row);
+	}
+
+	Entity Archetype::move_row(const uint32_t row, Archetype& destination, const uint32_t destination_row) {
+		for (const ComponentId id : m_components) {
+			const ComponentInfo& info = ComponentRegistry::get_info(id);
+			void* source = get_component(row, id);
+			if (destination.has(id)) {
+				void* target = destination.get_component(destination_row, id);
+				if (info.move_construct)
+					info.move_construct(target, source);
+				else
+					std::memcpy(target, source, info.size);
+			}
+			if (info.destroy)
+				info.destroy(source);
+		}
+		return fill_row(row);
+	}
+
+	Entity Archetype::fill_row(const uint32_t row) {
+		const uint32_t last_row = static_cast<uint32_t>(m_entities_count - 1);
+		Entity moved_entity;
+		if (row != last_row) {
+			for (const ComponentId id : m_components) {
+				const ComponentInfo& info = ComponentRegistry::get_info(id);
+				void* target = get_component(row, id);
+				void* source = get_component(last_row, id);
+				if (info.move_construct)
+					info.move_construct(target, source);
+				else
+					std::memcpy(target, source, info.size);
+				if (info.destroy)
+					info.destroy(source);
+			}
+			moved_entity = get_entity(last_row);
+			ArchetypeChunk& chunk = m_chunks[row / m_chunk_capacity];
+			reinterpret_cast<Entity*>(chunk.data)[row % m_chunk_capacity] = moved_entity;
+		}
+
+		--m_entities_count;
+		ArchetypeChunk& last_chunk = m_chunks.back();
+		if (--last_chunk.count == 0) {
+			::operator delete(last_chunk.data, std::align_val_t(s_archetype_chunk_alignment));
+			m_chunks.pop_back();
+		}
+		return moved_entity;
+	}
+
+}
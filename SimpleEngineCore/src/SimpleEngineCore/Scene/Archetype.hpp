@@ -0,0 +1,84 @@
+#pragma once
+#include "Component.hpp"
+#include "Entity.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace SimpleEngine {
+
+	// s_chunk_size bytes: the entities of the rows followed by one array per component
+	struct ArchetypeChunk {
+		unsigned char* data;
+		uint32_t count;
+	};
+
+	// Storage of the entities that have exactly the same set of components, as structure of arrays in chunks.
+	// Rows are packed: every chunk but the last is full and removing a row moves the last one into its place.
+	// A row is the index of an entity within the archetype, so row / capacity is its chunk.
+	class Archetype {
+	public:
+		static constexpr size_t s_chunk_size = 16 * 1024;
+
+		explicit Archetype(const ComponentMask mask);
+		~Archetype();
+
+		Archetype(const Archetype&) = delete;
+		Archetype& operator=(const Archetype&) = delete;
+
+		ComponentMask get_mask() const { return m_mask; }
+		// ascending
+		const std::vector<ComponentId>& get_components() const { return m_components; }
+		bool has(const ComponentId id) const { return (m_mask & component_bit(id)) != 0; }
+
+		uint32_t get_chunk_capacity() const { return m_chunk_capacity; }
+		size_t get_chunks_count() const { return m_chunks.size(); }
+		const ArchetypeChunk& get_chunk(const size_t index) const { return m_chunks[index]; }
+		size_t get_entities_count() const { return m_entities_count; }
+
+		const Entity* get_entities(const ArchetypeChunk& chunk) const { return reinterpret_cast<const Entity*>(chunk.data); }
+		// the array of a component in a chunk, the archetype must have it
+		void* get_column(const ArchetypeChunk& chunk, const ComponentId id) const { return chunk.data + m_columns[id].offset; }
+
+		Entity get_entity(const uint32_t row) const;
+		void* get_component(const uint32_t row, const ComponentId id);
+
+		// a new last row, its components are left for the caller to construct
+		uint32_t allocate_row(const Entity entity);
+		// destroys the components of the row; returns the entity moved into it, invalid if it was the last one
+		Entity remove_row(const uint32_t row);
+		// moves the components both archetypes have to destination_row of destination and destroys the rest,
+		// then removes the row like remove_row does
+		Entity move_row(const uint32_t row, Archetype& destination, const uint32_t destination_row);
+
+		// cached archetypes of this one with a component added or removed, nullptr until first needed
+		Archetype* get_add_edge(const ComponentId id) const { return m_add_edges[id]; }
+		Archetype* get_remove_edge(const ComponentId id) const { return m_remove_edges[id]; }
+		void set_add_edge(const ComponentId id, Archetype* archetype) { m_add_edges[id] = archetype; }
+		void set_remove_edge(const ComponentId id, Archetype* archetype) { m_remove_edges[id] = archetype; }
+
+	private:
+		struct Column {
+			uint32_t offset;
+			uint32_t size;
+		};
+
+		// moves the last row into the hole left at row, whose components are already gone
+		Entity fill_row(const uint32_t row);
+
+		ComponentMask m_mask;
+		std::vector<ComponentId> m_components;
+		std::array<Column, s_max_component_types> m_columns{};
+		uint32_t m_chunk_capacity = 0;
+		size_t m_chunk_bytes = s_chunk_size;
+
+		std::vector<ArchetypeChunk> m_chunks;
+		size_t m_entities_count = 0;
+
+		std::array<Archetype*, s_max_component_types> m_add_edges{};
+		std::array<Archetype*, s_max_component_types> m_remove_edges{};
+	};
+
+}
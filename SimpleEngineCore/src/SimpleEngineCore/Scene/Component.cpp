@@ -0,0 +1,39 @@
+#include "Component.hpp"
+#include "SimpleEngineCore/Log.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+
+namespace SimpleEngine {
+
+	namespace {
+
+		// fixed storage: ids are read without locking while other threads may still register types
+		ComponentInfo s_component_infos[s_max_component_types];
+		std::atomic<ComponentId> s_component_types_count{ 0 };
+		std::mutex s_component_registry_mutex;
+
+	}
+
+	const ComponentInfo& ComponentRegistry::get_info(const ComponentId id) {
+		return s_component_infos[id];
+	}
+
+	ComponentId ComponentRegistry::get_types_count() {
+		return s_component_types_count.load(std::memory_order_acquire);
+	}
+
+	ComponentId ComponentRegistry::register_component(const ComponentInfo& info) {
+		std::lock_guard<std::mutex> lock(s_component_registry_mutex);
+		const ComponentId id = s_component_types_count.load(std::memory_order_relaxed);
+		if (id == s_max_component_types) {
+			LOG_CRITICAL("ComponentRegistry: more than {0} component types", s_max_component_types);
+			std::abort();
+		}
+		s_component_infos[id] = info;
+		s_component_types_count.store(id + 1, std::memory_order_release);
+		return id;
+	}
+
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace SimpleEngine {
+
+	using ComponentId = uint32_t;
+	// one bit per component type
+	using ComponentMask = uint64_t;
+
+	constexpr ComponentId s_max_component_types = 64;
+
+	inline ComponentMask component_bit(const ComponentId id) {
+		return id < s_max_component_types ? ComponentMask(1) << id : 0;
+	}
+
+	inline uint32_t count_components(ComponentMask mask) {
+		uint32_t count = 0;
+		for (; mask != 0; mask &= mask - 1)
+			++count;
+		return count;
+	}
+
+	// What the chunks need to relocate and destroy a component without knowing its type.
+	// nullptr functions mean memcpy and nothing, the common case of plain data components
+	struct ComponentInfo {
+		size_t size;
+		size_t alignment;
+		void (*move_construct)(void* destination, void* source);
+		void (*destroy)(void* component);
+	};
+
+	// Ids are handed out on the first use of a type, at most s_max_component_types of them: one more terminates,
+	// as every mask, column table and archetype edge is sized for that many.
+	// Components must be move constructible; const-qualified types share the id of the plain one
+	class ComponentRegistry {
+	public:
+		template<typename T>
+		static ComponentId get_id() {
+			return get_type_id<std::remove_cv_t<T>>();
+		}
+
+		template<typename... Components>
+		static ComponentMask get_mask() {
+			return (component_bit(get_id<Components>()) | ... | ComponentMask(0));
+		}
+
+		static const ComponentInfo& get_info(const ComponentId id);
+		static ComponentId get_types_count();
+
+	private:
+		template<typename Component>
+		static ComponentId get_type_id() {
+			static const ComponentId id = register_component(make_info<Component>());
+			return id;
+		}
+
+		template<typename Component>
+		static ComponentInfo make_info() {
+			static_assert(std::is_move_constructible_v<Component>, "components must be move constructible");
+			ComponentInfo info{ sizeof(Component), alignof(Component), nullptr, nullptr };
+			if constexpr (!std::is_trivially_copyable_v<Component>) {
+				info.move_construct = [](void* destination, void* source) {
+					new (destination) Component(std::move(*static_cast<Component*>(source)));
+				};
+			}
+			if constexpr (!std::is_trivially_destructible_v<Component>) {
+				info.destroy = [](void* component) {
+					static_cast<Component*>(component)->~Component();
+				};
+			}
+			return info;
+		}
+
+		static ComponentId register_component(const ComponentInfo& info);
+	};
+
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <cstdint>
+
+namespace SimpleEngine {
+
+	// Handle of an entity of a World. The generation tells a destroyed entity from the one reusing its index
+	struct Entity {
+		static constexpr uint32_t s_invalid_index = UINT32_MAX;
+
+		uint32_t index = s_invalid_index;
+		uint32_t generation = 0;
+
+		bool is_valid() const { return index != s_invalid_index; }
+
+		bool operator==(const Entity& other) const { return index == other.index && generation == other.generation; }
+		bool operator!=(const Entity& other) const { return !(*this == other); }
+	};
+
+}
@@ -0,0 +1,29 @@
+#include "EntityCommandBuffer.hpp"
+
+namespace SimpleEngine {
+
+	EntityCommandBuffer::EntityCommandBuffer()
+		: m_thread_commands(JobSystem::get_threads_count()) {
+	}
+
+	void EntityCommandBuffer::destroy(const Entity entity) {
+		record([entity](World& world) { world.destroy(entity); });
+	}
+
+	void EntityCommandBuffer::playback(World& world) {
+		m_shared_commands.execute(world);
+		m_shared_commands.clear();
+		for (ThreadCommands& thread : m_thread_commands) {
+			thread.commands.execute(world);
+			thread.commands.clear();
+		}
+	}
+
+	size_t EntityCommandBuffer::get_commands_count() const {
+		size_t count = m_shared_commands.get_commands_count();
+		for (const ThreadCommands& thread : m_thread_commands)
+			count += thread.commands.get_commands_count();
+		return count;
+	}
+
+}
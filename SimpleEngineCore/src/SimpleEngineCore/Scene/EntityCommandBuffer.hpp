@@ -0,0 +1,84 @@
+#pragma once
+#include "Entity.hpp"
+#include "World.hpp"
+#include "SimpleEngineCore/Jobs/CommandBuffer.hpp"
+#include "SimpleEngineCore/Jobs/JobSystem.hpp"
+
+#include <mutex>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace SimpleEngine {
+
+	// Structural changes recorded while a query is iterated and applied afterwards by playback.
+	// Every thread of the JobSystem records into commands of its own, so the jobs of a parallel_each share one buffer
+	// without locking; other threads (all of them until the JobSystem is initialized) share locked commands.
+	// Playback keeps the recorded order of each thread. Components are moved into the commands, which are placed in
+	// reused chunks and don't allocate. Commands on entities destroyed in the meantime are skipped
+	class EntityCommandBuffer {
+	public:
+		EntityCommandBuffer();
+
+		EntityCommandBuffer(const EntityCommandBuffer&) = delete;
+		EntityCommandBuffer& operator=(const EntityCommandBuffer&) = delete;
+
+		template<typename... Components>
+		void create(Components&&... components) {
+			record([components = std::make_tuple(std::decay_t<Components>(std::forward<Components>(components))...)](World& world) mutable {
+				std::apply([&world](auto&... values) { world.create(std::move(values)...); }, components);
+			});
+		}
+
+		void destroy(const Entity entity);
+
+		template<typename T>
+		void add(const Entity entity, T component) {
+			record([entity, component = std::move(component)](World& world) mutable {
+				if (world.is_alive(entity))
+					world.add<T>(entity, std::move(component));
+			});
+		}
+
+		template<typename T>
+		void remove(const Entity entity) {
+			record([entity](World& world) {
+				if (world.is_alive(entity))
+					world.remove<T>(entity);
+			});
+		}
+
+		// not while iterating a query of the world or recording; leaves the buffer empty
+		void playback(World& world);
+
+		// not while recording
+		size_t get_commands_count() const;
+		bool is_empty() const { return get_commands_count() == 0; }
+
+	private:
+		using Commands = CommandBuffer<World&>;
+
+		// a cache line each, the threads record side by side
+		struct alignas(64) ThreadCommands {
+			Commands commands;
+		};
+
+		template<typename F>
+		void record(F&& command) {
+			const int thread_index = JobSystem::get_thread_index();
+			if (thread_index >= 0 && static_cast<size_t>(thread_index) < m_thread_commands.size()) {
+				m_thread_commands[thread_index].commands.push(std::forward<F>(command));
+				return;
+			}
+			std::lock_guard<std::mutex> lock(m_shared_mutex);
+			m_shared_commands.push(std::forward<F>(command));
+		}
+
+		// sized when constructed, threads of a JobSystem initialized later use the shared commands
+		std::vector<ThreadCommands> m_thread_commands;
+		std::mutex m_shared_mutex;
+		Commands m_shared_commands;
+	};
+
+}
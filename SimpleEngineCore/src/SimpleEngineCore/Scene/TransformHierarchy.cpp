@@ -0,0 +1,327 @@
+#include "TransformHierarchy.hpp"
+#include "SimpleEngineCore/Jobs/JobSystem.hpp"
+#include "SimpleEngineCore/Math/MathKernels.hpp"
+#include "SimpleEngineCore/Math/SIMD.hpp"
+#include "SimpleEngineCore/Log.hpp"
+
+#include <algorithm>
+#include <type_traits>
+
+namespace SimpleEngine {
+
+	namespace {
+
+		// parent * local for a local matrix without projection (last row 0, 0, 0, 1): 9 multiply-adds per column
+		void multiply_transform_matrices(const glm::mat4& parent, const glm::mat4& local, glm::mat4& result) {
+			const Float4 parent_x = Float4::load(&parent[0][0]);
+			const Float4 parent_y = Float4::load(&parent[1][0]);
+			const Float4 parent_z = Float4::load(&parent[2][0]);
+			const Float4 parent_w = Float4::load(&parent[3][0]);
+			for (int column = 0; column < 3; ++column) {
+				const Float4 value = parent_x * Float4(local[column][0]) + parent_y * Float4(local[column][1]) + parent_z * Float4(local[column][2]);
+				value.store(&result[column][0]);
+			}
+			const Float4 translation = parent_x * Float4(local[3][0]) + parent_y * Float4(local[3][1]) + parent_z * Float4(local[3][2]) + parent_w;
+			translation.store(&result[3][0]);
+		}
+
+	}
+
+	TransformId TransformHierarchy::create(const TransformId parent, const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale) {
+		if (parent != s_invalid_id && !is_valid(parent)) {
+			LOG_ERROR("TransformHierarchy: parent {0} does not exist", parent);
+			return s_invalid_id;
+		}
+
+		TransformId id;
+		if (!m_free_ids.empty()) {
+			id = m_free_ids.back();
+			m_free_ids.pop_back();
+		}
+		else {
+			id = static_cast<TransformId>(m_indices.size());
+			m_indices.push_back(s_invalid_id);
+		}
+
+		// appended after its parent, so the order stays topological
+		const uint32_t index = static_cast<uint32_t>(m_ids.size());
+		m_ids.push_back(id);
+		m_indices[id] = index;
+		m_parents.push_back(parent != s_invalid_id ? m_indices[parent] : s_invalid_id);
+		m_local_matrices.emplace_back(1.f);
+		m_world_matrices.emplace_back(1.f);
+		m_dirty.push_back(1);
+		resize_soa(m_ids.size());
+
+		m_translation_x[index] = translation.x;
+		m_translation_y[index] = translation.y;
+		m_translation_z[index] = translation.z;
+		m_rotation_x[index] = rotation.x;
+		m_rotation_y[index] = rotation.y;
+		m_rotation_z[index] = rotation.z;
+		m_rotation_w[index] = rotation.w;
+		m_scale_x[index] = scale.x;
+		m_scale_y[index] = scale.y;
+		m_scale_z[index] = scale.z;
+		mark_dirty(index);
+		return id;
+	}
+
+	void TransformHierarchy::destroy(const TransformId id) {
+		if (!is_valid(id))
+			return;
+
+		// descendants come after the node, so one pass finds the whole subtree
+		const uint32_t first = m_indices[id];
+		std::vector<uint8_t> removed(m_ids.size(), 0);
+		removed[first] = 1;
+		for (size_t i = first + 1; i < m_ids.size(); ++i) {
+			if (m_parents[i] != s_invalid_id && removed[m_parents[i]])
+				removed[i] = 1;
+		}
+
+		std::vector<uint32_t> order;
+		order.reserve(m_ids.size());
+		for (uint32_t i = 0; i < m_ids.size(); ++i) {
+			if (removed[i]) {
+				m_indices[m_ids[i]] = s_invalid_id;
+				m_free_ids.push_back(m_ids[i]);
+			}
+			else {
+				order.push_back(i);
+			}
+		}
+		reorder(order);
+	}
+
+	bool TransformHierarchy::is_valid(const TransformId id) const {
+		return id < m_indices.size() && m_indices[id] != s_invalid_id;
+	}
+
+	bool TransformHierarchy::set_parent(const TransformId id, const TransformId parent) {
+		if (!is_valid(id) || (parent != s_invalid_id && !is_valid(parent)))
+			return false;
+
+		const uint32_t index = m_indices[id];
+		const uint32_t parent_index = parent != s_invalid_id ? m_indices[parent] : s_invalid_id;
+		for (uint32_t ancestor = parent_index; ancestor != s_invalid_id; ancestor = m_parents[ancestor]) {
+			if (ancestor == index) {
+				LOG_ERROR("TransformHierarchy: {0} can't become a child of its descendant {1}", id, parent);
+				return false;
+			}
+		}
+		if (m_parents[index] == parent_index)
+			return true;
+
+		m_parents[index] = parent_index;
+		if (parent_index == s_invalid_id || parent_index < index) {
+			mark_dirty(index);
+			return true;
+		}
+
+		// the new parent comes after the node: depth-first order puts every parent before its subtree again
+		std::vector<std::vector<uint32_t>> children(m_ids.size());
+		std::vector<uint32_t> stack;
+		for (uint32_t i = 0; i < m_ids.size(); ++i) {
+			if (m_parents[i] == s_invalid_id)
+				stack.push_back(i);
+			else
+				children[m_parents[i]].push_back(i);
+		}
+		std::reverse(stack.begin(), stack.end());
+
+		std::vector<uint32_t> order;
+		order.reserve(m_ids.size());
+		while (!stack.empty()) {
+			const uint32_t i = stack.back();
+			stack.pop_back();
+			order.push_back(i);
+			stack.insert(stack.end(), children[i].rbegin(), children[i].rend());
+		}
+		reorder(order);
+		return true;
+	}
+
+	TransformId TransformHierarchy::get_parent(const TransformId id) const {
+		const uint32_t parent_index = m_parents[m_indices[id]];
+		return parent_index != s_invalid_id ? m_ids[parent_index] : s_invalid_id;
+	}
+
+	void TransformHierarchy::set_translation(const TransformId id, const glm::vec3& translation) {
+		const uint32_t index = m_indices[id];
+		if (m_translation_x[index] == translation.x && m_translation_y[index] == translation.y && m_translation_z[index] == translation.z)
+			return;
+		m_translation_x[index] = translation.x;
+		m_translation_y[index] = translation.y;
+		m_translation_z[index] = translation.z;
+		mark_dirty(index);
+	}
+
+	void TransformHierarchy::set_rotation(const TransformId id, const glm::quat& rotation) {
+		const uint32_t index = m_indices[id];
+		if (m_rotation_x[index] == rotation.x && m_rotation_y[index] == rotation.y && m_rotation_z[index] == rotation.z && m_rotation_w[index] == rotation.w)
+			return;
+		m_rotation_x[index] = rotation.x;
+		m_rotation_y[index] = rotation.y;
+		m_rotation_z[index] = rotation.z;
+		m_rotation_w[index] = rotation.w;
+		mark_dirty(index);
+	}
+
+	void TransformHierarchy::set_scale(const TransformId id, const glm::vec3& scale) {
+		const uint32_t index = m_indices[id];
+		if (m_scale_x[index] == scale.x && m_scale_y[index] == scale.y && m_scale_z[index] == scale.z)
+			return;
+		m_scale_x[index] = scale.x;
+		m_scale_y[index] = scale.y;
+		m_scale_z[index] = scale.z;
+		mark_dirty(index);
+	}
+
+	glm::vec3 TransformHierarchy::get_translation(const TransformId id) const {
+		const uint32_t index = m_indices[id];
+		return glm::vec3(m_translation_x[index], m_translation_y[index], m_translation_z[index]);
+	}
+
+	glm::quat TransformHierarchy::get_rotation(const TransformId id) const {
+		const uint32_t index = m_indices[id];
+		glm::quat rotation;
+		rotation.x = m_rotation_x[index];
+		rotation.y = m_rotation_y[index];
+		rotation.z = m_rotation_z[index];
+		rotation.w = m_rotation_w[index];
+		return rotation;
+	}
+
+	glm::vec3 TransformHierarchy::get_scale(const TransformId id) const {
+		const uint32_t index = m_indices[id];
+		return glm::vec3(m_scale_x[index], m_scale_y[index], m_scale_z[index]);
+	}
+
+	void TransformHierarchy::update() {
+		const size_t count = m_ids.size();
+		const size_t blocks_count = m_dirty_blocks.size();
+		if (count >= s_min_nodes_per_job) {
+			JobSystem::parallel_for(blocks_count, s_min_nodes_per_job / 4, [this](const size_t first, const size_t last) {
+				compose_local_matrices(first, last);
+			});
+		}
+		else {
+			compose_local_matrices(0, blocks_count);
+		}
+
+		// a parent is final before its children are reached, so a dirty parent dirties the whole subtree
+		size_t first_changed = count;
+		size_t last_changed = 0;
+		for (size_t i = 0; i < count; ++i) {
+			const uint32_t parent = m_parents[i];
+			if (parent != s_invalid_id && m_dirty[parent])
+				m_dirty[i] = 1;
+			if (!m_dirty[i])
+				continue;
+
+			if (parent == s_invalid_id)
+				m_world_matrices[i] = m_local_matrices[i];
+			else
+				multiply_transform_matrices(m_world_matrices[parent], m_local_matrices[i], m_world_matrices[i]);
+			first_changed = std::min(first_changed, i);
+			last_changed = i + 1;
+		}
+
+		if (first_changed < last_changed) {
+			std::fill(m_dirty.begin() + first_changed, m_dirty.begin() + last_changed, 0);
+			m_changed_first = first_changed;
+			m_changed_count = last_changed - first_changed;
+		}
+		else {
+			m_changed_first = 0;
+			m_changed_count = 0;
+		}
+	}
+
+	void TransformHierarchy::reorder(const std::vector<uint32_t>& order) {
+		std::vector<uint32_t> new_indices(m_ids.size(), s_invalid_id);
+		for (uint32_t i = 0; i < order.size(); ++i)
+			new_indices[order[i]] = i;
+
+		const auto gather = [&order](auto& values) {
+			std::remove_reference_t<decltype(values)> reordered;
+			reordered.reserve(values.size());
+			for (const uint32_t old_index : order)
+				reordered.push_back(values[old_index]);
+			values.swap(reordered);
+		};
+		gather(m_translation_x);
+		gather(m_translation_y);
+		gather(m_translation_z);
+		gather(m_rotation_x);
+		gather(m_rotation_y);
+		gather(m_rotation_z);
+		gather(m_rotation_w);
+		gather(m_scale_x);
+		gather(m_scale_y);
+		gather(m_scale_z);
+		gather(m_local_matrices);
+		gather(m_world_matrices);
+		gather(m_ids);
+		gather(m_parents);
+		for (uint32_t& parent : m_parents) {
+			if (parent != s_invalid_id)
+				parent = new_indices[parent];
+		}
+		for (uint32_t i = 0; i < m_ids.size(); ++i)
+			m_indices[m_ids[i]] = i;
+
+		// the indices moved, so every world matrix is recomposed and reported as changed
+		m_dirty.assign(m_ids.size(), 1);
+		resize_soa(m_ids.size());
+		std::fill(m_dirty_blocks.begin(), m_dirty_blocks.end(), 1);
+	}
+
+	void TransformHierarchy::resize_soa(const size_t count) {
+		const size_t padded_count = (count + 3) / 4 * 4;
+		// the padding is identity, so whole blocks are composed without checks
+		m_translation_x.resize(padded_count, 0.f);
+		m_translation_y.resize(padded_count, 0.f);
+		m_translation_z.resize(padded_count, 0.f);
+		m_rotation_x.resize(padded_count, 0.f);
+		m_rotation_y.resize(padded_count, 0.f);
+		m_rotation_z.resize(padded_count, 0.f);
+		m_rotation_w.resize(padded_count, 1.f);
+		m_scale_x.resize(padded_count, 1.f);
+		m_scale_y.resize(padded_count, 1.f);
+		m_scale_z.resize(padded_count, 1.f);
+		m_dirty_blocks.resize(padded_count / 4, 0);
+	}
+
+	void TransformHierarchy::mark_dirty(const uint32_t index) {
+		m_dirty[index] = 1;
+		m_dirty_blocks[index / 4] = 1;
+	}
+
+	void TransformHierarchy::compose_local_matrices(const size_t first_block, const size_t last_block) {
+		const size_t count = m_ids.size();
+
+		// runs of dirty blocks are composed with one call, so the wider kernels get full lanes
+		size_t block = first_block;
+		while (block < last_block) {
+			if (!m_dirty_blocks[block]) {
+				++block;
+				continue;
+			}
+			const size_t first_dirty_block = block;
+			for (; block < last_block && m_dirty_blocks[block]; ++block)
+				m_dirty_blocks[block] = 0;
+
+			const size_t first = first_dirty_block * 4;
+			const size_t last = std::min(count, block * 4);
+			const TransformArrays run{
+				&m_translation_x[first], &m_translation_y[first], &m_translation_z[first],
+				&m_rotation_x[first], &m_rotation_y[first], &m_rotation_z[first], &m_rotation_w[first],
+				&m_scale_x[first], &m_scale_y[first], &m_scale_z[first],
+			};
+			MathKernels::compose_transforms(run, &m_local_matrices[first], last - first);
+		}
+	}
+
+}
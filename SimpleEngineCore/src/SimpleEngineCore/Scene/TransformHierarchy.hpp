@@ -0,0 +1,96 @@
+#pragma once
+#include "glm/vec3.hpp"
+#include "glm/mat4x4.hpp"
+#include "glm/gtc/quaternion.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace SimpleEngine {
+
+	using TransformId = uint32_t;
+
+	// Local translation, rotation and scale of every node as structure of arrays, kept in topological order
+	// (parents before children) so that world matrices are composed in one linear pass.
+	// Only the nodes whose local transform changed and their subtrees are recomposed in update(),
+	// several local matrices at a time with the MathKernels. World matrices are column-major glm::mat4 in node order,
+	// ready to be copied into a shader storage or instance buffer.
+	// Ids are stable, the position of a node (get_index) changes when the hierarchy is restructured.
+	class TransformHierarchy {
+	public:
+		static constexpr TransformId s_invalid_id = UINT32_MAX;
+		static constexpr size_t s_min_nodes_per_job = 4 * 1024;
+
+		TransformHierarchy() = default;
+		TransformHierarchy(const TransformHierarchy&) = delete;
+		TransformHierarchy& operator=(const TransformHierarchy&) = delete;
+
+		TransformId create(const TransformId parent = s_invalid_id,
+			const glm::vec3& translation = glm::vec3(0.f),
+			const glm::quat& rotation = glm::quat(1.f, 0.f, 0.f, 0.f),
+			const glm::vec3& scale = glm::vec3(1.f));
+		// with the whole subtree
+		void destroy(const TransformId id);
+		bool is_valid(const TransformId id) const;
+
+		// the node keeps its local transform; false if parent is in its subtree
+		bool set_parent(const TransformId id, const TransformId parent);
+		TransformId get_parent(const TransformId id) const;
+
+		// setters mark the node dirty only if the value changes
+		void set_translation(const TransformId id, const glm::vec3& translation);
+		void set_rotation(const TransformId id, const glm::quat& rotation);
+		void set_scale(const TransformId id, const glm::vec3& scale);
+
+		glm::vec3 get_translation(const TransformId id) const;
+		glm::quat get_rotation(const TransformId id) const;
+		glm::vec3 get_scale(const TransformId id) const;
+
+		// recomposes the dirty subtrees; set_parent and destroy may reorder the nodes and recompose everything
+		void update();
+
+		// as of the last update
+		const glm::mat4& get_world_matrix(const TransformId id) const { return m_world_matrices[m_indices[id]]; }
+		uint32_t get_index(const TransformId id) const { return m_indices[id]; }
+
+		size_t get_nodes_count() const { return m_ids.size(); }
+		const glm::mat4* get_world_matrices() const { return m_world_matrices.data(); }
+		// [first, first + count) of the world matrices changed by the last update, count is 0 if none did
+		size_t get_changed_first() const { return m_changed_first; }
+		size_t get_changed_count() const { return m_changed_count; }
+
+	private:
+		// moves the node at order[i] to index i, keeping the parent links; everything is recomposed after
+		void reorder(const std::vector<uint32_t>& order);
+		void resize_soa(const size_t count);
+		void mark_dirty(const uint32_t index);
+		void compose_local_matrices(const size_t first_block, const size_t last_block);
+
+		// by index, the SoA arrays padded to a multiple of 4 with identity transforms
+		std::vector<uint32_t> m_parents; // index of the parent, s_invalid_id for roots
+		std::vector<float> m_translation_x;
+		std::vector<float> m_translation_y;
+		std::vector<float> m_translation_z;
+		std::vector<float> m_rotation_x;
+		std::vector<float> m_rotation_y;
+		std::vector<float> m_rotation_z;
+		std::vector<float> m_rotation_w;
+		std::vector<float> m_scale_x;
+		std::vector<float> m_scale_y;
+		std::vector<float> m_scale_z;
+		std::vector<uint8_t> m_dirty_blocks; // one per 4 nodes, local matrices to recompose
+		std::vector<uint8_t> m_dirty; // world matrices to recompose
+		std::vector<glm::mat4> m_local_matrices;
+		std::vector<glm::mat4> m_world_matrices;
+		std::vector<TransformId> m_ids;
+
+		// by id
+		std::vector<uint32_t> m_indices; // s_invalid_id for free ids
+		std::vector<TransformId> m_free_ids;
+
+		size_t m_changed_first = 0;
+		size_t m_changed_count = 0;
+	};
+
+}
@@ -0,0 +1,139 @@
+#include "World.hpp"
+#include "SimpleEngineCore/Log.hpp"
+
+namespace SimpleEngine {
+
+	World::World() {
+		m_empty_archetype = &get_archetype(0);
+	}
+
+	// the archetypes destroy the components they still hold
+	World::~World() = default;
+
+	Entity World::create() {
+		if (!can_change_structure())
+			return Entity();
+		return allocate_entity(*m_empty_archetype);
+	}
+
+	void World::destroy(const Entity entity) {
+		EntityRecord* record = find_record(entity);
+		if (!record || !can_change_structure())
+			return;
+
+		const Entity moved_entity = record->archetype->remove_row(record->row);
+		if (moved_entity.is_valid())
+			m_records[moved_entity.index].row = record->row;
+
+		record->archetype = nullptr;
+		++record->generation;
+		m_free_indices.push_back(entity.index);
+		--m_entities_count;
+	}
+
+	bool World::is_alive(const Entity entity) const {
+		return find_record(entity) != nullptr;
+	}
+
+	Entity World::allocate_entity(Archetype& archetype) {
+		Entity entity;
+		if (!m_free_indices.empty()) {
+			entity.index = m_free_indices.back();
+			m_free_indices.pop_back();
+		}
+		else {
+			entity.index = static_cast<uint32_t>(m_records.size());
+			m_records.push_back({ nullptr, 0, 0 });
+		}
+
+		EntityRecord& record = m_records[entity.index];
+		entity.generation = record.generation;
+		record.archetype = &archetype;
+		record.row = archetype.allocate_row(entity);
+		++m_entities_count;
+		return entity;
+	}
+
+	World::EntityRecord* World::find_record(const Entity entity) {
+		if (entity.index >= m_records.size())
+			return nullptr;
+		EntityRecord& record = m_records[entity.index];
+		return record.archetype && record.generation == entity.generation ? &record : nullptr;
+	}
+
+	const World::EntityRecord* World::find_record(const Entity entity) const {
+		return const_cast<World*>(this)->find_record(entity);
+	}
+
+	bool World::can_change_structure() const {
+		if (m_iterations_count > 0) {
+			LOG_ERROR("World: structural change while iterating a query, record it into an EntityCommandBuffer");
+			return false;
+		}
+		return true;
+	}
+
+	Archetype& World::get_archetype(const ComponentMask mask) {
+		auto it = m_archetypes_by_mask.find(mask);
+		if (it != m_archetypes_by_mask.end())
+			return *it->second;
+
+		m_archetypes.push_back(std::make_unique<Archetype>(mask));
+		Archetype* archetype = m_archetypes.back().get();
+		m_archetypes_by_mask.emplace(mask, archetype);
+		return *archetype;
+	}
+
+	Archetype* World::get_add_target(Archetype& archetype, const ComponentId id) {
+		Archetype* target = archetype.get_add_edge(id);
+		if (!target) {
+			target = &get_archetype(archetype.get_mask() | component_bit(id));
+			archetype.set_add_edge(id, target);
+			target->set_remove_edge(id, &archetype);
+		}
+		return target;
+	}
+
+	Archetype* World::get_remove_target(Archetype& archetype, const ComponentId id) {
+		Archetype* target = archetype.get_remove_edge(id);
+		if (!target) {
+			target = &get_archetype(archetype.get_mask() & ~component_bit(id));
+			archetype.set_remove_edge(id, target);
+			target->set_add_edge(id, &archetype);
+		}
+		return target;
+	}
+
+	uint32_t World::move_entity(EntityRecord& record, Archetype& destination) {
+		Archetype& source = *record.archetype;
+		const uint32_t source_row = record.row;
+		const uint32_t row = destination.allocate_row(source.get_entity(source_row));
+
+		const Entity moved_entity = source.move_row(source_row, destination, row);
+		if (moved_entity.is_valid())
+			m_records[moved_entity.index].row = source_row;
+
+		record.archetype = &destination;
+		record.row = row;
+		return row;
+	}
+
+	QueryState& World::get_query_state(const ComponentMask mask) {
+		std::unique_ptr<QueryState>& state = m_queries[mask];
+		if (!state) {
+			state = std::make_unique<QueryState>();
+			state->mask = mask;
+		}
+		return *state;
+	}
+
+	void World::update_query(QueryState& state) {
+		// archetypes are never removed, so only the ones created since the last update need checking
+		for (; state.checked_archetypes_count < m_archetypes.size(); ++state.checked_archetypes_count) {
+			Archetype* archetype = m_archetypes[state.checked_archetypes_count].get();
+			if ((archetype->get_mask() & state.mask) == state.mask)
+				state.archetypes.push_back(archetype);
+		}
+	}
+
+}
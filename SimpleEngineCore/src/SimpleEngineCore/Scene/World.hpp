@@ -0,0 +1,293 @@
+#pragma once
+#include "Archetype.hpp"
+#include "Component.hpp"
+#include "Entity.hpp"
+#include "SimpleEngineCore/Jobs/JobSystem.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace SimpleEngine {
+
+	class World;
+
+	// archetypes matching a set of components, extended with the archetypes created since the last use
+	struct QueryState {
+		ComponentMask mask = 0;
+		std::vector<Archetype*> archetypes;
+		size_t checked_archetypes_count = 0;
+	};
+
+	// Iterates the entities having all of Components, chunk by chunk over contiguous arrays.
+	// Cheap to copy and stays valid as long as the world, keeping one around skips the lookup of its state.
+	// Structural changes (creating, destroying, adding or removing components) are refused while iterating,
+	// record them into an EntityCommandBuffer instead.
+	template<typename... Components>
+	class Query {
+		static_assert(sizeof...(Components) > 0, "a query needs at least one component");
+
+	public:
+		Query(World& world, QueryState& state)
+			: m_world(&world)
+			, m_state(&state) {
+		}
+
+		// function(count, entities, Components* arrays...) once per chunk, for loops the compiler can vectorize
+		template<typename F>
+		void each_chunk(F&& function);
+
+		// function(Components&...) or function(Entity, Components&...) once per entity
+		template<typename F>
+		void each(F&& function);
+
+		// each spread over JobSystem jobs, the function is called concurrently for different entities
+		template<typename F>
+		void parallel_each(F&& function, const size_t min_entities_per_job = s_min_entities_per_job);
+
+		size_t count();
+
+		static constexpr size_t s_min_entities_per_job = 8 * 1024;
+
+	private:
+		template<typename F, size_t... Indices>
+		static void call_for_chunk(F& function, Archetype& archetype, const ArchetypeChunk& chunk, std::index_sequence<Indices...>);
+
+		template<typename F>
+		static void each_in_chunk(F& function, Archetype& archetype, const ArchetypeChunk& chunk);
+
+		World* m_world;
+		QueryState* m_state;
+	};
+
+	// Entities and their components, stored by archetype
+	class World {
+	public:
+		World();
+		~World();
+
+		World(const World&) = delete;
+		World& operator=(const World&) = delete;
+
+		Entity create();
+		template<typename... Components>
+		Entity create(Components&&... components);
+		void destroy(const Entity entity);
+		bool is_alive(const Entity entity) const;
+
+		// replaces the component if the entity has it already; nullptr if the entity is dead
+		template<typename T>
+		T* add(const Entity entity, T component = T());
+		template<typename T>
+		bool remove(const Entity entity);
+		// valid until the next structural change
+		template<typename T>
+		T* get(const Entity entity);
+		template<typename T>
+		bool has(const Entity entity) const;
+
+		template<typename... Components>
+		Query<Components...> query() { return Query<Components...>(*this, get_query_state(ComponentRegistry::get_mask<Components...>())); }
+
+		size_t get_entities_count() const { return m_entities_count; }
+		size_t get_archetypes_count() const { return m_archetypes.size(); }
+
+	private:
+		template<typename... Components>
+		friend class Query;
+
+		struct EntityRecord {
+			Archetype* archetype;
+			uint32_t row;
+			uint32_t generation;
+		};
+
+		// RAII guard for iterations, structural changes are refused while there is one
+		class IterationScope {
+		public:
+			explicit IterationScope(World& world)
+				: m_world(world) {
+				++m_world.m_iterations_count;
+			}
+			~IterationScope() { --m_world.m_iterations_count; }
+
+		private:
+			World& m_world;
+		};
+
+		Entity allocate_entity(Archetype& archetype);
+		EntityRecord* find_record(const Entity entity);
+		const EntityRecord* find_record(const Entity entity) const;
+		bool can_change_structure() const;
+
+		Archetype& get_archetype(const ComponentMask mask);
+		Archetype* get_add_target(Archetype& archetype, const ComponentId id);
+		Archetype* get_remove_target(Archetype& archetype, const ComponentId id);
+		// moves the entity with its components to the destination archetype, returns its new row
+		uint32_t move_entity(EntityRecord& record, Archetype& destination);
+
+		QueryState& get_query_state(const ComponentMask mask);
+		void update_query(QueryState& state);
+
+		std::vector<std::unique_ptr<Archetype>> m_archetypes;
+		std::unordered_map<ComponentMask, Archetype*> m_archetypes_by_mask;
+		Archetype* m_empty_archetype = nullptr;
+
+		std::vector<EntityRecord> m_records;
+		std::vector<uint32_t> m_free_indices;
+		size_t m_entities_count = 0;
+
+		std::unordered_map<ComponentMask, std::unique_ptr<QueryState>> m_queries;
+		int m_iterations_count = 0;
+	};
+
+	template<typename... Components>
+	Entity World::create(Components&&... components) {
+		if constexpr (sizeof...(Components) == 0) {
+			return create();
+		}
+		else {
+			const ComponentMask mask = ComponentRegistry::get_mask<std::decay_t<Components>...>();
+			if (!can_change_structure() || count_components(mask) != sizeof...(Components))
+				return Entity();
+
+			Archetype& archetype = get_archetype(mask);
+			const Entity entity = allocate_entity(archetype);
+			const uint32_t row = m_records[entity.index].row;
+			(new (archetype.get_component(row, ComponentRegistry::get_id<std::decay_t<Components>>()))
+				std::decay_t<Components>(std::forward<Components>(components)), ...);
+			return entity;
+		}
+	}
+
+	template<typename T>
+	T* World::add(const Entity entity, T component) {
+		EntityRecord* record = find_record(entity);
+		const ComponentId id = ComponentRegistry::get_id<T>();
+		if (!record)
+			return nullptr;
+
+		if (record->archetype->has(id)) {
+			T* existing = static_cast<T*>(record->archetype->get_component(record->row, id));
+			*existing = std::move(component);
+			return existing;
+		}
+		if (!can_change_structure())
+			return nullptr;
+
+		Archetype* destination = get_add_target(*record->archetype, id);
+		const uint32_t row = move_entity(*record, *destination);
+		return new (destination->get_component(row, id)) T(std::move(component));
+	}
+
+	template<typename T>
+	bool World::remove(const Entity entity) {
+		EntityRecord* record = find_record(entity);
+		const ComponentId id = ComponentRegistry::get_id<T>();
+		if (!record || !record->archetype->has(id) || !can_change_structure())
+			return false;
+
+		move_entity(*record, *get_remove_target(*record->archetype, id));
+		return true;
+	}
+
+	template<typename T>
+	T* World::get(const Entity entity) {
+		EntityRecord* record = find_record(entity);
+		const ComponentId id = ComponentRegistry::get_id<T>();
+		if (!record || !record->archetype->has(id))
+			return nullptr;
+		return static_cast<T*>(record->archetype->get_component(record->row, id));
+	}
+
+	template<typename T>
+	bool World::has(const Entity entity) const {
+		const EntityRecord* record = find_record(entity);
+		return record && record->archetype->has(ComponentRegistry::get_id<T>());
+	}
+
+	template<typename... Components>
+	template<typename F, size_t... Indices>
+	void Query<Components...>::call_for_chunk(F& function, Archetype& archetype, const ArchetypeChunk& chunk, std::index_sequence<Indices...>) {
+		const ComponentId ids[] = { ComponentRegistry::get_id<Components>()... };
+		function(static_cast<size_t>(chunk.count), archetype.get_entities(chunk),
+			static_cast<Components*>(archetype.get_column(chunk, ids[Indices]))...);
+	}
+
+	template<typename... Components>
+	template<typename F>
+	void Query<Components...>::each_in_chunk(F& function, Archetype& archetype, const ArchetypeChunk& chunk) {
+		auto per_entity = [&function](const size_t count, const Entity* entities, Components*... columns) {
+			for (size_t i = 0; i < count; ++i) {
+				if constexpr (std::is_invocable_v<F&, Entity, Components&...>)
+					function(entities[i], columns[i]...);
+				else
+					function(columns[i]...);
+			}
+		};
+		call_for_chunk(per_entity, archetype, chunk, std::index_sequence_for<Components...>{});
+	}
+
+	template<typename... Components>
+	template<typename F>
+	void Query<Components...>::each_chunk(F&& function) {
+		World::IterationScope scope(*m_world);
+		m_world->update_query(*m_state);
+		for (Archetype* archetype : m_state->archetypes) {
+			for (size_t i = 0; i < archetype->get_chunks_count(); ++i)
+				call_for_chunk(function, *archetype, archetype->get_chunk(i), std::index_sequence_for<Components...>{});
+		}
+	}
+
+	template<typename... Components>
+	template<typename F>
+	void Query<Components...>::each(F&& function) {
+		World::IterationScope scope(*m_world);
+		m_world->update_query(*m_state);
+		for (Archetype* archetype : m_state->archetypes) {
+			for (size_t i = 0; i < archetype->get_chunks_count(); ++i)
+				each_in_chunk(function, *archetype, archetype->get_chunk(i));
+		}
+	}
+
+	template<typename... Components>
+	template<typename F>
+	void Query<Components...>::parallel_each(F&& function, const size_t min_entities_per_job) {
+		World::IterationScope scope(*m_world);
+		m_world->update_query(*m_state);
+
+		// chunks are the unit of work, so no two jobs write to the same cache line
+		std::vector<std::pair<Archetype*, const ArchetypeChunk*>> chunks;
+		size_t entities_count = 0;
+		for (Archetype* archetype : m_state->archetypes) {
+			for (size_t i = 0; i < archetype->get_chunks_count(); ++i)
+				chunks.emplace_back(archetype, &archetype->get_chunk(i));
+			entities_count += archetype->get_entities_count();
+		}
+		if (chunks.empty())
+			return;
+
+		const size_t average_chunk_size = std::max<size_t>(1, entities_count / chunks.size());
+		const size_t min_chunks_per_job = std::max<size_t>(1, min_entities_per_job / average_chunk_size);
+		JobSystem::parallel_for(chunks.size(), min_chunks_per_job, [&chunks, &function](const size_t first, const size_t last) {
+			for (size_t i = first; i < last; ++i)
+				each_in_chunk(function, *chunks[i].first, *chunks[i].second);
+		});
+	}
+
+	template<typename... Components>
+	size_t Query<Components...>::count() {
+		m_world->update_query(*m_state);
+		size_t entities_count = 0;
+		for (const Archetype* archetype : m_state->archetypes)
+			entities_count += archetype->get_entities_count();
+		return entities_count;
+	}
+
+}
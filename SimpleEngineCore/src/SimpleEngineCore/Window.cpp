@@ -103,7 +103,11 @@ namespace SimpleEngine {
 
         glfwSetFramebufferSizeCallback(m_pWindow,
             [](GLFWwindow* pWindow, int width, int height) {
-                Renderer_OpenGL::set_view_port(width, height);
+                WindowData& data = *(static_cast<WindowData*>(glfwGetWindowUserPointer(pWindow)));
+
+                // the GL context may be current on the render thread, so the viewport is left to the listener
+                EventFramebufferResize event(width, height);
+                data.eventCallbackFn(event);
             }
         );
 
@@ -142,11 +146,22 @@ namespace SimpleEngine {
         return { x_pos, y_pos };
     }
 
-    void Window::on_update() {
+    void Window::swap_buffers() {
         glfwSwapBuffers(m_pWindow);
+    }
+
+    void Window::poll_events() {
         glfwPollEvents();
     }
 
+    void Window::make_context_current() {
+        glfwMakeContextCurrent(m_pWindow);
+    }
+
+    void Window::release_context() {
+        glfwMakeContextCurrent(nullptr);
+    }
+
 	void Window::shutdown() {
         UIModule::on_window_close();
         glfwDestroyWindow(m_pWindow);
@@ -20,7 +20,13 @@ namespace SimpleEngine {
 		Window& operator=(Window&&) = delete;
 		glm::vec2 get_current_cursor_position();
 
-		void on_update();
+		// the two halves of a frame: swapping needs the GL context, events are polled on the main thread
+		void swap_buffers();
+		void poll_events();
+
+		// the GL context is current on one thread at a time, see RenderThread
+		void make_context_current();
+		void release_context();
 
 		unsigned int get_width() const	{ return m_data.width; }
 		unsigned int get_height() const { return m_data.height; }
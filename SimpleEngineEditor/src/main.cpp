@@ -1,3 +1,4 @@
+#include <cstring>
 #include <iostream>
 #include <memory>
 #include "SimpleEngineCore/Application.hpp"
@@ -101,8 +102,12 @@ public:
 	int frame = 0;
 };
 
-int main() {
+int main(int argc, char** argv) {
 	auto pSimpleEngineEditor = std::make_unique<SimpleEngineEditor>();
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--render-thread") == 0)
+			pSimpleEngineEditor->use_render_thread = true;
+	}
 
 	int returnCode = pSimpleEngineEditor->start(1200, 800, "SimpleGameEngine");
 